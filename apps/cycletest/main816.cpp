@@ -1602,6 +1602,7 @@ int main(int argc, char **argv) {
         cpu->y = test_records[i].y_in;
         cpu->p = test_records[i].p_in;
         cpu->d = test_records[i].dp_in;
+        cpu->mode_switch = true; // registers loaded behind the core's back; pick the matching core.
         mmu->write(0x1000, test_records[i].operation.op[0]);
         mmu->write(0x1001, test_records[i].operation.op[1]);
         mmu->write(0x1002, test_records[i].operation.op[2]);
@@ -0,0 +1,133 @@
+/**
+ * eventtimerbench
+ *
+ * microbenchmark for EventTimer.
+ *
+ * To use:
+ * /path/to/eventtimerbench [iterations]
+ *
+ * Runs a few scheduling patterns that look like what the devices do to the
+ * timer queue (periodic reschedule of a handful of instances, one-shot events
+ * that get cancelled before they fire, and a large queue of mixed events), and
+ * reports the time per operation. It also checks that events come out in
+ * trigger order, and that same-cycle events fire in the order scheduled.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+#include "util/EventTimer.hpp"
+
+uint64_t debug_level = 0;
+
+struct bench_state_t {
+    EventTimer *timer;
+    uint64_t period;
+    uint64_t fired = 0;
+    uint64_t last_cycle = 0;
+    uint64_t now = 0;
+    bool out_of_order = false;
+};
+
+// reschedule ourselves one period out, like the VBL / IWM / timer devices do.
+static void periodic_callback(uint64_t instanceID, void *userData) {
+    bench_state_t *st = (bench_state_t *)userData;
+    if (st->now < st->last_cycle) st->out_of_order = true;
+    st->last_cycle = st->now;
+    st->fired++;
+    st->timer->scheduleEvent(st->now + st->period + (instanceID % 7), periodic_callback, instanceID, st);
+}
+
+static void oneshot_callback(uint64_t instanceID, void *userData) {
+    bench_state_t *st = (bench_state_t *)userData;
+    st->fired++;
+}
+
+static std::vector<uint64_t> fire_order;
+static void order_callback(uint64_t instanceID, void *userData) {
+    fire_order.push_back(instanceID);
+}
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a handful of devices, each with one event that is rescheduled every time it fires.
+static void bench_periodic(uint64_t iterations, int instances) {
+    EventTimer timer;
+    bench_state_t st;
+    st.timer = &timer;
+    st.period = 17030;
+    for (int i = 0; i < instances; i++) {
+        timer.scheduleEvent(i * 100, periodic_callback, 0x1000 + i, &st);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        st.now += 65;
+        if (timer.isEventPassed(st.now)) timer.processEvents(st.now);
+    }
+    double ns = elapsed_ns(start);
+    printf("periodic  %4d instances: %10llu fired, %8.2f ns/step%s\n", instances,
+        (unsigned long long)st.fired, ns / iterations, st.out_of_order ? "  OUT OF ORDER" : "");
+}
+
+// schedule a one-shot, then usually cancel or move it before it fires (disk motor-off, etc.)
+static void bench_cancel(uint64_t iterations, int background) {
+    EventTimer timer;
+    bench_state_t st;
+    st.timer = &timer;
+    for (int i = 0; i < background; i++) {
+        timer.scheduleEvent(UINT64_MAX / 2 + i, oneshot_callback, 0x2000 + i, &st);
+    }
+    uint64_t now = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        now += 10;
+        uint64_t id = 0x3000 + (i & 15);
+        timer.scheduleEvent(now + 1000 + (i & 255), oneshot_callback, id, &st);
+        if (i & 1) timer.cancelEvents(id);
+        timer.processEvents(now);
+    }
+    double ns = elapsed_ns(start);
+    printf("cancel    %4d background: %10llu fired, %8.2f ns/op\n", background,
+        (unsigned long long)st.fired, ns / iterations);
+}
+
+static bool check_order() {
+    EventTimer timer;
+    fire_order.clear();
+    timer.scheduleEvent(50, order_callback, 1);
+    timer.scheduleEvent(10, order_callback, 2);
+    timer.scheduleEvent(30, order_callback, 3);
+    timer.scheduleEvent(30, order_callback, 4);
+    timer.scheduleEvent(30, order_callback, 5);
+    timer.scheduleEvent(20, order_callback, 6);
+    timer.scheduleEvent(60, order_callback, 2);   // moves instance 2 to the end
+    timer.cancelEvents(6);
+    timer.processEvents(100);
+    std::vector<uint64_t> expected = { 3, 4, 5, 1, 2 };
+    if (fire_order != expected || timer.hasPendingEvents()) {
+        printf("order check FAILED:");
+        for (uint64_t id : fire_order) printf(" %llu", (unsigned long long)id);
+        printf("\n");
+        return false;
+    }
+    printf("order check passed\n");
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint64_t iterations = 10000000;
+    if (argc > 1) iterations = strtoull(argv[1], nullptr, 10);
+
+    if (!check_order()) return 1;
+
+    bench_periodic(iterations, 4);
+    bench_periodic(iterations, 32);
+    bench_cancel(iterations, 0);
+    bench_cancel(iterations, 64);
+    return 0;
+}
@@ -0,0 +1,454 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * gs2headless
+ *
+ * Boots a machine exactly as GSSquared does (machine_power_on) and runs it
+ * as fast as possible with no window, no audio device and no frame pacing.
+ * Frames end on emulated cycles, never on host time, and no host input is
+ * read, so the same config + disks give the same frame and audio hashes on
+ * every run. Meant for regression tests, CI and benchmarking.
+ *
+ * SDL still needs a video and audio driver to build the computer, so we ask
+ * for the offscreen / dummy drivers and a software renderer.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "gs2.hpp"
+#include "PlatformIDs.hpp"
+#include "paths.hpp"
+#include "cpu.hpp"
+#include "computer.hpp"
+#include "machine.hpp"
+#include "systemconfig.hpp"
+#include "videosystem.hpp"
+#include "util/EventQueue.hpp"
+#include "util/EventTimer.hpp"
+#include "util/AudioSystem.hpp"
+#include "util/SoundEffect.hpp"
+#include "util/SystemConfig.hpp"
+#include "util/mount.hpp"
+#include "util/printf_helper.hpp"
+
+gs2_app_t gs2_app_values;
+
+static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+static constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+static inline uint64_t fnv1a(uint64_t h, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+struct headless_options_t {
+    uint64_t frames = 600;
+    bool until_pc = false;
+    uint32_t stop_pc = 0;
+    bool until_mem = false;
+    uint32_t stop_addr = 0;
+    uint8_t stop_value = 0;
+    const char *hash_path = nullptr;
+    bool audio_checksum = false;
+    const char *load_snapshot = nullptr;
+    const char *save_snapshot = nullptr;
+    bool quiet = false;
+};
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [options] [file.gs2|*Settings.txt]\n", argv0);
+    fprintf(stderr, "  -p N                   platform to run if no config file is given (default 1, Apple II Plus)\n");
+    fprintf(stderr, "  -dsXdY=filename        mount disk image in slot X drive Y (1-indexed)\n");
+    fprintf(stderr, "  -f N, --frames N       run at most N frames (default 600, 0 = no limit)\n");
+    fprintf(stderr, "  --until-pc ADDR        stop when the CPU is about to execute ADDR (hex)\n");
+    fprintf(stderr, "  --until-mem ADDR=VAL   stop at the end of the first frame where ADDR holds VAL (hex)\n");
+    fprintf(stderr, "  --frame-hashes FILE    write one line per frame with its video hash ('-' = stdout)\n");
+    fprintf(stderr, "  --audio-checksum       checksum all generated audio (added to --frame-hashes lines)\n");
+    fprintf(stderr, "  --load-snapshot FILE   after power-on, restore the machine from FILE\n");
+    fprintf(stderr, "  --save-snapshot FILE   when the run stops, save the machine to FILE\n");
+    fprintf(stderr, "  -q                     don't print the summary\n");
+    fprintf(stderr, "exit status: 0 when the frame limit or a stop condition is reached;\n");
+    fprintf(stderr, "  1 when --until-* was given but never hit; 2 on setup errors.\n");
+    fprintf(stderr, "The ProDOS clock card and IIgs RTC read host time; leave them out of\n");
+    fprintf(stderr, "configs whose hashes are compared across runs.\n");
+    fprintf(stderr, "A snapshot only loads into the same config it was saved from, with the\n");
+    fprintf(stderr, "same disks mounted.\n");
+}
+
+static bool parse_hex(const char *s, uint32_t &out) {
+    char *end = nullptr;
+    unsigned long v = strtoul(s, &end, 16);
+    if (end == s || *end != '\0') return false;
+    out = (uint32_t)v;
+    return true;
+}
+
+/** Same as frame_appevent, minus everything that needs a window or the OSD. */
+static void headless_appevent(computer_t *computer) {
+    Event *event = computer->event_queue->getNextEvent();
+    if (event) {
+        switch (event->getEventType()) {
+            case EVENT_PLAY_SOUNDEFFECT:
+                computer->sound_effect->play(event->getEventData());
+                break;
+            case EVENT_QUIT:
+                computer->cpu->halt = HLT_USER;
+                break;
+            default:
+                break;
+        }
+        delete event;
+    }
+}
+
+static inline void process_timers(computer_t *computer, NClock *clock) {
+    if (computer->event_timer->isEventPassed(clock->get_c14m())) {
+        computer->event_timer->processEvents(clock->get_c14m());
+    }
+    if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
+        computer->vid_event_timer->processEvents(clock->get_vid_cycles());
+    }
+    if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
+        computer->cpu_event_timer->processEvents(clock->get_cycles());
+    }
+}
+
+/**
+ * Run one frame the way run_one_frame does in EXEC_NORMAL, but without
+ * sleeping, SDL events or the OSD. Returns true if stop_pc was reached.
+ */
+static bool headless_frame(computer_t *computer, const headless_options_t &opts) {
+    cpu_state *cpu = computer->cpu;
+    NClock *clock = computer->clock;
+
+    cpu->use_traced_core(cpu->trace);
+    computer->set_frame_start_cycle();
+
+    bool hit = false;
+    if (opts.until_pc) {
+        while (clock->get_c14m() < clock->get_frame_end_c14M()) {
+            process_timers(computer, clock);
+            if (cpu->full_pc == opts.stop_pc) {
+                hit = true;
+                break;
+            }
+            (cpu->cpun->execute_next)(cpu);
+        }
+    } else {
+        exec_budget_t budget;
+        budget.c14m_timer = computer->event_timer;
+        budget.vid_timer = computer->vid_event_timer;
+        budget.cpu_timer = computer->cpu_event_timer;
+        budget.c14m_end = clock->get_frame_end_c14M();
+        while (clock->get_c14m() < clock->get_frame_end_c14M()) {
+            process_timers(computer, clock);
+            cpu->cpun->execute_budget(cpu, budget);
+        }
+    }
+
+    headless_appevent(computer);
+    computer->device_frame_dispatcher->dispatch();
+    computer->video_system->update_display(false);
+
+    if (clock->get_c14m() >= clock->get_frame_end_c14M()) {
+        clock->next_frame();
+        computer->last_start_frame_c14m = clock->get_frame_start_c14M();
+    }
+    return hit;
+}
+
+/** Hash what update_display just drew. */
+static uint64_t hash_frame(video_system_t *vs) {
+    uint64_t h = FNV_OFFSET;
+    SDL_Surface *surface = SDL_RenderReadPixels(vs->renderer, nullptr);
+    if (!surface) {
+        return h;
+    }
+    const uint8_t *row = (const uint8_t *)surface->pixels;
+    size_t row_bytes = (size_t)surface->w * SDL_BYTESPERPIXEL(surface->format);
+    for (int y = 0; y < surface->h; y++, row += surface->pitch) {
+        h = fnv1a(h, row, row_bytes);
+    }
+    SDL_DestroySurface(surface);
+    return h;
+}
+
+int main(int argc, char **argv) {
+    headless_options_t opts;
+    int platform_id = PLATFORM_APPLE_II_PLUS;
+    std::vector<disk_mount_t> cli_mounts;
+
+    enum { OPT_UNTIL_PC = 1000, OPT_UNTIL_MEM, OPT_FRAME_HASHES, OPT_AUDIO_CHECKSUM, OPT_LOAD_SNAPSHOT, OPT_SAVE_SNAPSHOT };
+    static struct option long_options[] = {
+        {"frames", required_argument, nullptr, 'f'},
+        {"until-pc", required_argument, nullptr, OPT_UNTIL_PC},
+        {"until-mem", required_argument, nullptr, OPT_UNTIL_MEM},
+        {"frame-hashes", required_argument, nullptr, OPT_FRAME_HASHES},
+        {"audio-checksum", no_argument, nullptr, OPT_AUDIO_CHECKSUM},
+        {"load-snapshot", required_argument, nullptr, OPT_LOAD_SNAPSHOT},
+        {"save-snapshot", required_argument, nullptr, OPT_SAVE_SNAPSHOT},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:d:f:q", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'p':
+                platform_id = std::stoi(optarg);
+                break;
+            case 'd':
+                {
+                    std::string arg_str(optarg);
+                    std::regex disk_pattern("s([0-9]+)d([0-9]+)=(.+)");
+                    std::smatch matches;
+                    if (!std::regex_match(arg_str, matches, disk_pattern) || matches.size() != 4) {
+                        usage(argv[0]);
+                        return 2;
+                    }
+                    cli_mounts.push_back({ (uint16_t)std::stoi(matches[1]), (uint16_t)(std::stoi(matches[2]) - 1), matches[3] });
+                }
+                break;
+            case 'f':
+                opts.frames = strtoull(optarg, nullptr, 10);
+                break;
+            case 'q':
+                opts.quiet = true;
+                break;
+            case OPT_UNTIL_PC:
+                if (!parse_hex(optarg, opts.stop_pc)) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                opts.until_pc = true;
+                break;
+            case OPT_UNTIL_MEM:
+                {
+                    std::string arg_str(optarg);
+                    size_t eq = arg_str.find('=');
+                    uint32_t value = 0;
+                    if (eq == std::string::npos
+                        || !parse_hex(arg_str.substr(0, eq).c_str(), opts.stop_addr)
+                        || !parse_hex(arg_str.substr(eq + 1).c_str(), value)) {
+                        usage(argv[0]);
+                        return 2;
+                    }
+                    opts.stop_value = (uint8_t)value;
+                    opts.until_mem = true;
+                }
+                break;
+            case OPT_FRAME_HASHES:
+                opts.hash_path = optarg;
+                break;
+            case OPT_AUDIO_CHECKSUM:
+                opts.audio_checksum = true;
+                break;
+            case OPT_LOAD_SNAPSHOT:
+                opts.load_snapshot = optarg;
+                break;
+            case OPT_SAVE_SNAPSHOT:
+                opts.save_snapshot = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+
+    gs2_app_values.console_mode = true;
+    Paths::initialize(gs2_app_values.console_mode);
+    gs2_app_values.base_path = get_base_path(gs2_app_values.console_mode);
+    gs2_app_values.pref_path = get_pref_path();
+
+    SystemConfig loaded_config;
+    const SystemConfig_t *system_config = nullptr;
+    std::vector<disk_mount_t> disks;
+    if (optind < argc) {
+        std::string error;
+        if (!loaded_config.load(argv[optind], error)) {
+            fprintf(stderr, "Failed to load system config '%s':\n%s\n", argv[optind], error.c_str());
+            return 2;
+        }
+        system_config = &loaded_config.config();
+        disks = loaded_config.mounts();
+    } else {
+        int system_id = find_first_system_for_platform(platform_id);
+        if (system_id < 0) {
+            fprintf(stderr, "No system config matches platform_id=%d\n", platform_id);
+            return 2;
+        }
+        system_config = get_system_config(system_id);
+    }
+    for (const auto &mount : cli_mounts) {
+        bool replaced = false;
+        for (auto &existing : disks) {
+            if (existing.slot == mount.slot && existing.drive == mount.drive) {
+                existing = mount;
+                replaced = true;
+            }
+        }
+        if (!replaced) disks.push_back(mount);
+    }
+
+    FILE *hash_file = nullptr;
+    if (opts.hash_path) {
+        hash_file = (strcmp(opts.hash_path, "-") == 0) ? stdout : fopen(opts.hash_path, "w");
+        if (!hash_file) {
+            fprintf(stderr, "Could not open %s\n", opts.hash_path);
+            return 2;
+        }
+    }
+
+    gs2_app_values.menu_event_type = SDL_RegisterEvents(1);
+
+    computer_t *computer = new computer_t(nullptr);
+    computer->set_system_config(system_config);
+    computer->set_machine_id(optind < argc ? loaded_config.id() : (system_config->id ? system_config->id : ""));
+    SDL_SetRenderVSync(computer->video_system->renderer, 0);
+
+    machine_mmus_t mmus;
+    if (!machine_power_on(computer, system_config, disks, mmus)) {
+        delete computer;
+        machine_free_mmus(mmus);
+        return 2;
+    }
+    computer->audio_system->detach_streams();
+
+    if (opts.load_snapshot) {
+        uint64_t load_start_ns = SDL_GetTicksNS();
+        Snapshot snap;
+        std::string error;
+        if (!snap.read_file(opts.load_snapshot, error) || !computer->restore_snapshot(snap, error)) {
+            fprintf(stderr, "Could not load snapshot %s: %s\n", opts.load_snapshot, error.c_str());
+            computer->set_system_config(nullptr);
+            delete computer;
+            machine_free_mmus(mmus);
+            return 2;
+        }
+        if (!opts.quiet) {
+            printf("restored %s in %.2f ms\n", opts.load_snapshot, (double)(SDL_GetTicksNS() - load_start_ns) / 1e6);
+        }
+    }
+
+    uint64_t audio_hash = FNV_OFFSET;
+    uint64_t audio_bytes = 0;
+    uint64_t frame_hash = 0;
+    uint64_t frames_run = 0;
+    uint64_t emulated_ns = 0;
+    bool stopped = false;
+    const char *stop_reason = "frame limit";
+
+    uint64_t start_cycles = computer->clock->get_cycles();
+    uint64_t start_ns = SDL_GetTicksNS();
+
+    while (opts.frames == 0 || frames_run < opts.frames) {
+        NClock *clock = computer->clock;
+        emulated_ns += (frames_run & 1) ? clock->get_us_per_frame_odd() : clock->get_us_per_frame_even();
+
+        bool pc_hit = headless_frame(computer, opts);
+        frames_run++;
+
+        // drain every frame so generators never see a full queue, whatever --audio-checksum says.
+        computer->audio_system->drain_streams([&](const uint8_t *data, int len) {
+            if (opts.audio_checksum) {
+                audio_hash = fnv1a(audio_hash, data, len);
+                audio_bytes += len;
+            }
+        });
+
+        if (hash_file) {
+            frame_hash = hash_frame(computer->video_system);
+            if (opts.audio_checksum) {
+                fprintf(hash_file, "%llu %016llx %016llx\n", u64_t(frames_run), u64_t(frame_hash), u64_t(audio_hash));
+            } else {
+                fprintf(hash_file, "%llu %016llx\n", u64_t(frames_run), u64_t(frame_hash));
+            }
+        }
+        computer->video_system->present();
+
+        if (pc_hit) {
+            stopped = true;
+            stop_reason = "until-pc";
+            break;
+        }
+        if (opts.until_mem && computer->cpu->mmu->read_raw(opts.stop_addr) == opts.stop_value) {
+            stopped = true;
+            stop_reason = "until-mem";
+            break;
+        }
+        if (computer->cpu->halt == HLT_USER) {
+            stop_reason = "halt";
+            break;
+        }
+    }
+
+    uint64_t host_ns = SDL_GetTicksNS() - start_ns;
+    uint64_t cycles = computer->clock->get_cycles() - start_cycles;
+
+    int status = 0;
+    if (opts.save_snapshot) {
+        Snapshot *snap = computer->save_snapshot();
+        std::string error;
+        if (!snap->write_file(opts.save_snapshot, error)) {
+            fprintf(stderr, "Could not save snapshot: %s\n", error.c_str());
+            status = 2;
+        }
+        delete snap;
+    }
+
+    if (!opts.quiet) {
+        double host_s = (double)host_ns / 1e9;
+        printf("stopped: %s after %llu frames, PC: %06X\n", stop_reason, u64_t(frames_run), computer->cpu->full_pc);
+        printf("cycles: %llu, host time: %.3f s, emulated MHz: %.3f, %.1fx realtime\n",
+            u64_t(cycles), host_s,
+            host_ns ? (double)cycles * 1000.0 / (double)host_ns : 0.0,
+            host_ns ? (double)emulated_ns / (double)host_ns : 0.0);
+        if (hash_file) {
+            printf("last frame hash: %016llx\n", u64_t(frame_hash));
+        }
+        if (opts.audio_checksum) {
+            printf("audio checksum: %016llx (%llu bytes)\n", u64_t(audio_hash), u64_t(audio_bytes));
+        }
+    }
+    if (hash_file && hash_file != stdout) {
+        fclose(hash_file);
+    }
+
+    computer->set_system_config(nullptr);
+    delete computer;
+    machine_free_mmus(mmus);
+    SDL_Quit();
+
+    if (status == 0 && (opts.until_pc || opts.until_mem) && !stopped) {
+        status = 1;
+    }
+    return status;
+}
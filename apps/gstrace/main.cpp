@@ -1,5 +1,54 @@
 
+#include <cstdlib>
+#include <vector>
+
 #include "debugger/trace.hpp"
+#include "debugger/TraceStream.hpp"
+
+static void usage() {
+    printf("usage: gstrace [options] 6502|65c02|65816 tracefilename.bin\n");
+    printf("options:\n");
+    printf("  -l labelfile    VICE label file\n");
+    printf("trace stream files (--trace-stream) only; the cpu type comes from the file:\n");
+    printf("  -s N            start at entry N\n");
+    printf("  -c CYCLE        start at the first entry at or after CYCLE\n");
+    printf("  -n COUNT        print at most COUNT entries\n");
+}
+
+/**
+ * Print entries from a trace stream, seeking through its chunk index
+ * instead of decoding from the start of the file.
+ */
+static int dump_stream(const char *trace_filename, const char *label_filename,
+                       uint64_t start_entry, uint64_t start_cycle, bool by_cycle, uint64_t count) {
+    TraceStreamReader reader;
+    if (!reader.open(trace_filename)) {
+        printf("Error: could not read trace stream %s\n", trace_filename);
+        return 1;
+    }
+    system_trace_buffer trace_buffer(1, reader.cpu_type());
+    if (label_filename != nullptr) {
+        trace_buffer.load_labels_from_file(label_filename);
+    }
+
+    size_t chunk = by_cycle ? reader.find_chunk_by_cycle(start_cycle) : reader.find_chunk_by_entry(start_entry);
+    std::vector<system_trace_entry_t> entries;
+    for (; chunk < reader.chunk_count() && count > 0; chunk++) {
+        if (!reader.read_chunk(chunk, entries)) {
+            printf("Error: chunk %zu is damaged\n", chunk);
+            return 1;
+        }
+        uint64_t pos = reader.chunk_first_entry(chunk);
+        for (size_t i = 0; i < entries.size() && count > 0; i++, pos++) {
+            if (by_cycle ? (entries[i].cycle < start_cycle) : (pos < start_entry)) {
+                continue;
+            }
+            printf("%s\n", trace_buffer.decode_trace_entry(&entries[i]));
+            count--;
+        }
+    }
+    return 0;
+}
 
 int main(int argc, char **argv) {
     char *tmsg;
@@ -8,10 +57,13 @@ int main(int argc, char **argv) {
     const char *trace_filename = nullptr;
     const char *label_filename = nullptr;
     
-    if (argc < 3) {
-        printf("usage: gstrace [options] 6502|65c02|65816 tracefilename.bin\n");
-        printf("options:\n");
-        printf("  -l labelfile    VICE label file\n");
+    uint64_t start_entry = 0;
+    uint64_t start_cycle = 0;
+    bool by_cycle = false;
+    uint64_t count = UINT64_MAX;
+    
+    if (argc < 2) {
+        usage();
         return 1;
     }
     
@@ -25,6 +77,13 @@ int main(int argc, char **argv) {
             }
             label_filename = argv[i + 1];
             i += 2;
+        } else if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "-n") == 0)
+                   && i + 1 < argc - 1) {
+            uint64_t v = strtoull(argv[i + 1], nullptr, 0);
+            if (argv[i][1] == 's') start_entry = v;
+            else if (argv[i][1] == 'c') { start_cycle = v; by_cycle = true; }
+            else count = v;
+            i += 2;
         } else if (strcmp(argv[i], "6502") == 0) {
             cputype = PROCESSOR_6502;
             i++;
@@ -35,15 +94,17 @@ int main(int argc, char **argv) {
             cputype = PROCESSOR_65816;
             i++;
         } else {
-            printf("usage: gstrace [options] 6502|65c02|65816 tracefilename.bin\n");
-            printf("options:\n");
-            printf("  -l labelfile    VICE label file\n");
+            usage();
             return 1;
         }
     }
     
     trace_filename = argv[argc - 1];
 
+    if (TraceStreamReader::is_trace_stream(trace_filename)) {
+        return dump_stream(trace_filename, label_filename, start_entry, start_cycle, by_cycle, count);
+    }
+
     system_trace_buffer trace_buffer(100000, cputype);
     
     // Load labels if specified
@@ -22,6 +22,7 @@
 #include "devices/displaypp/VideoScannerII.hpp"
 #include "PlatformIDs.hpp"
 #include "util/EventTimer.hpp"
+#include "util/Snapshot.hpp"
 #include <functional>
 
 typedef enum {
@@ -180,6 +181,7 @@ public:
     }
 
     void set_video_scanner(VideoScannerII *video_scanner) {
+        if (this->video_scanner) this->video_scanner->catch_up(); // flush any deferred cycles first.
         this->video_scanner = video_scanner;
     }
 
@@ -224,6 +226,27 @@ public:
         else slow_incr_cycles();
     }
 
+    virtual void save_state(SnapshotWriter &w) {
+        w.put(clock_mode);
+        w.put(cycles);
+        w.put(c_14M);
+        w.put(video_cycles);
+        w.put(video_cycle_14M_count);
+        w.put(scanline_14M_count);
+        w.put(frame_start_c14M);
+        w.put(frame_end_c14M);
+        w.put(frame_count);
+    }
+
+    virtual bool load_state(SnapshotReader &r) {
+        clock_mode_t mode;
+        if (!r.get(mode) || mode < 0 || mode >= NUM_CLOCK_MODES) return false;
+        set_clock_mode(mode);
+        return r.get(cycles) && r.get(c_14M) && r.get(video_cycles)
+            && r.get(video_cycle_14M_count) && r.get(scanline_14M_count)
+            && r.get(frame_start_c14M) && r.get(frame_end_c14M) && r.get(frame_count);
+    }
+
     virtual DebugFormatter *debug() {
         DebugFormatter *f = new DebugFormatter();
         f->addLine("Clock Mode: %s", get_clock_mode_name());
@@ -256,7 +279,7 @@ public:
 
             if (video_cycle_14M_count >= 14) {
                 video_cycle_14M_count -= 14;
-                video_scanner->video_cycle();
+                video_scanner->tick(); // lazy scanners just count the cycle here.
                 video_cycles++;
                 
                 for (auto &cycle_handler : cycle_handlers) {
@@ -273,6 +296,15 @@ public:
     inline void set_slow_mode(bool value) { slow_mode = value; }
     inline bool get_slow_mode() { return slow_mode; }
 
+    virtual void save_state(SnapshotWriter &w) override {
+        NClock::save_state(w);
+        w.put(slow_mode);
+    }
+
+    virtual bool load_state(SnapshotReader &r) override {
+        return NClock::load_state(r) && r.get(slow_mode);
+    }
+
 
     virtual DebugFormatter *debug() override {
         DebugFormatter *f = NClock::debug();
@@ -370,6 +402,19 @@ protected:
         cycle_type = CYCLE_TYPE_FAST; // reset here so MMU doesn't have to set for all possible addresses
     }
 
+    virtual void save_state(SnapshotWriter &w) override {
+        NClockII::save_state(w);
+        w.put(ram_refresh_cycles);
+        w.put(vidlinecycles);
+        w.put(video_c14m);
+        w.put(cycle_type);
+    }
+
+    virtual bool load_state(SnapshotReader &r) override {
+        return NClockII::load_state(r) && r.get(ram_refresh_cycles) && r.get(vidlinecycles)
+            && r.get(video_c14m) && r.get(cycle_type);
+    }
+
     virtual DebugFormatter *debug() override {
         DebugFormatter *f = NClockII::debug();
         f->addLine("RAM Refresh Cntr: %12llu", ram_refresh_cycles);
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <cstdint>
+#include <memory>
 
 #include "PlatformIDs.hpp"
 #include "SDL3/SDL_keycode.h"
@@ -83,6 +84,9 @@ computer_t::computer_t(NClockII *clock) {
     event_timer = new EventTimer(clock); // runs at 14MHz clock speed.
     vid_event_timer = new EventTimer(clock); // runs at video clock speed (always 1MHz)
     cpu_event_timer = new EventTimer(clock); // runs at cpu clock speed.
+    event_timer->set_deadline_watch(&cpu_budget_deadline);
+    vid_event_timer->set_deadline_watch(&cpu_budget_deadline);
+    cpu_event_timer->set_deadline_watch(&cpu_budget_deadline);
 
     slot_manager = new SlotManager_t();
     mounts = new Mounts();
@@ -92,15 +96,15 @@ computer_t::computer_t(NClockII *clock) {
 
     sys_event->registerHandler(SDL_EVENT_MOUSE_BUTTON_DOWN,[this](const SDL_Event &event ) {
         if (event.button.button == SDL_BUTTON_RIGHT && gs2_app_values.right_mouse_accelerate) {
-            old_speed = this->clock->get_clock_mode();
-            this->clock->set_clock_mode(CLOCK_14_3MHZ);
+            old_speed = this->requested_clock_mode();
+            this->request_clock_mode(CLOCK_14_3MHZ);
             return true;
         }
         return false;
     });
     sys_event->registerHandler(SDL_EVENT_MOUSE_BUTTON_UP,[this](const SDL_Event &event ) {
         if (event.button.button == SDL_BUTTON_RIGHT && gs2_app_values.right_mouse_accelerate) {
-            this->clock->set_clock_mode(old_speed);
+            this->request_clock_mode(old_speed);
             return true;
         }
         return false;
@@ -114,8 +118,8 @@ computer_t::computer_t(NClockII *clock) {
             return true; // eat the keydown
         } else if (key == SDLK_INSERT) {
             if (event.key.repeat == 1) return false; // ignore repeats otherwise it will forget the original speed
-            old_speed = this->clock->get_clock_mode();
-            this->clock->set_clock_mode(CLOCK_14_3MHZ);
+            old_speed = this->requested_clock_mode();
+            this->request_clock_mode(CLOCK_14_3MHZ);
             return true;
         }
         return false;
@@ -124,16 +128,11 @@ computer_t::computer_t(NClockII *clock) {
         int key = event.key.key;
         SDL_Keymod mod = event.key.mod;
         if (key == SDLK_F9) { 
-            this->speed_shift = true;
-            if (mod & SDL_KMOD_SHIFT) {
-                this->speed_new = this->clock->toggle(-1);
-            } else {
-                this->speed_new = this->clock->toggle(1);
-            }
+            this->request_clock_mode(this->clock->toggle((mod & SDL_KMOD_SHIFT) ? -1 : 1));
             send_clock_mode_message(speed_new);
             return true; 
         } else if (key == SDLK_INSERT) {
-            this->clock->set_clock_mode(old_speed);
+            this->request_clock_mode(old_speed);
             return true;
         }
         return false;
@@ -158,19 +157,19 @@ computer_t::computer_t(NClockII *clock) {
                 video_system->display_capture_mouse_message(true);
                 return true;
             case MENU_SPEED_1_0:
-                speed_new = CLOCK_1_024MHZ; speed_shift = true;
+                request_clock_mode(CLOCK_1_024MHZ);
                 send_clock_mode_message(speed_new);
                 return true;
             case MENU_SPEED_2_8:
-                speed_new = CLOCK_2_8MHZ; speed_shift = true;
+                request_clock_mode(CLOCK_2_8MHZ);
                 send_clock_mode_message(speed_new);
                 return true;
             case MENU_SPEED_7_1:
-                speed_new = CLOCK_7_159MHZ; speed_shift = true;
+                request_clock_mode(CLOCK_7_159MHZ);
                 send_clock_mode_message(speed_new);
                 return true;
             case MENU_SPEED_14_3:
-                speed_new = CLOCK_14_3MHZ; speed_shift = true;
+                request_clock_mode(CLOCK_14_3MHZ);
                 send_clock_mode_message(speed_new);
                 return true;
             case MENU_MONITOR_COMPOSITE:
@@ -316,6 +315,77 @@ bool computer_t::call_device_debug(device_id id, uint32_t op,
     return handler(op, req, reply, err);
 }
 
+static std::string tag_name(uint32_t tag) {
+    std::string s;
+    for (int i = 0; i < 4; i++) s += (char)((tag >> (i * 8)) & 0xFF);
+    return s;
+}
+
+void computer_t::register_snapshot_handler(uint32_t tag, uint32_t version, SnapshotSaveHandler save, SnapshotLoadHandler load) {
+    snapshot_handlers.push_back({tag, version, std::move(save), std::move(load)});
+}
+
+Snapshot *computer_t::save_snapshot(const Snapshot *base) {
+    Snapshot *snap = new Snapshot();
+    snap->platform = platform->id;
+    snap->chunks.reserve(snapshot_handlers.size());
+    for (auto &h : snapshot_handlers) {
+        snap->chunks.push_back({});
+        Snapshot::Chunk &chunk = snap->chunks.back();
+        chunk.tag = h.tag;
+        chunk.version = h.version;
+        SnapshotWriter w(chunk, base ? base->find(h.tag) : nullptr);
+        h.save(w);
+    }
+    return snap;
+}
+
+bool computer_t::restore_snapshot(const Snapshot &snap, std::string &err) {
+    // check the whole snapshot fits this machine before touching anything.
+    if (snap.platform != (uint32_t)platform->id) {
+        err = "snapshot is for a different platform";
+        return false;
+    }
+    if (snap.chunks.size() != snapshot_handlers.size()) {
+        err = "snapshot was taken with a different machine configuration";
+        return false;
+    }
+    for (auto &h : snapshot_handlers) {
+        const Snapshot::Chunk *chunk = snap.find(h.tag);
+        if (!chunk) {
+            err = "snapshot has no " + tag_name(h.tag) + " chunk";
+            return false;
+        }
+        if (chunk->version != h.version) {
+            err = "snapshot " + tag_name(h.tag) + " chunk is version " + std::to_string(chunk->version) + ", expected " + std::to_string(h.version);
+            return false;
+        }
+    }
+    // A chunk can still fail once earlier ones are applied (truncated data,
+    // a disk that's since been ejected), so keep the current state to go
+    // back to rather than leave the machine half restored.
+    std::unique_ptr<Snapshot> rollback(save_snapshot());
+    if (load_snapshot_chunks(snap, err)) return true;
+
+    std::string rollback_err;
+    if (!load_snapshot_chunks(*rollback, rollback_err)) {
+        fprintf(stderr, "restore_snapshot: rollback failed (%s), resetting\n", rollback_err.c_str());
+        reset(true);
+    }
+    return false;
+}
+
+bool computer_t::load_snapshot_chunks(const Snapshot &snap, std::string &err) {
+    for (auto &h : snapshot_handlers) {
+        SnapshotReader r(*snap.find(h.tag));
+        if (!h.load(r, err) || !r.ok()) {
+            if (err.empty()) err = "snapshot " + tag_name(h.tag) + " chunk is corrupt";
+            return false;
+        }
+    }
+    return true;
+}
+
 void computer_t::reset(bool cold_start) {
     last_reset = clock->get_cycles(); // catch this here (assert or instantaneous)
     if (cold_start) {
@@ -351,6 +421,57 @@ void computer_t::set_module_state(module_id_t module_id, void *state) {
     module_store[module_id] = state;
 }
 
+/**
+ * Works through the same speed_shift request the speed keys use, so the
+ * clock, video scanner and speaker all see an ordinary speed change. The
+ * motor-off timers in the disk controllers decide when the motor is off, so
+ * the user's speed comes back once the drive would have stopped on hardware.
+ */
+void computer_t::update_disk_accelerator() {
+    if (!gs2_app_values.disk_accelerator) return;
+
+    const clock_mode_t accel_speed = (clock_mode_t)gs2_app_values.disk_accelerator_speed;
+    const clock_mode_t requested = speed_shift ? speed_new : clock->get_clock_mode();
+    const bool spinning = mounts->any_floppy_motor_on();
+
+    if (!disk_accel_active) {
+        if (!spinning || requested == accel_speed) return;
+        disk_accel_active = true;
+        disk_accel_restore = requested;
+        speed_new = accel_speed;
+        speed_shift = true;
+        audio_system->set_mute(true);
+        return;
+    }
+
+    if (!spinning) {
+        disk_accel_active = false;
+        speed_new = disk_accel_restore;
+        speed_shift = true;
+        audio_system->set_mute(false);
+        return;
+    }
+
+    // the user picked a speed while the disk was running: keep going fast,
+    // and make theirs the one to come back to. A pending request counts even
+    // when it matches the accelerator speed (e.g. INSERT held over a boot).
+    if (speed_shift || requested != accel_speed) {
+        disk_accel_restore = requested;
+        speed_new = accel_speed;
+        speed_shift = true;
+    }
+}
+
+void computer_t::request_clock_mode(clock_mode_t mode) {
+    speed_new = mode;
+    speed_shift = true;
+}
+
+clock_mode_t computer_t::requested_clock_mode() {
+    if (disk_accel_active) return disk_accel_restore;
+    return speed_shift ? speed_new : clock->get_clock_mode();
+}
+
 // TODO: should live inside a reconstituted clock class.
 void computer_t::send_clock_mode_message(clock_mode_t clock_mode) {
     static char buffer[256];
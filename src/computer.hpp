@@ -22,6 +22,7 @@
 #include "util/AudioSystem.hpp"
 #include "util/SoundEffect.hpp"
 #include "util/StorageDevice.hpp"
+#include "util/Snapshot.hpp"
 #include "systemconfig.hpp"
 #include "device_reset_id.hpp"
 
@@ -60,6 +61,8 @@ struct computer_t {
         const std::vector<uint8_t> &req,
         std::vector<uint8_t> &reply,
         std::string &err)>;
+    using SnapshotSaveHandler = std::function<void (SnapshotWriter &w)>;
+    using SnapshotLoadHandler = std::function<bool (SnapshotReader &r, std::string &err)>;
 
     struct DebugDisplayHandlerInfo {
         std::string name;
@@ -67,6 +70,13 @@ struct computer_t {
         DebugDisplayHandler handler;
     };
 
+    struct SnapshotHandlerInfo {
+        uint32_t tag;
+        uint32_t version;
+        SnapshotSaveHandler save;
+        SnapshotLoadHandler load;
+    };
+
     computer_t(NClockII *clock);
     ~computer_t();
 
@@ -84,6 +94,11 @@ struct computer_t {
     bool speed_shift = false;
     clock_mode_t speed_new = CLOCK_1_024MHZ;
 
+    // disk accelerator: set while a floppy motor has us at the accelerator
+    // speed; disk_accel_restore is the user's speed to go back to.
+    bool disk_accel_active = false;
+    clock_mode_t disk_accel_restore = CLOCK_1_024MHZ;
+
     EventDispatcher *sys_event = nullptr;
     EventDispatcher *dispatch = nullptr;
 
@@ -98,6 +113,7 @@ struct computer_t {
     EventTimer *event_timer = nullptr;
     EventTimer *vid_event_timer = nullptr;
     EventTimer *cpu_event_timer = nullptr;
+    uint64_t cpu_budget_deadline = 0; // exec_budget_t::deadline for the run loop
 
     EventQueue *event_queue = nullptr;
 
@@ -117,6 +133,8 @@ struct computer_t {
     std::vector<ShutdownHandler> shutdown_handlers;
     std::vector<DebugDisplayHandlerInfo> debug_display_handlers;
     DeviceDebugHandler device_debug_handlers[NUM_DEVICE_IDS]{};
+    std::vector<SnapshotHandlerInfo> snapshot_handlers;
+    bool load_snapshot_chunks(const Snapshot &snap, std::string &err);
 
     void *module_store[MODULE_NUM_MODULES];
 
@@ -175,6 +193,13 @@ struct computer_t {
     void set_frame_start_cycle();
     uint64_t get_frame_start_cycle() { return frame_start_cycle; }
 
+    /** Between frames: request the accelerator speed while any floppy motor is on, and the user's speed once they're all off. */
+    void update_disk_accelerator();
+    /** Ask for a speed change at the next frame. While the disk accelerator is running, this becomes the speed it restores. */
+    void request_clock_mode(clock_mode_t mode);
+    /** The speed the user has asked for, ignoring any disk accelerator override. */
+    clock_mode_t requested_clock_mode();
+
     void register_reset_handler(ResetHandler handler);
     void register_shutdown_handler(ShutdownHandler handler);
     void register_debug_display_handler(std::string name, uint64_t id, DebugDisplayHandler handler);
@@ -186,6 +211,20 @@ struct computer_t {
                           std::vector<uint8_t> &reply,
                           std::string &err);
 
+    /**
+     * Register a snapshot chunk. Chunks are saved and restored in registration
+     * order; bump version whenever the layout written by save changes.
+     */
+    void register_snapshot_handler(uint32_t tag, uint32_t version, SnapshotSaveHandler save, SnapshotLoadHandler load);
+    /** Capture the whole machine. Pages unchanged since base are shared with it. */
+    Snapshot *save_snapshot(const Snapshot *base = nullptr);
+    /**
+     * Put the machine back into snap's state. Between frames only. On failure
+     * the machine is left as it was before the call (or, if even that can't
+     * be put back, cold reset).
+     */
+    bool restore_snapshot(const Snapshot &snap, std::string &err);
+
     void *get_module_state( module_id_t module_id);
     void set_module_state( module_id_t module_id, void *state);
 
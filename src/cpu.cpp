@@ -32,7 +32,8 @@ cpu_state::cpu_state(processor_type cpu_type) {
     d = 0;
     /* cycles = 0; */ // moved to clock.
     
-    trace = true;
+    // off until something reads the trace (debugger window, protocol client, --trace-stream).
+    trace = false;
     trace_buffer = new system_trace_buffer(100000, cpu_type);
 }
 
@@ -41,6 +42,31 @@ void cpu_state::set_processor(processor_type new_cpu_type) {
     trace_buffer->set_cpu_type(new_cpu_type);
 }
 
+/**
+ * Install traced and untraced builds of the same CPU. cpun starts as the traced one.
+ */
+void cpu_state::set_cores(std::unique_ptr<BaseCPU> traced, std::unique_ptr<BaseCPU> untraced) {
+    cpun = std::move(traced);
+    cpun_standby = std::move(untraced);
+    cpun_traced = true;
+    core = cpun.get();
+}
+
+/**
+ * Swap in the traced or untraced core. Register state lives in cpu_state, so
+ * this is safe between any two instructions. The 65816 wrapper re-selects its
+ * mode core on the next instruction, since the standby may be on a stale one.
+ */
+void cpu_state::use_traced_core(bool traced) {
+    if (traced == cpun_traced || !cpun_standby) {
+        return;
+    }
+    std::swap(cpun, cpun_standby);
+    cpun_traced = traced;
+    core = cpun.get();
+    mode_switch = true;
+}
+
 void cpu_state::reset() {
     halt = 0; // if we were STPed etc.
     clock_stopped = false;
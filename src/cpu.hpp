@@ -187,6 +187,7 @@ struct cpu_state {
         uint8_t p;  /* Processor Status Register */
     };
     uint8_t E : 1;  /* Emulation Flag */
+    bool mode_switch = false; /* 65816: E/M/X changed, a different core must run the next instruction */
 
     bool clock_stopped = false; /* if set, the clock is stopped */
 
@@ -210,6 +211,8 @@ struct cpu_state {
 
     std::unique_ptr<BaseCPU> cpun; // CPU instance.
     BaseCPU *core = nullptr;
+    std::unique_ptr<BaseCPU> cpun_standby; // the other trace variant of cpun, if any.
+    bool cpun_traced = true;
 
     /* Tracing & Debug */
     /* These are CPU controls, leave them here */
@@ -224,6 +227,8 @@ struct cpu_state {
     ~cpu_state();
 
     void set_processor(processor_type new_cpu_type);
+    void set_cores(std::unique_ptr<BaseCPU> traced, std::unique_ptr<BaseCPU> untraced);
+    void use_traced_core(bool traced);
     void reset();
     
     void set_mmu(MMU *mmu) { this->mmu = mmu; }
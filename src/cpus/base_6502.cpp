@@ -102,6 +102,20 @@ public:
     const char *get_name() override { return CPUTraits::name; }
 
 private:
+    /*
+    65816: called after instructions that can change E, M or X. If this
+    instantiation no longer matches the processor mode, flag it so the
+    CPU65816 wrapper switches cores before the next instruction.
+    */
+    inline void check_mode_switch(cpu_state *cpu) {
+        if constexpr (CPUTraits::has_65816_ops) {
+            bool same;
+            if constexpr (CPUTraits::e_mode) same = (cpu->E == 1);
+            else same = (cpu->E == 0) && (cpu->_M == !CPUTraits::m_16) && (cpu->_X == !CPUTraits::x_16);
+            if (!same) cpu->mode_switch = true;
+        }
+    }
+
     // Type alias for ALU operations that can be either 8-bit or 16-bit based on A register width (m_16 trait)
     using alu_t = std::conditional_t<CPUTraits::m_16, word_t, byte_t>;
     using index_t = std::conditional_t<CPUTraits::x_16, word_t, byte_t>;
@@ -118,12 +132,12 @@ inline word_t word(uint8_t lo, uint8_t hi) { return lo | (hi << 8); }
  So bake those two things here together.
 */
 inline uint8_t bus_read(cpu_state *cpu, uint32_t addr) {
-    uint8_t data = cpu->mmu->read(addr & 0xFFFFFF);
+    uint8_t data = cpu->mmu->bus_read(addr & 0xFFFFFF);
     incr_cycles(cpu);
     return data;
 }
 inline void bus_write(cpu_state *cpu, uint32_t addr, uint8_t data) {
-    cpu->mmu->write(addr & 0xFFFFFF, data);
+    cpu->mmu->bus_write(addr & 0xFFFFFF, data);
     incr_cycles(cpu);
 }
 
@@ -141,28 +155,28 @@ inline uint8_t vp_read(cpu_state *cpu, uint32_t addr) {
  */
 // Normal phantom read - always performs
 inline void phantom_read(cpu_state *cpu, uint32_t address) {
-    cpu->mmu->read(address);
+    cpu->mmu->bus_read(address);
     incr_cycles(cpu);
 }
 
 // Phantom read - only performs if full_phantom_reads is true. This is used for PRs that just re-read program counter etc and can't affect I/O in Apple II..
 inline void phantom_read_ign(cpu_state *cpu, uint32_t address) {
     if constexpr (CPUTraits::full_phantom_reads) {
-        cpu->mmu->read(address);
+        cpu->mmu->bus_read(address);
     }
     incr_cycles(cpu);
 }
 
 // Phantom write - always performs
 inline void phantom_write(cpu_state *cpu, uint32_t address, uint8_t value) {
-    cpu->mmu->write(address, value);
+    cpu->mmu->bus_write(address, value);
     incr_cycles(cpu);
 }
 
 // Ignorable phantom write. (Not sure this ever happens..)
 inline void phantom_write_ign(cpu_state *cpu, uint32_t address, uint8_t value) {
     if constexpr (CPUTraits::full_phantom_reads) {
-        cpu->mmu->write(address, value);
+        cpu->mmu->bus_write(address, value);
     }
     incr_cycles(cpu);
 }
@@ -224,9 +238,9 @@ inline word_t read_word(cpu_state *cpu, uint16_t address) {
 /* Used to write a word to a 16-bit address plus data bank */
 inline void write_word(cpu_state *cpu, uint16_t address, word_t value) {
     uint32_t eaddr = make_address_long(cpu, address);
-    cpu->mmu->write(eaddr, word_lo(value));
+    cpu->mmu->bus_write(eaddr, word_lo(value));
     incr_cycles(cpu);
-    cpu->mmu->write(eaddr + 1, word_hi(value));
+    cpu->mmu->bus_write(eaddr + 1, word_hi(value));
     incr_cycles(cpu);
     TRACE(cpu->trace_entry.eaddr = eaddr; cpu->trace_entry.data = value;)
 }
@@ -394,8 +408,45 @@ inline uint32_t _PC(cpu_state *cpu) {
     }
 }
 
+/*
+Instruction fetch cache. Holds the host pointer for the page PC is in, as
+handed out by MMU::get_fetch_page(), and is good until the MMU's map
+generation changes. Bytes are read live from host memory, so writes to code
+(self-modifying code, loaders) are seen with no invalidation. A null pointer
+means the page must be fetched through mmu->read(); that answer is cached too.
+fetch_notify pages (IIgs ROM) call mmu->fetch_notify() first so the bus cycle
+type is the same as read() would have set.
+Every fetch still costs one bus cycle, so cycle counts are unchanged.
+*/
+uint8_t *fetch_p = nullptr;
+bool fetch_notify_page = false;
+uint32_t fetch_page = 0;
+uint32_t fetch_shift = 0;
+uint32_t fetch_mask = 0;
+uint64_t fetch_gen = 0;
+
+void fetch_refill(cpu_state *cpu, uint32_t addr) {
+    MMU *mmu = cpu->mmu;
+    fetch_shift = mmu->get_page_size_bits();
+    fetch_mask = (1u << fetch_shift) - 1;
+    fetch_page = addr >> fetch_shift;
+    fetch_p = mmu->get_fetch_page(addr);
+    fetch_notify_page = fetch_p && mmu->fetch_needs_notify(addr);
+    fetch_gen = mmu->get_map_generation();
+}
+
 inline uint8_t fetch_pc(cpu_state *cpu) {
-    uint8_t b = cpu->mmu->read(_PC(cpu));
+    uint32_t addr = _PC(cpu);
+    if ((cpu->mmu->get_map_generation() != fetch_gen) || ((addr >> fetch_shift) != fetch_page)) {
+        fetch_refill(cpu, addr);
+    }
+    uint8_t b;
+    if (fetch_p) {
+        if (fetch_notify_page) cpu->mmu->fetch_notify(addr);
+        b = fetch_p[addr & fetch_mask];
+    } else {
+        b = cpu->mmu->read(addr);
+    }
     incr_cycles(cpu);
     cpu->pc++;
     return b;
@@ -2132,6 +2183,29 @@ inline void invalid_nop(cpu_state *cpu, int bytes, int cycles) {
 
 public:
 
+/*
+Run instructions until the budget is spent. The call to execute_next is
+qualified so it binds statically to this instantiation instead of going
+through the vtable on every instruction, and each instruction only compares
+the cycle counter against the budget deadline. 65816 cores also stop when a
+mode change hands off to another core.
+*/
+uint64_t execute_budget(cpu_state *cpu, const exec_budget_t &budget) override {
+    uint64_t local_deadline;
+    uint64_t &deadline = budget.deadline ? *budget.deadline : local_deadline;
+    deadline = this->budget_deadline(budget);
+    uint64_t n = 0;
+    do {
+        CPU6502Core::execute_next(cpu);
+        n++;
+        if (clock->get_cycles() >= deadline) {
+            if (!this->in_budget(budget)) break;
+            deadline = this->budget_deadline(budget);
+        }
+    } while (!CPUTraits::has_65816_ops || !cpu->mode_switch);
+    return n;
+}
+
 int execute_next(cpu_state *cpu) override {
 
     if (cpu->clock_stopped) { // clock stopped.
@@ -3292,7 +3366,7 @@ int execute_next(cpu_state *cpu) override {
                 //cpu->EFFI = cpu->I;
                 if constexpr (CPUTraits::has_65816_ops && !CPUTraits::e_mode) {
                     stack_pull(cpu, cpu->p);
-                    // TODO: perform x/m mode switch check here.
+                    check_mode_switch(cpu);
                 } else if constexpr (CPUTraits::has_65816_ops && CPUTraits::e_mode) {
                     // when e flag=1, m/x are forced to 1, so after plp, both flags will still be 1 no matter what is pulled from stack.
                     stack_pull(cpu, cpu->p);
@@ -3787,6 +3861,7 @@ int execute_next(cpu_state *cpu) override {
                     }
                     cpu->pc = pop_word(cpu);
                     if constexpr (!CPUTraits::e_mode) cpu->pb = pop_byte(cpu);
+                    check_mode_switch(cpu);
                 } else {
                     // pop status register "ignore B | unused" which I think means don't change them.
                     // can't find reference for order of RTI bus operations on 6502.
@@ -3974,6 +4049,7 @@ int execute_next(cpu_state *cpu) override {
                 wdm_handler_t &wdm = cpu->wdm_handlers[N];
                 if (wdm.handler) {
                     wdm.handler(cpu, wdm.context);
+                    check_mode_switch(cpu); // handlers may load P (e.g. hostfst).
                 }
             } else if constexpr (CPUTraits::has_65c02_ops) {
                 invalid_nop(cpu, 2, 2);
@@ -4013,10 +4089,8 @@ int execute_next(cpu_state *cpu) override {
                 if (cpu->E) {
                     cpu->p |= 0x30; // "if e flag is 1 m and x flags are forced to 1". this will not change register width.
                     cpu->sp_hi = 0x01;
-                } else {
-                    /*  */
-                    // TODO: execute potential register width change.
                 }
+                check_mode_switch(cpu);
                 phantom_read_ign(cpu, make_pc_long(cpu, cpu->pc)); // 2a
             } else if constexpr (CPUTraits::has_65c02_ops) {
                 invalid_nop(cpu, 2, 2);
@@ -4032,12 +4106,12 @@ int execute_next(cpu_state *cpu) override {
                 if (cpu->E) {
                     cpu->p |= 0x30; // "if e flag is 1 m and x flags are forced to 1". this will not change register width.
                 } else {
-                    // TODO: execute potential register width change.
                     if (cpu->_X == 1) { // when switch to 8-bit index registers, x/y hi are forced to 0.
                         cpu->x_hi = 0;
                         cpu->y_hi = 0;
                     }
                 }
+                check_mode_switch(cpu);
                 phantom_read_ign(cpu, make_pc_long(cpu, cpu->pc)); // 2a
             } else if constexpr (CPUTraits::has_65c02_ops) {
                 invalid_nop(cpu, 2, 2);
@@ -4622,6 +4696,7 @@ int execute_next(cpu_state *cpu) override {
                     cpu->_M = 1;
                     cpu->_X = 1;
                 }
+                check_mode_switch(cpu);
             } else if constexpr (CPUTraits::has_65c02_ops) { // invalid opcode
                 invalid_nop(cpu, 1, 1);
             } else invalid_opcode(cpu, opcode); // invalid opcode
@@ -25,6 +25,7 @@ public:
 };
 
 // Factory function for creating 6502 instances
-std::unique_ptr<BaseCPU> create6502(NClock *clock) {
-    return std::make_unique<CPU6502>(clock);
+std::unique_ptr<BaseCPU> create6502(NClock *clock, bool traced) {
+    if (traced) return std::make_unique<CPU6502>(clock);
+    return std::make_unique<CPU6502Core<CPU6502Traits, TraceDisabled>>(clock);
 }
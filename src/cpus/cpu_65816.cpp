@@ -29,9 +29,11 @@ private:
 
     BaseCPU *current_core;
 
-    // Helper method to update current CPU based on processor state
-    inline void update_current_core_if_needed(cpu_state* cpu) {
-        BaseCPU *old_core = current_core;
+    // Select the core matching the processor state. Cores flag cpu->mode_switch
+    // from REP/SEP/XCE/PLP/RTI (and WDM handlers) when E, M or X no longer match
+    // their instantiation; anything else that loads P or E should set it too.
+    void select_core(cpu_state* cpu) {
+        cpu->mode_switch = false;
 
         if (cpu->E == 1) {    // Check emulation mode flag (E flag)
             current_core = emulation_core.get();
@@ -51,31 +53,45 @@ private:
                 current_core = native_8_8_core.get();   // 8-bit A, 8-bit X/Y
             }
         }
-        /* if (old_core != current_core) {
-            printf("Switching to core: %s\n", current_core->get_name());
-        } */
+    }
+
+    template<typename TraceTraits>
+    void create_cores(NClock *clock) {
+        emulation_core = std::make_unique<CPU6502Core<CPU65816_E_8_8_Traits, TraceTraits>>(clock);
+        native_8_8_core = std::make_unique<CPU6502Core<CPU65816_N_8_8_Traits, TraceTraits>>(clock);
+        native_16_8_core = std::make_unique<CPU6502Core<CPU65816_N_16_8_Traits, TraceTraits>>(clock);
+        native_8_16_core = std::make_unique<CPU6502Core<CPU65816_N_8_16_Traits, TraceTraits>>(clock);
+        native_16_16_core = std::make_unique<CPU6502Core<CPU65816_N_16_16_Traits, TraceTraits>>(clock);
     }
 
 public:
-    CPU65816(NClock *clock) : BaseCPU(clock) {
-        emulation_core = std::make_unique<CPU6502Core<CPU65816_E_8_8_Traits>>(clock);
-        native_8_8_core = std::make_unique<CPU6502Core<CPU65816_N_8_8_Traits>>(clock);
-        native_16_8_core = std::make_unique<CPU6502Core<CPU65816_N_16_8_Traits>>(clock);
-        native_8_16_core = std::make_unique<CPU6502Core<CPU65816_N_8_16_Traits>>(clock);
-        native_16_16_core = std::make_unique<CPU6502Core<CPU65816_N_16_16_Traits>>(clock);
+    CPU65816(NClock *clock, bool traced = true) : BaseCPU(clock) {
+        if (traced) create_cores<TraceEnabled>(clock);
+        else create_cores<TraceDisabled>(clock);
         
         current_core = emulation_core.get(); // Start in emulation mode
     }
 
     int execute_next(cpu_state* cpu) override {
-        // Check for mode changes (REP/SEP instructions, CLC/XCE)
-        update_current_core_if_needed(cpu); // these should be done inside the cores in REP/SEP/XCE somehow rather than impact every instruction.
+        if (cpu->mode_switch) select_core(cpu);
         return current_core->execute_next(cpu);
     }
+
+    // The current core runs until the budget is spent or it hands off on a mode change.
+    uint64_t execute_budget(cpu_state* cpu, const exec_budget_t &budget) override {
+        uint64_t n = 0;
+        do {
+            if (cpu->mode_switch) select_core(cpu);
+            n += current_core->execute_budget(cpu, budget);
+        } while (in_budget(budget));
+        return n;
+    }
+
     void reset(cpu_state* cpu) override {
         cpu->clock_stopped = false;
         // fill in with register reset logic.
         current_core->reset(cpu);
+        select_core(cpu);
     }
 
     const char *get_name() override { return current_core->get_name(); }
@@ -83,7 +99,7 @@ public:
 
 
 // Factory function for creating 65816 instances
-std::unique_ptr<BaseCPU> create65816(NClock *clock) {
-    return std::make_unique<CPU65816>(clock);
+std::unique_ptr<BaseCPU> create65816(NClock *clock, bool traced) {
+    return std::make_unique<CPU65816>(clock, traced);
 }
 
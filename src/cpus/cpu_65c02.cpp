@@ -25,6 +25,7 @@ public:
 };
 
 // Factory function for creating 65C02 instances
-std::unique_ptr<BaseCPU> create65C02(NClock *clock) {
-    return std::make_unique<CPU65C02>(clock);
+std::unique_ptr<BaseCPU> create65C02(NClock *clock, bool traced) {
+    if (traced) return std::make_unique<CPU65C02>(clock);
+    return std::make_unique<CPU6502Core<CPU65C02Traits, TraceDisabled>>(clock);
 } 
\ No newline at end of file
@@ -5,18 +5,18 @@
 // This file just provides the factory interface
 
 // Factory function to create CPU instances
-std::unique_ptr<BaseCPU> createCPU(const processor_type cpuType, NClock *clock) {
+std::unique_ptr<BaseCPU> createCPU(const processor_type cpuType, NClock *clock, bool traced) {
     // These will be implemented elsewhere and linked in
-    extern std::unique_ptr<BaseCPU> create6502(NClock *clock);
-    extern std::unique_ptr<BaseCPU> create65C02(NClock *clock);
-    extern std::unique_ptr<BaseCPU> create65816(NClock *clock);
+    extern std::unique_ptr<BaseCPU> create6502(NClock *clock, bool traced);
+    extern std::unique_ptr<BaseCPU> create65C02(NClock *clock, bool traced);
+    extern std::unique_ptr<BaseCPU> create65816(NClock *clock, bool traced);
     
     if (cpuType == PROCESSOR_6502) {
-        return create6502(clock);
+        return create6502(clock, traced);
     } else if (cpuType == PROCESSOR_65C02) {
-        return create65C02(clock);
+        return create65C02(clock, traced);
     } else if (cpuType == PROCESSOR_65816) {
-        return create65816(clock);
+        return create65816(clock, traced);
     } else {
         return nullptr;
     }
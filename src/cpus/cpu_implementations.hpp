@@ -11,5 +11,7 @@ class CPU6502;
 class CPU65C02;
 class CPU65816;
 
-// Factory function to create CPU instances
-std::unique_ptr<BaseCPU> createCPU(const processor_type cpuType, NClock *clock); 
\ No newline at end of file
+// Factory function to create CPU instances. traced = false builds the
+// TraceDisabled instantiation, which never touches cpu->trace_entry fields
+// (other than opcode) or the trace buffer.
+std::unique_ptr<BaseCPU> createCPU(const processor_type cpuType, NClock *clock, bool traced = true); 
\ No newline at end of file
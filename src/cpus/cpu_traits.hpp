@@ -1,9 +1,32 @@
 #pragma once
 
+#include <algorithm>
+
 #include "NClock.hpp"
 
 struct cpu_state;
 
+/*
+Run-ahead budget for execute_budget(). The core always executes at least one
+instruction, then keeps going until any of the three timer domains reaches its next scheduled event, or the
+c14M / cpu cycle limits are reached.
+
+Rather than check all of that per instruction, the core turns it into one cpu
+cycle deadline (budget_deadline()): the soonest any of the limits could be
+reached, given the most c14M / video cycles a single cpu cycle can take. Only
+when the cycle counter passes it are the limits checked for real. A device may
+schedule an earlier event from inside a bus access; the timers are pointed at
+*deadline and zero it when that happens, forcing a re-check.
+*/
+struct exec_budget_t {
+    EventTimer *c14m_timer = nullptr;   // 14M domain (computer->event_timer)
+    EventTimer *vid_timer = nullptr;    // video cycle domain
+    EventTimer *cpu_timer = nullptr;    // cpu cycle domain
+    uint64_t c14m_end = UINT64_MAX;     // stop at this c14M (end of frame)
+    uint64_t cycles_end = UINT64_MAX;   // stop at this cpu cycle (free-run slice)
+    uint64_t *deadline = nullptr;       // cpu cycle to re-check at (computer->cpu_budget_deadline)
+};
+
 // Base interface for all CPU implementations
 class BaseCPU {
 private:
@@ -15,9 +38,52 @@ public:
     BaseCPU(NClock *clock) { this->clock = clock; }
     virtual ~BaseCPU() = default;
     virtual int execute_next(cpu_state *cpu) = 0;
+    virtual uint64_t execute_budget(cpu_state *cpu, const exec_budget_t &budget) {
+        uint64_t local_deadline;
+        uint64_t &deadline = budget.deadline ? *budget.deadline : local_deadline;
+        deadline = budget_deadline(budget);
+        uint64_t n = 0;
+        while (true) {
+            execute_next(cpu);
+            n++;
+            if (clock->get_cycles() >= deadline) {
+                if (!in_budget(budget)) break;
+                deadline = budget_deadline(budget);
+            }
+        }
+        return n;
+    }
     virtual void reset(cpu_state *cpu) = 0;
     virtual const char *get_name() = 0;
     virtual void set_clock(NClock *clock) { this->clock = clock; }
+
+protected:
+    // worst case for one cpu cycle: an IIgs sync cycle (up to 27) plus a stretched scanline cycle.
+    static constexpr uint64_t MAX_C14M_PER_CYCLE = 32;
+    static constexpr uint64_t MAX_VID_CYCLES_PER_CYCLE = 3;
+
+    /* Earliest cpu cycle at which in_budget() could be false. Always at least one cycle ahead. */
+    inline uint64_t budget_deadline(const exec_budget_t &budget) const {
+        uint64_t cycles = clock->get_cycles();
+        uint64_t c14m = clock->get_c14m();
+        uint64_t vid = clock->get_vid_cycles();
+        uint64_t cycles_stop = std::min(budget.cycles_end, budget.cpu_timer->next_event_cycle);
+        uint64_t c14m_stop = std::min(budget.c14m_end, budget.c14m_timer->next_event_cycle);
+        uint64_t vid_stop = budget.vid_timer->next_event_cycle;
+
+        uint64_t n = (cycles_stop > cycles) ? cycles_stop - cycles : 0;
+        n = std::min(n, (c14m_stop > c14m) ? (c14m_stop - c14m) / MAX_C14M_PER_CYCLE : 0);
+        n = std::min(n, (vid_stop > vid) ? (vid_stop - vid) / MAX_VID_CYCLES_PER_CYCLE : 0);
+        return cycles + (n ? n : 1);
+    }
+
+    inline bool in_budget(const exec_budget_t &budget) const {
+        uint64_t c14m = clock->get_c14m();
+        uint64_t cycles = clock->get_cycles();
+        return (c14m < budget.c14m_end) && (c14m < budget.c14m_timer->next_event_cycle)
+            && (cycles < budget.cycles_end) && (cycles < budget.cpu_timer->next_event_cycle)
+            && (clock->get_vid_cycles() < budget.vid_timer->next_event_cycle);
+    }
 };
 
 // cpu_traits.hpp
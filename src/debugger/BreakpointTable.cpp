@@ -1,5 +1,8 @@
 #include "debugger/BreakpointTable.hpp"
 
+#include <algorithm>
+#include <iterator>
+
 #include "cpu.hpp"
 
 namespace {
@@ -79,6 +82,7 @@ uint32_t BreakpointTable::add(const bp_entry_t &in, const char **error_msg) {
         enabled_count_++;
     }
     entries_.push_back(e);
+    rebuild_filter();
     return e.id;
 }
 
@@ -89,6 +93,7 @@ bool BreakpointTable::clear_id(uint32_t id) {
                 enabled_count_--;
             }
             entries_.erase(it);
+            rebuild_filter();
             return true;
         }
     }
@@ -98,6 +103,7 @@ bool BreakpointTable::clear_id(uint32_t id) {
 void BreakpointTable::clear_all() {
     entries_.clear();
     enabled_count_ = 0;
+    rebuild_filter();
 }
 
 bool BreakpointTable::set_enabled(uint32_t id, bool enabled) {
@@ -113,6 +119,7 @@ bool BreakpointTable::set_enabled(uint32_t id, bool enabled) {
         e->flags &= ~BP_FLAG_ENABLED;
         enabled_count_--;
     }
+    rebuild_filter();
     return true;
 }
 
@@ -125,6 +132,53 @@ bp_entry_t *BreakpointTable::find(uint32_t id) {
     return nullptr;
 }
 
+/**
+ * Set the filter bit for every page that could contain an address matching e.
+ * Unmasked ranges just set their run of pages. A masked range can match all over
+ * the address space, so test each page: addresses in page p mask to somewhere in
+ * [(p << 8) & mask, ((p << 8) & mask) | (mask & 0xFF)], and the page is armed if
+ * that overlaps the breakpoint's masked range. This can over-arm a page, never under-arm.
+ */
+void BreakpointTable::arm_entry(uint64_t *pages, const bp_entry_t &e) {
+    if (e.kind == BP_KIND_IO) {
+        static const uint32_t io_banks[] = {0x00, 0x01, 0xE0, 0xE1};
+        uint32_t base = e.address & 0xFFFF;
+        for (uint32_t bank : io_banks) {
+            for (uint32_t page = base >> 8; page <= (base + e.length - 1) >> 8; page++) {
+                arm_page(pages, (bank << 8) | page);
+            }
+        }
+        return;
+    }
+    uint64_t masked_base = e.address & e.addr_mask;
+    uint64_t masked_end = masked_base + e.length;   // exclusive
+    if ((e.addr_mask & 0xFFFFFF00) == 0xFFFFFF00) {
+        uint64_t last = std::min<uint64_t>(masked_end - 1, 0xFFFFFF);
+        for (uint64_t page = masked_base >> 8; (page << 8) <= last; page++) {
+            arm_page(pages, static_cast<uint32_t>(page));
+        }
+        return;
+    }
+    for (uint32_t page = 0; page < BP_FILTER_PAGES; page++) {
+        uint64_t lo = (page << 8) & e.addr_mask;
+        uint64_t hi = lo | (e.addr_mask & 0xFF);
+        if (lo < masked_end && masked_base <= hi) {
+            arm_page(pages, page);
+        }
+    }
+}
+
+void BreakpointTable::rebuild_filter() {
+    std::fill(std::begin(exec_pages_), std::end(exec_pages_), 0);
+    std::fill(std::begin(access_pages_), std::end(access_pages_), 0);
+    for (const auto &e : entries_) {
+        if ((e.flags & BP_FLAG_ENABLED) == 0) {
+            continue;
+        }
+        arm_entry(e.kind == BP_KIND_EXEC ? exec_pages_ : access_pages_, e);
+    }
+}
+
 bool BreakpointTable::address_match(uint32_t observed, const bp_entry_t &e) const {
     uint32_t masked_a = observed & e.addr_mask;
     uint32_t masked_base = e.address & e.addr_mask;
@@ -196,6 +250,9 @@ std::optional<StopHit> BreakpointTable::check_pre(cpu_state *cpu) {
             return std::nullopt;
         }
     }
+    if (!exec_may_match(fullpc)) {
+        return std::nullopt;
+    }
     for (size_t i = 0; i < entries_.size();) {
         bp_entry_t &e = entries_[i];
         if ((e.flags & BP_FLAG_ENABLED) == 0 || e.kind != BP_KIND_EXEC) {
@@ -231,6 +288,9 @@ std::optional<StopHit> BreakpointTable::check_post(cpu_state *cpu, const system_
     }
     uint32_t fullpc = (static_cast<uint32_t>(entry->pb) << 16) | entry->pc;
     uint32_t eaddr = entry->eaddr;
+    if (!access_may_match(eaddr)) {
+        return std::nullopt;
+    }
     bool is_write = entry->f_write != 0;
     uint8_t observed = static_cast<uint8_t>(entry->data & 0xFF);
     uint8_t access = is_write ? BP_ACCESS_W : BP_ACCESS_R;
@@ -25,6 +25,9 @@ constexpr uint8_t BP_FLAG_VALID_MASK = BP_FLAG_ENABLED | BP_FLAG_TEMPORARY | BP_
 
 constexpr uint32_t BP_MAX_ENTRIES = 256;
 
+// Page filter covers the 24-bit address space in 256-byte pages.
+constexpr uint32_t BP_FILTER_PAGES = 0x10000;
+
 constexpr uint32_t STOP_BP_EXEC = 1;
 constexpr uint32_t STOP_BP_DATA = 2;
 constexpr uint32_t STOP_BP_IO = 3;
@@ -74,6 +77,11 @@ public:
     const std::vector<bp_entry_t> &entries() const { return entries_; }
     bp_entry_t *find(uint32_t id);
 
+    /** Page filter: false means no enabled EXEC breakpoint can match anywhere in addr's page. */
+    bool exec_may_match(uint32_t addr) const { return page_armed(exec_pages_, addr); }
+    /** Page filter: false means no enabled DATA or IO breakpoint can match anywhere in addr's page. */
+    bool access_may_match(uint32_t addr) const { return page_armed(access_pages_, addr); }
+
     std::optional<StopHit> check_pre(cpu_state *cpu);
     std::optional<StopHit> check_post(cpu_state *cpu, const system_trace_entry_t *entry);
 
@@ -90,10 +98,25 @@ private:
     std::optional<StopHit> maybe_hit(bp_entry_t &e, uint32_t reason, uint32_t pc,
                                      uint32_t eaddr, uint8_t access, uint32_t value);
 
+    // Addresses above 24 bits aren't covered by the filter and always take the full check.
+    static bool page_armed(const uint64_t *pages, uint32_t addr) {
+        if (addr > 0xFFFFFF) {
+            return true;
+        }
+        uint32_t page = addr >> 8;
+        return (pages[page >> 6] >> (page & 63)) & 1;
+    }
+    static void arm_page(uint64_t *pages, uint32_t page) { pages[page >> 6] |= 1ULL << (page & 63); }
+    void arm_entry(uint64_t *pages, const bp_entry_t &e);
+    void rebuild_filter();
+
     std::vector<bp_entry_t> entries_;
     uint32_t next_id_ = 1;
     uint32_t enabled_count_ = 0;
 
+    uint64_t exec_pages_[BP_FILTER_PAGES / 64] = {};
+    uint64_t access_pages_[BP_FILTER_PAGES / 64] = {};
+
     bool suppress_exec_active_ = false;
     uint32_t suppress_exec_pc_ = 0;
 };
@@ -257,6 +257,10 @@ void DebugProtocolServer::wake_bridge_locked() {
 }
 
 void DebugProtocolServer::process_main_thread(computer_t *computer) {
+    // a client can ask for trace history (GetTrace), so record while one is connected.
+    if (computer && computer->cpu && client_fd_.load() >= 0) {
+        computer->cpu->trace = true;
+    }
     std::lock_guard<std::mutex> lock(bridge_mu_);
     if (!bridge_pending_ || bridge_done_) {
         return;
@@ -0,0 +1,431 @@
+#include "debugger/TraceStream.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define GS2_TRACE_STREAM_MMAP 1
+#else
+#define GS2_TRACE_STREAM_MMAP 0
+#endif
+
+namespace {
+
+static_assert(TS_HEADER_SIZE >= sizeof(trace_stream_header_t), "trace stream header too large");
+// mmap offsets must be page aligned; 64K covers every host page size we run on.
+static_assert(TS_HEADER_SIZE % 65536 == 0 && TS_CHUNK_SIZE % 65536 == 0, "trace stream offsets must stay page aligned");
+
+// field-changed bits for the delta encoding. cycle and pc are always present.
+enum : uint32_t {
+    TSF_OPCODE  = 1 << 0,
+    TSF_P       = 1 << 1,
+    TSF_DB      = 1 << 2,
+    TSF_PB      = 1 << 3,
+    TSF_A       = 1 << 4,
+    TSF_X       = 1 << 5,
+    TSF_Y       = 1 << 6,
+    TSF_SP      = 1 << 7,
+    TSF_D       = 1 << 8,
+    TSF_DATA    = 1 << 9,
+    TSF_OPERAND = 1 << 10,
+    TSF_EADDR   = 1 << 11,
+    TSF_FLAGS   = 1 << 12,
+    TSF_UNUSED  = 1 << 13,
+};
+
+inline size_t put_varint(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+inline size_t get_varint(const uint8_t *in, uint64_t &v) {
+    size_t n = 0;
+    int shift = 0;
+    v = 0;
+    uint8_t b;
+    do {
+        b = in[n++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return n;
+}
+
+// traces run to many GB; plain fseek takes a 32-bit long on Windows.
+inline int seek64(FILE *f, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(f, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET);
+#endif
+}
+
+inline uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+} // namespace
+
+/** ------------------------------------------------------------------ */
+/* Encoding */
+
+size_t TraceStream::encode(uint8_t *out, const system_trace_entry_t &e, const system_trace_entry_t &prev) {
+    uint32_t mask = 0;
+    if (e.opcode != prev.opcode) mask |= TSF_OPCODE;
+    if (e.p != prev.p) mask |= TSF_P;
+    if (e.db != prev.db) mask |= TSF_DB;
+    if (e.pb != prev.pb) mask |= TSF_PB;
+    if (e.a != prev.a) mask |= TSF_A;
+    if (e.x != prev.x) mask |= TSF_X;
+    if (e.y != prev.y) mask |= TSF_Y;
+    if (e.sp != prev.sp) mask |= TSF_SP;
+    if (e.d != prev.d) mask |= TSF_D;
+    if (e.data != prev.data) mask |= TSF_DATA;
+    if (e.operand != prev.operand) mask |= TSF_OPERAND;
+    if (e.eaddr != prev.eaddr) mask |= TSF_EADDR;
+    if (e.flags != prev.flags) mask |= TSF_FLAGS;
+    if (e.unused != prev.unused) mask |= TSF_UNUSED;
+
+    size_t n = put_varint(out, mask);
+    n += put_varint(out + n, zigzag((int64_t)(e.cycle - prev.cycle)));
+    n += put_varint(out + n, zigzag((int16_t)(e.pc - prev.pc)));
+    if (mask & TSF_OPCODE) out[n++] = e.opcode;
+    if (mask & TSF_P) out[n++] = e.p;
+    if (mask & TSF_DB) out[n++] = e.db;
+    if (mask & TSF_PB) out[n++] = e.pb;
+    if (mask & TSF_A) n += put_varint(out + n, e.a);
+    if (mask & TSF_X) n += put_varint(out + n, e.x);
+    if (mask & TSF_Y) n += put_varint(out + n, e.y);
+    if (mask & TSF_SP) n += put_varint(out + n, e.sp);
+    if (mask & TSF_D) n += put_varint(out + n, e.d);
+    if (mask & TSF_DATA) n += put_varint(out + n, e.data);
+    if (mask & TSF_OPERAND) n += put_varint(out + n, e.operand);
+    if (mask & TSF_EADDR) n += put_varint(out + n, e.eaddr);
+    if (mask & TSF_FLAGS) n += put_varint(out + n, e.flags);
+    if (mask & TSF_UNUSED) n += put_varint(out + n, e.unused);
+    return n;
+}
+
+size_t TraceStream::decode(const uint8_t *in, system_trace_entry_t &e, const system_trace_entry_t &prev) {
+    uint64_t v;
+    e = prev;
+    size_t n = get_varint(in, v);
+    uint32_t mask = (uint32_t)v;
+    n += get_varint(in + n, v);
+    e.cycle = prev.cycle + (uint64_t)unzigzag(v);
+    n += get_varint(in + n, v);
+    e.pc = (uint16_t)(prev.pc + unzigzag(v));
+    if (mask & TSF_OPCODE) e.opcode = in[n++];
+    if (mask & TSF_P) e.p = in[n++];
+    if (mask & TSF_DB) e.db = in[n++];
+    if (mask & TSF_PB) e.pb = in[n++];
+    if (mask & TSF_A) { n += get_varint(in + n, v); e.a = (uint16_t)v; }
+    if (mask & TSF_X) { n += get_varint(in + n, v); e.x = (uint16_t)v; }
+    if (mask & TSF_Y) { n += get_varint(in + n, v); e.y = (uint16_t)v; }
+    if (mask & TSF_SP) { n += get_varint(in + n, v); e.sp = (uint16_t)v; }
+    if (mask & TSF_D) { n += get_varint(in + n, v); e.d = (uint16_t)v; }
+    if (mask & TSF_DATA) { n += get_varint(in + n, v); e.data = (uint16_t)v; }
+    if (mask & TSF_OPERAND) { n += get_varint(in + n, v); e.operand = (uint32_t)v; }
+    if (mask & TSF_EADDR) { n += get_varint(in + n, v); e.eaddr = (uint32_t)v; }
+    if (mask & TSF_FLAGS) { n += get_varint(in + n, v); e.flags = (uint16_t)v; }
+    if (mask & TSF_UNUSED) { n += get_varint(in + n, v); e.unused = (uint16_t)v; }
+    return n;
+}
+
+/** ------------------------------------------------------------------ */
+/* Writer */
+
+TraceStream::~TraceStream() {
+    close();
+}
+
+bool TraceStream::open(const std::string &filename, processor_type cpu_type) {
+#if !GS2_TRACE_STREAM_MMAP
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TraceStream: not supported on this platform");
+    return false;
+#else
+    if (fd_ >= 0) {
+        close();
+    }
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TraceStream: open(%s): %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+    fd_ = fd;
+
+    header_ = {};
+    header_.magic = TS_MAGIC;
+    header_.version = TS_VERSION;
+    header_.cpu_type = (uint32_t)cpu_type;
+    header_.chunk_size = TS_CHUNK_SIZE;
+    if (::pwrite(fd_, &header_, sizeof(header_), 0) != (ssize_t)sizeof(header_)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TraceStream: header write failed: %s", strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    buffers_ = new uint8_t[TS_BUFFER_CHUNKS * TS_CHUNK_SIZE];
+    chunks_sealed_ = 0;
+    chunks_ready_.store(0, std::memory_order_relaxed);
+    chunks_written_ = 0;
+    closing_.store(false, std::memory_order_relaxed);
+    entries_ = 0;
+    index_.clear();
+    map_ = nullptr;
+
+    filled_sem_ = SDL_CreateSemaphore(0);
+    free_sem_ = SDL_CreateSemaphore(TS_BUFFER_CHUNKS - 1); // chunk 0 is claimed below
+    chunk_ = reinterpret_cast<trace_chunk_header_t *>(buffers_);
+    payload_ = buffers_ + sizeof(trace_chunk_header_t);
+    chunk_->entry_count = 0;
+    used_ = 0;
+
+    thread_ = SDL_CreateThread(thread_entry, "gs2-trace-stream", this);
+    if (!thread_) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TraceStream: SDL_CreateThread failed: %s", SDL_GetError());
+        SDL_DestroySemaphore(filled_sem_);
+        SDL_DestroySemaphore(free_sem_);
+        filled_sem_ = free_sem_ = nullptr;
+        delete[] buffers_;
+        buffers_ = nullptr;
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    printf("Streaming trace to file: %s\n", filename.c_str());
+    return true;
+#endif
+}
+
+void TraceStream::start_chunk(const system_trace_entry_t &entry) {
+    chunk_->magic = TS_CHUNK_MAGIC;
+    chunk_->entry_count = 1;
+    chunk_->payload_bytes = 0;
+    chunk_->reserved = 0;
+    chunk_->first_entry = entries_;
+    chunk_->key = entry;
+    used_ = 0;
+    prev_ = entry;
+    index_.push_back({entries_, entry.cycle});
+    entries_++;
+}
+
+// hand the current chunk to the worker and claim the next buffer in the ring.
+void TraceStream::seal_chunk() {
+    chunk_->payload_bytes = (uint32_t)used_;
+    // zero the tail so the file contents are deterministic.
+    memset(payload_ + used_, 0, TS_PAYLOAD_SIZE - used_);
+    chunks_sealed_++;
+    chunks_ready_.store(chunks_sealed_, std::memory_order_release);
+    SDL_SignalSemaphore(filled_sem_);
+
+    SDL_WaitSemaphore(free_sem_);
+    uint8_t *buf = buffers_ + (chunks_sealed_ % TS_BUFFER_CHUNKS) * TS_CHUNK_SIZE;
+    chunk_ = reinterpret_cast<trace_chunk_header_t *>(buf);
+    payload_ = buf + sizeof(trace_chunk_header_t);
+    chunk_->entry_count = 0;
+    used_ = 0;
+}
+
+void TraceStream::close() {
+#if GS2_TRACE_STREAM_MMAP
+    if (fd_ < 0) {
+        return;
+    }
+    if (chunk_->entry_count > 0) {
+        seal_chunk();
+    }
+    closing_.store(true, std::memory_order_release);
+    SDL_SignalSemaphore(filled_sem_);
+    SDL_WaitThread(thread_, nullptr);
+    thread_ = nullptr;
+
+    if (map_) {
+        munmap(map_, TS_MAP_CHUNKS * TS_CHUNK_SIZE);
+        map_ = nullptr;
+    }
+
+    // index goes right after the last chunk; trim off the rest of the last map window.
+    uint64_t index_offset = TS_HEADER_SIZE + chunks_written_ * TS_CHUNK_SIZE;
+    size_t index_bytes = index_.size() * sizeof(trace_stream_index_t);
+    if (::ftruncate(fd_, (off_t)index_offset) != 0 ||
+        (index_bytes && ::pwrite(fd_, index_.data(), index_bytes, (off_t)index_offset) != (ssize_t)index_bytes)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TraceStream: index write failed: %s", strerror(errno));
+        index_offset = 0;
+    }
+    header_.chunk_count = chunks_written_;
+    header_.entry_count = entries_;
+    header_.index_offset = index_offset;
+    if (::pwrite(fd_, &header_, sizeof(header_), 0) != (ssize_t)sizeof(header_)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TraceStream: header write failed: %s", strerror(errno));
+    }
+    ::close(fd_);
+    fd_ = -1;
+    printf("Trace stream closed: %llu entries in %llu chunks\n",
+        (unsigned long long)entries_, (unsigned long long)chunks_written_);
+
+    SDL_DestroySemaphore(filled_sem_);
+    SDL_DestroySemaphore(free_sem_);
+    filled_sem_ = free_sem_ = nullptr;
+    delete[] buffers_;
+    buffers_ = nullptr;
+    chunk_ = nullptr;
+    index_.clear();
+#endif
+}
+
+int SDLCALL TraceStream::thread_entry(void *data) {
+    static_cast<TraceStream *>(data)->worker_loop();
+    return 0;
+}
+
+// one wakeup per sealed chunk, plus one from close().
+void TraceStream::worker_loop() {
+    while (true) {
+        SDL_WaitSemaphore(filled_sem_);
+        if (chunks_written_ < chunks_ready_.load(std::memory_order_acquire)) {
+            write_chunk(chunks_written_, buffers_ + (chunks_written_ % TS_BUFFER_CHUNKS) * TS_CHUNK_SIZE);
+            chunks_written_++;
+            SDL_SignalSemaphore(free_sem_);
+            continue;
+        }
+        if (closing_.load(std::memory_order_acquire)) {
+            break;
+        }
+    }
+}
+
+void TraceStream::write_chunk(uint64_t chunk_no, const uint8_t *data) {
+#if GS2_TRACE_STREAM_MMAP
+    uint64_t window = chunk_no / TS_MAP_CHUNKS;
+    size_t window_bytes = TS_MAP_CHUNKS * TS_CHUNK_SIZE;
+    if (!map_ || window != map_first_chunk_ / TS_MAP_CHUNKS) {
+        if (map_) {
+            munmap(map_, window_bytes);
+            map_ = nullptr;
+        }
+        off_t offset = (off_t)(TS_HEADER_SIZE + window * window_bytes);
+        if (::ftruncate(fd_, offset + (off_t)window_bytes) == 0) {
+            void *p = mmap(nullptr, window_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+            if (p != MAP_FAILED) {
+                map_ = static_cast<uint8_t *>(p);
+                map_first_chunk_ = window * TS_MAP_CHUNKS;
+            }
+        }
+    }
+    if (map_) {
+        memcpy(map_ + (chunk_no - map_first_chunk_) * TS_CHUNK_SIZE, data, TS_CHUNK_SIZE);
+    } else {
+        // couldn't map; plain write so the trace isn't lost.
+        ::pwrite(fd_, data, TS_CHUNK_SIZE, (off_t)(TS_HEADER_SIZE + chunk_no * TS_CHUNK_SIZE));
+    }
+#endif
+}
+
+/** ------------------------------------------------------------------ */
+/* Reader */
+
+TraceStreamReader::~TraceStreamReader() {
+    if (file_) {
+        fclose(file_);
+    }
+}
+
+bool TraceStreamReader::is_trace_stream(const std::string &filename) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    uint32_t magic = 0;
+    bool ok = fread(&magic, sizeof(magic), 1, f) == 1 && magic == TS_MAGIC;
+    fclose(f);
+    return ok;
+}
+
+bool TraceStreamReader::open(const std::string &filename) {
+    file_ = fopen(filename.c_str(), "rb");
+    if (!file_) {
+        return false;
+    }
+    if (fread(&header_, sizeof(header_), 1, file_) != 1 || header_.magic != TS_MAGIC
+        || header_.version != TS_VERSION || header_.chunk_size != TS_CHUNK_SIZE) {
+        return false;
+    }
+    chunk_buf_.resize(TS_CHUNK_SIZE);
+
+    if (header_.index_offset == 0) {
+        return rebuild_index();
+    }
+    index_.resize(header_.chunk_count);
+    if (seek64(file_, header_.index_offset) != 0 ||
+        fread(index_.data(), sizeof(trace_stream_index_t), index_.size(), file_) != index_.size()) {
+        return rebuild_index();
+    }
+    return true;
+}
+
+// file wasn't closed cleanly: walk chunk headers until one is missing or torn.
+bool TraceStreamReader::rebuild_index() {
+    index_.clear();
+    header_.entry_count = 0;
+    trace_chunk_header_t ch;
+    for (uint64_t n = 0;; n++) {
+        if (seek64(file_, TS_HEADER_SIZE + n * TS_CHUNK_SIZE) != 0) break;
+        if (fread(&ch, sizeof(ch), 1, file_) != 1) break;
+        if (ch.magic != TS_CHUNK_MAGIC || ch.entry_count == 0 || ch.payload_bytes > TS_PAYLOAD_SIZE) break;
+        index_.push_back({ch.first_entry, ch.key.cycle});
+        header_.entry_count = ch.first_entry + ch.entry_count;
+    }
+    header_.chunk_count = index_.size();
+    return true;
+}
+
+size_t TraceStreamReader::find_chunk_by_entry(uint64_t entry) const {
+    auto it = std::upper_bound(index_.begin(), index_.end(), entry,
+        [](uint64_t v, const trace_stream_index_t &ix) { return v < ix.first_entry; });
+    return it == index_.begin() ? 0 : (size_t)(it - index_.begin()) - 1;
+}
+
+size_t TraceStreamReader::find_chunk_by_cycle(uint64_t cycle) const {
+    auto it = std::upper_bound(index_.begin(), index_.end(), cycle,
+        [](uint64_t v, const trace_stream_index_t &ix) { return v < ix.first_cycle; });
+    return it == index_.begin() ? 0 : (size_t)(it - index_.begin()) - 1;
+}
+
+bool TraceStreamReader::read_chunk(size_t chunk, std::vector<system_trace_entry_t> &out) {
+    out.clear();
+    if (chunk >= index_.size()) {
+        return false;
+    }
+    if (seek64(file_, TS_HEADER_SIZE + chunk * TS_CHUNK_SIZE) != 0 ||
+        fread(chunk_buf_.data(), TS_CHUNK_SIZE, 1, file_) != 1) {
+        return false;
+    }
+    const trace_chunk_header_t *ch = reinterpret_cast<const trace_chunk_header_t *>(chunk_buf_.data());
+    const uint8_t *payload = chunk_buf_.data() + sizeof(trace_chunk_header_t);
+    if (ch->magic != TS_CHUNK_MAGIC || ch->payload_bytes > TS_PAYLOAD_SIZE) {
+        return false;
+    }
+    out.reserve(ch->entry_count);
+    out.push_back(ch->key);
+    size_t pos = 0;
+    for (uint32_t i = 1; i < ch->entry_count; i++) {
+        system_trace_entry_t e;
+        pos += TraceStream::decode(payload + pos, e, out.back());
+        if (pos > ch->payload_bytes) {
+            return false;
+        }
+        out.push_back(e);
+    }
+    return true;
+}
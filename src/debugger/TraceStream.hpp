@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "debugger/trace.hpp"
+
+/**
+ * Streaming trace file.
+ *
+ * The in-memory system_trace_buffer is a ring and wraps. A TraceStream keeps
+ * every entry, so whole boot sequences can be traced. Entries are
+ * delta-encoded against the previous entry into fixed-size chunks. The main
+ * thread fills chunks; a worker thread copies sealed chunks into the file
+ * through an mmap'd window.
+ *
+ * File layout (little-endian):
+ *   [0, TS_HEADER_SIZE)    trace_stream_header_t
+ *   chunk 0, chunk 1, ...  TS_CHUNK_SIZE bytes each
+ *   index                  trace_stream_index_t[chunk_count]
+ * The header's chunk_count / entry_count / index_offset are filled in on close.
+ * If the emulator dies before that, the reader rebuilds the index by scanning
+ * the chunk headers.
+ *
+ * Each chunk starts with its first entry stored whole, so any chunk can be
+ * decoded on its own. That's what makes random seeking work.
+ */
+
+constexpr uint32_t TS_MAGIC = 0x52545347; // "GSTR"
+constexpr uint32_t TS_CHUNK_MAGIC = 0x4B435354; // "TSCK"
+constexpr uint32_t TS_VERSION = 1;
+constexpr size_t TS_HEADER_SIZE = 64 * 1024;
+constexpr size_t TS_CHUNK_SIZE = 64 * 1024;
+constexpr size_t TS_MAX_ENCODED = 64;      // worst case bytes for one delta-encoded entry
+constexpr size_t TS_BUFFER_CHUNKS = 32;    // chunks in flight between main and worker
+constexpr size_t TS_MAP_CHUNKS = 256;      // chunks per mmap window (16MB)
+
+struct trace_stream_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cpu_type;
+    uint32_t chunk_size;
+    uint64_t chunk_count;
+    uint64_t entry_count;
+    uint64_t index_offset;      // 0 if the file was not closed cleanly
+};
+
+struct trace_chunk_header_t {
+    uint32_t magic;
+    uint32_t entry_count;
+    uint32_t payload_bytes;     // delta bytes following the header
+    uint32_t reserved;
+    uint64_t first_entry;       // stream position of key
+    system_trace_entry_t key;   // first entry of the chunk, stored raw
+};
+
+struct trace_stream_index_t {
+    uint64_t first_entry;
+    uint64_t first_cycle;
+};
+
+constexpr size_t TS_PAYLOAD_SIZE = TS_CHUNK_SIZE - sizeof(trace_chunk_header_t);
+
+class TraceStream {
+public:
+    TraceStream() = default;
+    ~TraceStream();
+
+    TraceStream(const TraceStream &) = delete;
+    TraceStream &operator=(const TraceStream &) = delete;
+
+    /** Create (truncate) filename and start the writer thread. */
+    bool open(const std::string &filename, processor_type cpu_type);
+    /** Flush the partial chunk, wait for the writer, write the index and header. */
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+
+    /** Main thread only. Blocks if the writer thread is TS_BUFFER_CHUNKS behind. */
+    inline void append(const system_trace_entry_t &entry) {
+        if (chunk_->entry_count == 0) {
+            start_chunk(entry);
+            return;
+        }
+        if (used_ + TS_MAX_ENCODED > TS_PAYLOAD_SIZE) {
+            seal_chunk();
+            start_chunk(entry);
+            return;
+        }
+        used_ += encode(payload_ + used_, entry, prev_);
+        chunk_->entry_count++;
+        prev_ = entry;
+        entries_++;
+    }
+
+    uint64_t entry_count() const { return entries_; }
+
+    static size_t encode(uint8_t *out, const system_trace_entry_t &e, const system_trace_entry_t &prev);
+    static size_t decode(const uint8_t *in, system_trace_entry_t &e, const system_trace_entry_t &prev);
+
+private:
+    static int SDLCALL thread_entry(void *data);
+    void worker_loop();
+    void write_chunk(uint64_t chunk_no, const uint8_t *data);
+
+    void start_chunk(const system_trace_entry_t &entry);
+    void seal_chunk();
+
+    int fd_ = -1;
+    trace_stream_header_t header_{};
+
+    // chunk ring shared with the worker. main fills chunks in order, worker drains in order.
+    uint8_t *buffers_ = nullptr;
+    uint64_t chunks_sealed_ = 0;            // main thread
+    std::atomic<uint64_t> chunks_ready_{0}; // published to worker
+    uint64_t chunks_written_ = 0;           // worker thread
+    std::atomic<bool> closing_{false};
+    SDL_Thread *thread_ = nullptr;
+    SDL_Semaphore *filled_sem_ = nullptr;
+    SDL_Semaphore *free_sem_ = nullptr;
+
+    // chunk being filled (main thread)
+    trace_chunk_header_t *chunk_ = nullptr;
+    uint8_t *payload_ = nullptr;
+    size_t used_ = 0;
+    system_trace_entry_t prev_{};
+    uint64_t entries_ = 0;
+    std::vector<trace_stream_index_t> index_;
+
+    // worker's mmap window
+    uint8_t *map_ = nullptr;
+    uint64_t map_first_chunk_ = 0;
+};
+
+/**
+ * Random-access reader for TraceStream files.
+ */
+class TraceStreamReader {
+public:
+    TraceStreamReader() = default;
+    ~TraceStreamReader();
+
+    /** Returns false if filename is not a trace stream. */
+    bool open(const std::string &filename);
+
+    processor_type cpu_type() const { return (processor_type)header_.cpu_type; }
+    size_t chunk_count() const { return index_.size(); }
+    uint64_t entry_count() const { return header_.entry_count; }
+
+    /** Chunk holding stream position entry (or the last chunk). */
+    size_t find_chunk_by_entry(uint64_t entry) const;
+    /** Chunk holding the first entry at or after cycle. */
+    size_t find_chunk_by_cycle(uint64_t cycle) const;
+
+    uint64_t chunk_first_entry(size_t chunk) const { return index_[chunk].first_entry; }
+
+    /** Decode every entry of chunk into out. */
+    bool read_chunk(size_t chunk, std::vector<system_trace_entry_t> &out);
+
+    static bool is_trace_stream(const std::string &filename);
+
+private:
+    bool rebuild_index();
+
+    FILE *file_ = nullptr;
+    trace_stream_header_t header_{};
+    std::vector<trace_stream_index_t> index_;
+    std::vector<uint8_t> chunk_buf_;
+};
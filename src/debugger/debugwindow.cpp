@@ -1096,6 +1096,7 @@ void debug_window_t::set_open() {
     disasm = new Disassembler(mmu, cpu->cpu_type); // used in monitor pane
     step_disasm = new Disassembler(mmu, cpu->cpu_type); // used in trace pane
     monitor_.bind(mmu, &memory_watches, computer->breakpoints, disasm, &debug_displays, cpu->trace_buffer);
+    cpu->trace = true; // the trace pane reads it
     window_open = true;
     computer->video_system->show(window);
     computer->video_system->raise(window);
@@ -1103,6 +1104,7 @@ void debug_window_t::set_open() {
 
 void debug_window_t::set_closed() {
     window_open = false;
+    if (!cpu->trace_buffer->stream) cpu->trace = false;
 
     computer->video_system->hide(window);
     computer->video_system->raise(computer->video_system->window); // TODO: awkward.
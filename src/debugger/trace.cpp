@@ -4,6 +4,7 @@
 
 #include "util/HexDecode.hpp"
 #include "debugger/trace.hpp"
+#include "debugger/TraceStream.hpp"
 #include "debugger/trace_opcodes.hpp"
 #include "opcodes.hpp"
 #include "debugger/line_buffer.hpp"
@@ -19,6 +20,7 @@
     }
 
     system_trace_buffer::~system_trace_buffer() {
+        close_stream();
         if (entries != nullptr) {
             delete[] entries;
         }
@@ -38,8 +40,30 @@
             }
         }
         count++;
+        if (stream) {
+            stream->append(entry);
+        }
     }   
 
+    bool system_trace_buffer::open_stream(const std::string &filename) {
+        close_stream();
+        stream = new TraceStream();
+        if (!stream->open(filename, cpu_type)) {
+            delete stream;
+            stream = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void system_trace_buffer::close_stream() {
+        if (stream) {
+            stream->close();
+            delete stream;
+            stream = nullptr;
+        }
+    }
+
     void system_trace_buffer::save_to_file(const std::string &filename) {
         printf("Saving trace to file: %s\n", filename.c_str());
         printf("Head: %zu, Tail: %zu, Size: %zu\n", head, tail, size);
@@ -46,6 +46,8 @@ struct system_trace_entry_t {
     uint16_t unused;
 };
 
+class TraceStream;
+
 struct system_trace_buffer {
     system_trace_entry_t *entries;
     size_t size;
@@ -55,6 +57,7 @@ struct system_trace_buffer {
     processor_type cpu_type;
     int16_t cpu_mask;
     std::unordered_map<uint32_t, std::string> labels;
+    TraceStream *stream = nullptr; // if set, every entry is also appended here.
 
     system_trace_buffer(size_t capacity, processor_type cpu_type);
     ~system_trace_buffer();
@@ -63,6 +66,10 @@ struct system_trace_buffer {
 
     void save_to_file(const std::string &filename);
 
+    /** Also stream every entry to filename (see TraceStream.hpp). */
+    bool open_stream(const std::string &filename);
+    void close_stream();
+
     void read_from_file(const std::string &filename);
 
     system_trace_entry_t *get_entry(size_t index);
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "util/DebugFormatter.hpp"
+#include "util/Snapshot.hpp"
 
 struct ADB_Register 
 {
@@ -35,6 +36,10 @@ public:
     virtual ADB_Register talk(uint8_t command, uint8_t reg) = 0;
     virtual bool process_event(SDL_Event &event) = 0;
 
+    // The ADB registers (address, handler ID, pending data). Host input still queued isn't saved.
+    void save_state(SnapshotWriter &w) { w.put(registers); }
+    bool load_state(SnapshotReader &r) { return r.get(registers); }
+
 
     virtual void debug_display(DebugFormatter *df) {
         df->addLine(" [%d] Regs: 0:%02X%02X 1:%02X%02X 2:%02X%02X 3:%02X%02X", 
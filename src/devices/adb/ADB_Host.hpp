@@ -17,6 +17,17 @@ class ADB_Host
         devices.push_back(device);
     }
 
+    void save_state(SnapshotWriter &w) {
+        for (ADB_Device *device : devices) device->save_state(w);
+    }
+
+    bool load_state(SnapshotReader &r) {
+        for (ADB_Device *device : devices) {
+            if (!device->load_state(r)) return false;
+        }
+        return true;
+    }
+
     bool reset(uint8_t addr, uint8_t cmd, uint8_t reg) {
         for (auto &device : devices) {
             device->reset(cmd, reg);
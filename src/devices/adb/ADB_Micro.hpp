@@ -220,6 +220,46 @@ class KeyGloo
         void on_em_c024_y_read(); */
         void step_em_closed_loop();
     
+        // Microcontroller RAM, command/response state and the ADB devices' registers.
+        void save_state(SnapshotWriter &w) {
+            w.put(ram);
+            w.put(key_mods);
+            w.put(key_codes);
+            w.put(configuration_bytes);
+            w.put(modes_byte);
+            w.put(cmd);
+            w.put(cmd_index);
+            w.put(cmd_bytes);
+            w.put(response);
+            w.put(response_bytes);
+            w.put(response_index);
+            w.put(error_byte);
+            w.put(key_latch);
+            w.put(last_key_down);
+            w.put(mouse_data);
+            w.put(reset_counter);
+            w.put(send_data_register);
+            w.put(status);
+            w.put(datareg);
+            w.put(keysdown);
+            adb_host->save_state(w);
+        }
+
+        bool load_state(SnapshotReader &r) {
+            bool ok = r.get(ram) && r.get(key_mods) && r.get(key_codes)
+                && r.get(configuration_bytes) && r.get(modes_byte)
+                && r.get(cmd) && r.get(cmd_index) && r.get(cmd_bytes)
+                && r.get(response) && r.get(response_bytes) && r.get(response_index)
+                && r.get(error_byte) && r.get(key_latch) && r.get(last_key_down)
+                && r.get(mouse_data) && r.get(reset_counter) && r.get(send_data_register)
+                && r.get(status) && r.get(datareg) && r.get(keysdown)
+                && adb_host->load_state(r);
+            if (!ok || cmd_index > sizeof(cmd) || cmd_bytes > sizeof(cmd)
+                || response_index > sizeof(response) || response_bytes > sizeof(response)) return false;
+            update_interrupt_status();
+            return true;
+        }
+
         // zero out 0x51 to force a power-on reset.
         void zero_0x51() {
             ram[0x51] = 0;
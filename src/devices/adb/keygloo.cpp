@@ -150,6 +150,10 @@ void init_slot_keygloo(computer_t *computer, SlotType_t slot) {
         }
     );
 
+    computer->register_snapshot_handler(snapshot_tag("ADB "), 1,
+        [kb_state](SnapshotWriter &w) { kb_state->kg->save_state(w); },
+        [kb_state](SnapshotReader &r, std::string &err) { return kb_state->kg->load_state(r); });
+
     computer->register_reset_handler([kb_state](bool cold_start) {
         if (cold_start) {
             kb_state->kg->zero_0x51();
@@ -180,6 +180,8 @@ public:
 
     void frameUpdate(bool soundEffects) {
         check_motor_off_timer();
+        drives[0].flush_update();
+        drives[1].flush_update();
 
         if (soundEffects) {
             soundeffects_update();
@@ -336,6 +338,23 @@ public:
         return drives[key.drive].status();
     }
 
+    void save_state(SnapshotWriter &w) {
+        w.put(switches);
+        w.put(motor_on);
+        w.put(mark_cycles_turnoff);
+        w.put(data_register);
+        w.put(sequencer_state);
+        drives[0].save_state(w);
+        drives[1].save_state(w);
+    }
+
+    bool load_state(SnapshotReader &r, std::string &err) {
+        bool ok = r.get(switches) && r.get(motor_on) && r.get(mark_cycles_turnoff)
+            && r.get(data_register) && r.get(sequencer_state);
+        if (!ok || diskii_select > 1) return false;
+        return drives[0].load_state(r, err) && drives[1].load_state(r, err);
+    }
+
     DebugFormatter *debug() {
         DebugFormatter *f = new DebugFormatter();
         f->addLine("Drive Select: %d", diskii_select);
@@ -110,6 +110,13 @@ void init_slot_ndiskII_woz(computer_t *computer, SlotType_t slot) {
             return true;
         });
 
+    // one chunk per card: "DII" plus the slot digit.
+    char tag[5] = "DII0";
+    tag[3] = (char)('0' + slot);
+    computer->register_snapshot_handler(snapshot_tag(tag), 1,
+        [diskII_d](SnapshotWriter &w) { diskII_d->dc->save_state(w); },
+        [diskII_d](SnapshotReader &r, std::string &err) { return diskII_d->dc->load_state(r, err); });
+
     computer->device_frame_dispatcher->registerHandler(
         [diskII_d]() {
             // we call the disk controller class frame update because it owns its own sound effects.
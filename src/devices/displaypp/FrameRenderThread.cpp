@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include "FrameRenderThread.hpp"
+
+FrameRenderThread::FrameRenderThread(FrameVSG *frame_vsg) : frame_vsg(frame_vsg) {
+    size_t size = sizeof(RGBA_t) * FrameVSG::max_width() * FrameVSG::max_height();
+    pixels = static_cast<RGBA_t *>(operator new(size, std::align_val_t(64)));
+    memset(pixels, 0, size);
+    scans = new ScanBuffer();
+}
+
+FrameRenderThread::~FrameRenderThread() {
+    if (thread) {
+        // the texture may already be gone at teardown, so don't upload the last frame.
+        if (busy) SDL_WaitSemaphore(done_sem);
+        quitting.store(true, std::memory_order_release);
+        SDL_SignalSemaphore(work_sem);
+        SDL_WaitThread(thread, nullptr);
+        thread = nullptr;
+    }
+    if (work_sem) SDL_DestroySemaphore(work_sem);
+    if (done_sem) SDL_DestroySemaphore(done_sem);
+    delete scans;
+    operator delete(pixels, std::align_val_t(64));
+}
+
+bool FrameRenderThread::start() {
+    work_sem = SDL_CreateSemaphore(0);
+    done_sem = SDL_CreateSemaphore(0);
+    thread = SDL_CreateThread(thread_entry, "gs2-render", this);
+    if (!thread) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FrameRenderThread: SDL_CreateThread failed: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void FrameRenderThread::collect() {
+    if (!busy) return;
+    SDL_WaitSemaphore(done_sem);
+    busy = false;
+    SDL_UpdateTexture(frame_vsg->get_texture(), nullptr, pixels, FrameVSG::max_width() * sizeof(RGBA_t));
+}
+
+void FrameRenderThread::submit(VideoScanGeneratorIntf *vsg, ScanBuffer *scanbuf) {
+    scans->take_frame(*scanbuf);
+    job_vsg = vsg;
+    busy = true;
+    SDL_SignalSemaphore(work_sem);
+}
+
+int SDLCALL FrameRenderThread::thread_entry(void *data) {
+    static_cast<FrameRenderThread *>(data)->worker_loop();
+    return 0;
+}
+
+// one wakeup per submit(), plus one from the destructor.
+void FrameRenderThread::worker_loop() {
+    while (true) {
+        SDL_WaitSemaphore(work_sem);
+        if (quitting.load(std::memory_order_acquire)) {
+            break;
+        }
+        frame_vsg->attach(pixels);
+        job_vsg->generate_frame(scans);
+        SDL_SignalSemaphore(done_sem);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+
+#include <SDL3/SDL.h>
+
+#include "frame/Frames.hpp"
+#include "ScanBuffer.hpp"
+#include "VideoScanGenerator_Intf.hpp"
+
+/**
+ * Runs the VideoScanGenerator (scans -> RGBA) on a worker thread, one frame
+ * behind the emulation.
+ *
+ * Each frame the main thread calls collect() to wait for the frame in
+ * flight and upload it into frame_vsg's texture, then submit() to hand over
+ * the next frame's scans. The worker draws into its own memory buffer, so the
+ * only SDL calls (texture upload and present) stay on the main thread.
+ *
+ * There is no locking around the generators. Any main-thread change to
+ * generator settings (mono mode, char set, render target, etc.) or to the
+ * tables they read (the NTSC LUT) must call collect() first: changing them
+ * while the worker is drawing is a data race, i.e. undefined behaviour, not
+ * just a torn frame.
+ */
+class FrameRenderThread {
+public:
+    explicit FrameRenderThread(FrameVSG *frame_vsg);
+    ~FrameRenderThread();
+
+    FrameRenderThread(const FrameRenderThread &) = delete;
+    FrameRenderThread &operator=(const FrameRenderThread &) = delete;
+
+    /** Start the worker. Returns false if the thread couldn't be created. */
+    bool start();
+
+    /** Main thread. Wait for the submitted frame (if any) and copy it into frame_vsg's texture. */
+    void collect();
+
+    /** Main thread, after collect(). Move the next frame's scans out of scanbuf and draw them with vsg. */
+    void submit(VideoScanGeneratorIntf *vsg, ScanBuffer *scanbuf);
+
+private:
+    static int SDLCALL thread_entry(void *data);
+    void worker_loop();
+
+    FrameVSG *frame_vsg;
+    RGBA_t *pixels = nullptr;           // worker draws here
+    ScanBuffer *scans = nullptr;        // worker's copy of one frame of scans
+    VideoScanGeneratorIntf *job_vsg = nullptr;
+
+    bool busy = false;                  // main thread: a frame has been submitted and not collected
+    std::atomic<bool> quitting{false};
+    SDL_Thread *thread = nullptr;
+    SDL_Semaphore *work_sem = nullptr;
+    SDL_Semaphore *done_sem = nullptr;
+};
@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <cstring>
 #include "ScanBuffer.hpp"
 #include "VideoScannerII.hpp"
 
@@ -30,4 +31,38 @@ void ScanBuffer::saveToFile(const char *filename)
         fprintf(file, "\n");
     }
     fclose(file);
-}
\ No newline at end of file
+}
+
+uint64_t ScanBuffer::frame_signature() const
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    uint32_t count = get_count();
+    for (uint32_t i = 0; i < count; i++) {
+        Scan_t scan = get(i);
+        uint64_t w;
+        memcpy(&w, &scan, sizeof(w));
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+        if (scan.mode == VM_VSYNC) break;
+    }
+    return h;
+}
+
+void ScanBuffer::skip_frame()
+{
+    uint32_t count = get_count();
+    while (count--) {
+        if (pull().mode == VM_VSYNC) break;
+    }
+}
+
+void ScanBuffer::take_frame(ScanBuffer &src)
+{
+    clear();
+    uint32_t count = src.get_count();
+    while (count--) {
+        Scan_t scan = src.pull();
+        push(scan);
+        if (scan.mode == VM_VSYNC) break;
+    }
+}
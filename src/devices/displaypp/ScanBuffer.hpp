@@ -20,4 +20,11 @@ public:
     inline void clear() noexcept { write_pos = 0; read_pos = 0; };
     inline Scan_t get(uint32_t index) const noexcept { return buffer[(read_pos + index) & BUFFER_MASK]; };
     void saveToFile(const char *filename);
+
+    /** Hash of the scans up to and including the next VSYNC (what one generate_frame consumes). Doesn't pull anything. */
+    uint64_t frame_signature() const;
+    /** Pull the scans up to and including the next VSYNC without drawing them. */
+    void skip_frame();
+    /** Replace our contents with the next frame's scans (up to and including VSYNC) pulled from src. */
+    void take_frame(ScanBuffer &src);
 };
\ No newline at end of file
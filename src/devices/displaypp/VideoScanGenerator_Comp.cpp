@@ -64,6 +64,16 @@ void VideoScanGenerator_Comp::build_hires40Font(bool delayEnabled)
 
 
 
+void VideoScanGenerator_Comp::skip_frame(ScanBuffer *frame_scan)
+{
+    flash_counter++;
+    if (flash_counter > 14) {
+        flash_state = !flash_state;
+        flash_counter = 0;
+    }
+    frame_scan->skip_frame();
+}
+
 void VideoScanGenerator_Comp::generate_frame(ScanBuffer *frame_scan)
 {
     /* mode = { .p = 0 }; 
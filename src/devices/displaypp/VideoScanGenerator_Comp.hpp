@@ -55,7 +55,10 @@ public:
     VideoScanGenerator_Comp(CharRom *charrom, bool border_enabled = false, FrameVSG *frame_vsg = nullptr);
 
     virtual void generate_frame(ScanBuffer *frame_scan);
+    virtual void skip_frame(ScanBuffer *frame_scan);
+    virtual bool next_flash_state() const { return (flash_counter + 1 > 14) ? !flash_state : flash_state; }
     virtual void set_display_shift(bool enable) { display_shift_enabled = enable; }
+    virtual bool get_display_shift() const { return display_shift_enabled; }
     virtual void set_dhgr_mono_mode(bool mono) { dhgr_mono_mode = mono; }
     virtual bool get_dhgr_mono_mode() const { return dhgr_mono_mode; }
     virtual void set_mono_mode(bool mono) { mono_mode = mono; }
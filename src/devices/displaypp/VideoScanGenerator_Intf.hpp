@@ -11,8 +11,13 @@ public:
     virtual ~VideoScanGeneratorIntf() = default;
 
     virtual void generate_frame(ScanBuffer *frame_scan) = 0;
+    /** Consume a frame that would draw the same as the last one: keep the flash timer going, draw nothing. */
+    virtual void skip_frame(ScanBuffer *frame_scan) = 0;
+    /** Flash state the next generate_frame will draw with. */
+    virtual bool next_flash_state() const = 0;
 
     virtual void set_display_shift(bool enable) = 0;
+    virtual bool get_display_shift() const = 0;
     virtual void set_dhgr_mono_mode(bool mono) = 0;
     virtual bool get_dhgr_mono_mode() const = 0;
     virtual void set_mono_mode(bool mono) = 0;
@@ -1,3 +1,5 @@
+#include <cstring>
+
 
 #include "Device_ID.hpp"
 #include "AppleIIgsColors.hpp"
@@ -11,6 +13,85 @@
 #include "render/GSRGB_LUT.hpp"
 #include "render/GSRGB560.hpp"
 
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// palette index of each dot a SHR byte draws. 640 mode: 4 dots, each from its own
+// quarter of the palette. 320 mode: 2 pixels, each 2 dots wide.
+struct shr_index_tables_t {
+    uint8_t i640[256][4];
+    uint8_t i320[256][4];
+
+    shr_index_tables_t() {
+        for (int b = 0; b < 256; b++) {
+            uint8_t pval = (uint8_t)b;
+            i640[b][0] = pixel640<3>(pval) + 0x08;
+            i640[b][1] = pixel640<2>(pval) + 0x0C;
+            i640[b][2] = pixel640<1>(pval) + 0x00;
+            i640[b][3] = pixel640<0>(pval) + 0x04;
+            i320[b][0] = i320[b][1] = pixel320<1>(pval);
+            i320[b][2] = i320[b][3] = pixel320<0>(pval);
+        }
+    }
+};
+
+const shr_index_tables_t shr_index;
+
+/**
+ * out[i] = palette[idx[i]] for count dots (a multiple of 16).
+ * planes holds the palette as 4 byte planes so a byte shuffle can look up
+ * 16 dots at once, then the planes are interleaved back into RGBA_t.
+ */
+inline void shr_lookup(const uint8_t (&planes)[4][16], const RGBA_t *palette,
+                       const uint8_t *idx, RGBA_t *out, uint32_t count) {
+#if defined(__SSSE3__)
+    const __m128i p0 = _mm_load_si128((const __m128i *)planes[0]);
+    const __m128i p1 = _mm_load_si128((const __m128i *)planes[1]);
+    const __m128i p2 = _mm_load_si128((const __m128i *)planes[2]);
+    const __m128i p3 = _mm_load_si128((const __m128i *)planes[3]);
+    for (uint32_t x = 0; x < count; x += 16) {
+        __m128i i = _mm_loadu_si128((const __m128i *)(idx + x));
+        __m128i b0 = _mm_shuffle_epi8(p0, i);
+        __m128i b1 = _mm_shuffle_epi8(p1, i);
+        __m128i b2 = _mm_shuffle_epi8(p2, i);
+        __m128i b3 = _mm_shuffle_epi8(p3, i);
+        __m128i lo01 = _mm_unpacklo_epi8(b0, b1), hi01 = _mm_unpackhi_epi8(b0, b1);
+        __m128i lo23 = _mm_unpacklo_epi8(b2, b3), hi23 = _mm_unpackhi_epi8(b2, b3);
+        __m128i *o = (__m128i *)(out + x);
+        _mm_storeu_si128(o + 0, _mm_unpacklo_epi16(lo01, lo23));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo01, lo23));
+        _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi01, hi23));
+        _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi01, hi23));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t p0 = vld1q_u8(planes[0]);
+    const uint8x16_t p1 = vld1q_u8(planes[1]);
+    const uint8x16_t p2 = vld1q_u8(planes[2]);
+    const uint8x16_t p3 = vld1q_u8(planes[3]);
+    for (uint32_t x = 0; x < count; x += 16) {
+        uint8x16_t i = vld1q_u8(idx + x);
+        uint8x16x4_t v;
+        v.val[0] = vqtbl1q_u8(p0, i);
+        v.val[1] = vqtbl1q_u8(p1, i);
+        v.val[2] = vqtbl1q_u8(p2, i);
+        v.val[3] = vqtbl1q_u8(p3, i);
+        vst4q_u8((uint8_t *)(out + x), v);
+    }
+#else
+    (void)planes;
+    for (uint32_t x = 0; x < count; x++) {
+        out[x] = palette[idx[x]];
+    }
+#endif
+}
+
+} // namespace
+
 // Alias to the shared Apple IIgs color table for text rendering
 //static const RGBA_t (&gs_text_palette)[16] = AppleIIgs::TEXT_COLORS;
 
@@ -22,6 +103,8 @@ VideoScanGenerator_RGB::VideoScanGenerator_RGB(CharRom *charrom, bool border_ena
 
     mode = { .p = 0 }; 
     palette = { .colors = {0} };
+    palette_mono = false;
+    convert_palette();
     lastpixel = {0};
 
     hcount = 0;
@@ -65,6 +148,61 @@ void VideoScanGenerator_RGB::build_mono_lut(RGBA_t *ct, RGBA_t *mt) {
     }
 }
 
+void VideoScanGenerator_RGB::convert_palette() {
+    for (int i = 0; i < 16; i++) {
+        RGBA_t c = convert12bitTo24bit(palette.colors[i]);
+        palette.active[i] = palette_mono ? convert24bitColorToMono(c) : c;
+    }
+    shr_planes_dirty = true;
+}
+
+/**
+ * Draw the SHR bytes collected since the last non-SHR scan. Mode and palette
+ * can't change inside the run (those scans come in HBL), so the whole run is
+ * expanded to palette indexes first, then looked up 16 dots at a time.
+ */
+void VideoScanGenerator_RGB::render_shr_run()
+{
+    alignas(16) uint8_t idx[sizeof(shr_run) * 4];
+    uint32_t dots = shr_run_bytes * 4;
+    uint32_t lead = 0; // fill mode: dots before the first non-0 pixel, drawn with the carried-in lastpixel
+    int last = -1;
+
+    if (mode.mode640) {
+        for (uint32_t i = 0; i < shr_run_bytes; i++) {
+            memcpy(idx + i * 4, shr_index.i640[shr_run[i]], 4);
+        }
+    } else if (!mode.fill) {
+        for (uint32_t i = 0; i < shr_run_bytes; i++) {
+            memcpy(idx + i * 4, shr_index.i320[shr_run[i]], 4);
+        }
+        last = idx[dots - 1];
+    } else {
+        // fill mode: a 0 pixel repeats the last non-0 one. Resolve that in index space.
+        for (uint32_t i = 0; i < shr_run_bytes * 2; i++) {
+            uint8_t pixel = (i & 1) ? pixel320<0>(shr_run[i >> 1]) : pixel320<1>(shr_run[i >> 1]);
+            if (pixel != 0) last = pixel;
+            else if (last < 0) lead += 2;
+            idx[i * 2] = idx[i * 2 + 1] = (last < 0) ? 0 : (uint8_t)last;
+        }
+    }
+
+    if (shr_planes_dirty) {
+        for (int i = 0; i < 16; i++) {
+            const uint8_t *c = (const uint8_t *)&palette.active[i];
+            for (int lane = 0; lane < 4; lane++) shr_planes[lane][i] = c[lane];
+        }
+        shr_planes_dirty = false;
+    }
+
+    RGBA_t *out = frame_vsg->reserve(dots);
+    shr_lookup(shr_planes, palette.active, idx, out, dots);
+    for (uint32_t i = 0; i < lead; i++) out[i] = lastpixel;
+    if (last >= 0) lastpixel = palette.active[last];
+
+    shr_run_bytes = 0;
+}
+
 void VideoScanGenerator_RGB::build_hires40Font(bool delayEnabled) 
 {
     for (int i = 0; i < 2 * CHAR_NUM; i++)
@@ -205,8 +343,15 @@ void VideoScanGenerator_RGB::generate_frame(ScanBuffer *frame_scan)
         flash_counter = 0;
     }
 
+    if (palette_mono != mono_mode) {
+        palette_mono = mono_mode;
+        convert_palette();
+    }
+
     while (fcnt--) {
         Scan_t scan = frame_scan->pull();
+        if (shr_run_bytes && scan.mode != VM_SHR) render_shr_run();
+
         if (modeChecks && scan.mode <= VM_DHIRES) {
             color_mode.colorburst = (scan.mode == VM_TEXT40 || scan.mode == VM_TEXT80) ? 0 : 1;
             color_mode.mixed_mode = scan.flags & VS_FL_MIXED ? 1 : 0;
@@ -259,30 +404,11 @@ void VideoScanGenerator_RGB::generate_frame(ScanBuffer *frame_scan)
             case VM_SHR: {
                     sawdata = true;
                     scanner_freq = 16;
-                    uint8_t p_num = mode.p;
+                    if (shr_run_bytes == sizeof(shr_run)) render_shr_run();
                     uint32_t shr_bytes = scan.shr_bytes; // 4 video bytes in 32 bits.
                     for (int x = 0; x < 4; x++) {
-                        uint8_t pval = shr_bytes & 0xFF;
+                        shr_run[shr_run_bytes++] = shr_bytes & 0xFF;
                         shr_bytes >>= 8;
-
-                        if (mode.mode640) { // each byte is 4 pixels
-                            frame_vsg->push(palette.active[pixel640<3>(pval) + 0x8]);                            
-                            frame_vsg->push(palette.active[pixel640<2>(pval) + 0x0C]);            
-                            frame_vsg->push(palette.active[pixel640<1>(pval) + 0x00]);            
-                            frame_vsg->push(palette.active[pixel640<0>(pval) + 0x04]);
-                        } else {
-                            uint16_t pixel = pixel320<1>(pval);
-                            if (!mode.fill || (pixel != 0)) {
-                                lastpixel = palette.active[pixel];
-                            }
-                            frame_vsg->push_n(lastpixel, 2);
-
-                            pixel = pixel320<0>(pval);
-                            if (!mode.fill || (pixel != 0)) {
-                                lastpixel = palette.active[pixel];
-                            }
-                            frame_vsg->push_n(lastpixel, 2);
-                        }
                     }
                 }
                 break;
@@ -292,15 +418,8 @@ void VideoScanGenerator_RGB::generate_frame(ScanBuffer *frame_scan)
                 }
                 break;
             case VM_SHR_PALETTE: { // load the palette values into palette based on index.
-                    palette.colors[palette_index].v = scan.shr_bytes & 0xFFFF;
-                    palette.colors[palette_index+1].v = (scan.shr_bytes >> 16) & 0xFFFF;
-                    if (mono_mode) {
-                        palette.active[palette_index] = convert24bitColorToMono(convert12bitTo24bit(palette.colors[palette_index]));
-                        palette.active[palette_index+1] = convert24bitColorToMono(convert12bitTo24bit(palette.colors[palette_index+1]));
-                    } else {
-                        palette.active[palette_index] = convert12bitTo24bit(palette.colors[palette_index]);
-                        palette.active[palette_index+1] = convert12bitTo24bit(palette.colors[palette_index+1]);
-                    }
+                    set_palette_entry(palette_index, scan.shr_bytes & 0xFFFF);
+                    set_palette_entry(palette_index+1, (scan.shr_bytes >> 16) & 0xFFFF);
                     palette_index = (palette_index + 2) % 16;
                 }
                 break;
@@ -498,5 +617,17 @@ void VideoScanGenerator_RGB::generate_frame(ScanBuffer *frame_scan)
         }
         beam_h++;
     }
+    if (shr_run_bytes) render_shr_run();
 }
 
+void VideoScanGenerator_RGB::skip_frame(ScanBuffer *frame_scan)
+{
+    if (frame_scan->get_count() == 0) return;
+
+    flash_counter++;
+    if (flash_counter > 14) {
+        flash_state = !flash_state;
+        flash_counter = 0;
+    }
+    frame_scan->skip_frame();
+}
@@ -53,6 +53,15 @@ private:
     uint8_t color_delay_mask = 0xFF;
 
     int palette_index = 0; // reset to 0 each scanline.
+    bool palette_mono = false; // mono_mode palette.active was last converted with
+
+    // SHR is drawn a line at a time: VM_SHR bytes collect here and render_shr_run() draws them
+    // as soon as any other scan (border, HSYNC) shows up.
+    uint8_t shr_run[160];
+    uint32_t shr_run_bytes = 0;
+    // palette.active split into byte planes (byte 0..3 of each RGBA_t), for the table-lookup shuffles.
+    alignas(16) uint8_t shr_planes[4][16];
+    bool shr_planes_dirty = true;
     bool modeChecks = true;
 
     //ScanBuffer *frame_scan = nullptr;
@@ -84,6 +93,15 @@ private:
     void emit_hires_pixels(uint16_t shift);
     void render_hires_mono();
     void build_mono_lut(RGBA_t *ct, RGBA_t *mt);
+    void render_shr_run();
+    void convert_palette();
+    inline void set_palette_entry(int index, uint16_t c12) {
+        if (palette.colors[index].v == c12) return; // most lines reload the same palette
+        palette.colors[index].v = c12;
+        RGBA_t c = convert12bitTo24bit(palette.colors[index]);
+        palette.active[index] = palette_mono ? convert24bitColorToMono(c) : c;
+        shr_planes_dirty = true;
+    }
     inline void update_mono_lut() { 
         if (mono_mode) {
             for (int i = 0; i < 16; i++) {
@@ -102,7 +120,10 @@ public:
     VideoScanGenerator_RGB(CharRom *charrom, bool border_enabled = false, FrameVSG *frame_vsg = nullptr);
 
     virtual void generate_frame(ScanBuffer *frame_scan);
+    virtual void skip_frame(ScanBuffer *frame_scan);
+    virtual bool next_flash_state() const { return (flash_counter + 1 > 14) ? !flash_state : flash_state; }
     virtual void set_display_shift(bool enable) { display_shift_enabled = enable; }
+    virtual bool get_display_shift() const { return display_shift_enabled; }
     virtual void set_dhgr_mono_mode(bool mono) { dhgr_mono_mode = mono; }
     virtual bool get_dhgr_mono_mode() const { return dhgr_mono_mode; }
     virtual void set_mono_mode(bool mono) { mono_mode = mono; update_mono_lut();}
@@ -249,9 +249,58 @@ void VideoScannerII::video_cycle()
 
 ScanBuffer *VideoScannerII::get_frame_scan()
 {
+    catch_up();
     return frame_scan;
 }
 
+void VideoScannerII::save_state(SnapshotWriter &w)
+{
+    catch_up();
+    w.put(scan_index);
+    w.put(video_byte);
+    w.put(graf);
+    w.put(hires);
+    w.put(mixed);
+    w.put(page2);
+    w.put(sw80col);
+    w.put(altchrset);
+    w.put(dblres);
+    w.put(f_80store);
+    w.put(text_bg);
+    w.put(text_fg);
+    w.put(border_color);
+    w.put(shr);
+    w.put(current_scb);
+    w.put(h_counter);
+}
+
+bool VideoScannerII::load_state(SnapshotReader &r)
+{
+    pending_cycles = 0;
+    bool ok = r.get(scan_index) && r.get(video_byte)
+        && r.get(graf) && r.get(hires) && r.get(mixed) && r.get(page2)
+        && r.get(sw80col) && r.get(altchrset) && r.get(dblres) && r.get(f_80store)
+        && r.get(text_bg) && r.get(text_fg) && r.get(border_color) && r.get(shr)
+        && r.get(current_scb) && r.get(h_counter);
+    if (!ok || scan_index >= cycles_per_frame) return false;
+    text_color = text_fg << 4 | text_bg;
+    set_video_mode();
+    return true;
+}
+
+static void video_sync_handler(void *context)
+{
+    ((VideoScannerII *)context)->catch_up();
+}
+
+void VideoScannerII::set_lazy(bool fl)
+{
+    catch_up();
+    lazy = fl;
+    if (lazy) mmu->set_video_sync({video_sync_handler, this});
+    else mmu->set_video_sync({nullptr, nullptr});
+}
+
 VideoScannerII::VideoScannerII(MMU_II *mmu)
 {
 
@@ -308,6 +357,7 @@ VideoScannerII::VideoScannerII(MMU_II *mmu)
 }
 
 VideoScannerII::~VideoScannerII() {
+    if (lazy) mmu->set_video_sync({nullptr, nullptr});
     delete frame_scan;
     if (lores_p1 != nullptr) delete[] lores_p1;
     if (lores_p2 != nullptr) delete[] lores_p2;
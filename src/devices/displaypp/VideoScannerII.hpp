@@ -7,6 +7,7 @@
 #include "gs2.hpp"
 #include "ScanBuffer.hpp"
 #include "device_irq_id.hpp"
+#include "util/Snapshot.hpp"
 
 class MMU_II;
 struct display_state_t;
@@ -160,6 +161,14 @@ protected:
     mode_table_t calc_video_mode_x(uint8_t vmode);
     virtual void init_mode_table();
     inline virtual bool supports_dblres() const { return false; }
+    inline virtual bool supports_lazy() const { return true; }
+
+    // lazy scanning: the clock only counts video cycles (tick), and they are
+    // scanned in one go by catch_up() when something is about to observe video
+    // state - a write to video memory, a mode switch, a floating bus read, a
+    // counter read, or the end of the frame.
+    bool lazy = false;
+    uint32_t pending_cycles = 0;
 
     uint8_t current_scb = 0;
     uint16_t h_counter = 0;
@@ -172,21 +181,33 @@ public:
     virtual ~VideoScannerII();
 
     // Call this after construction to properly initialize video addresses
-    virtual void initialize() { init_video_addresses(); }
+    virtual void initialize() { init_video_addresses(); set_lazy(supports_lazy()); }
     virtual void allocate();
 
-    virtual void reset() { frame_scan->clear(); /* hcount = 0; */ scan_index = 0 /* (65*243) */; };
+    virtual void reset() { frame_scan->clear(); /* hcount = 0; */ scan_index = 0 /* (65*243) */; pending_cycles = 0; };
 
     virtual void video_cycle();
-    uint32_t get_scan_cycle() { return scan_index; }
+
+    void set_lazy(bool fl);
+    inline bool is_lazy() { return lazy; }
+    inline void tick() { if (lazy) pending_cycles++; else video_cycle(); }
+    inline void catch_up() {
+        while (pending_cycles) {
+            pending_cycles--;
+            video_cycle();
+        }
+    }
+
+    uint32_t get_scan_cycle() { catch_up(); return scan_index; }
     virtual void init_video_addresses();
 
-    inline bool is_hbl()     { return (scan_index % 65) < 25;   }
-    inline bool is_vbl()     { return scan_index >= (192*65); }
-    inline uint16_t get_vcount() { return scan_index / 65; }
-    inline uint16_t get_hcount() { return scan_index % 65; }
+    inline bool is_hbl()     { catch_up(); return (scan_index % 65) < 25;   }
+    inline bool is_vbl()     { catch_up(); return scan_index >= (192*65); }
+    inline uint16_t get_vcount() { catch_up(); return scan_index / 65; }
+    inline uint16_t get_hcount() { catch_up(); return scan_index % 65; }
 
     inline uint16_t get_hcounter() {
+        catch_up();
         uint16_t hcounter;
         uint16_t horz = (scan_index % 65);
         if (horz == 0) hcounter = 0;
@@ -194,6 +215,7 @@ public:
         return hcounter;
     }
     inline uint16_t get_vcounter() { 
+        catch_up();
         uint16_t vcounter;
         uint16_t vert = scan_index / 65;
         if (vert < 192) vcounter = 0x100 + vert;
@@ -203,16 +225,16 @@ public:
     }
 
     virtual void set_video_mode();
-    inline void set_page_1() { page2 = false; set_video_mode(); }
-    inline void set_page_2() { page2 = true;  set_video_mode(); }
-    inline void set_full()   { mixed = false; set_video_mode(); }
-    inline void set_mixed()  { mixed = true;  set_video_mode(); }
-    inline void set_lores()  { hires = false; set_video_mode(); }
-    inline void set_hires()  { hires = true;  set_video_mode(); }
-    inline void set_text()   { graf  = false; set_video_mode(); }
-    inline void set_graf()   { graf  = true;  set_video_mode(); }
-    inline void set_80store(bool fl) { f_80store = fl; set_video_mode(); }
-    inline void set_shr() { shr = true; set_video_mode(); }
+    inline void set_page_1() { catch_up(); page2 = false; set_video_mode(); }
+    inline void set_page_2() { catch_up(); page2 = true;  set_video_mode(); }
+    inline void set_full()   { catch_up(); mixed = false; set_video_mode(); }
+    inline void set_mixed()  { catch_up(); mixed = true;  set_video_mode(); }
+    inline void set_lores()  { catch_up(); hires = false; set_video_mode(); }
+    inline void set_hires()  { catch_up(); hires = true;  set_video_mode(); }
+    inline void set_text()   { catch_up(); graf  = false; set_video_mode(); }
+    inline void set_graf()   { catch_up(); graf  = true;  set_video_mode(); }
+    inline void set_80store(bool fl) { catch_up(); f_80store = fl; set_video_mode(); }
+    inline void set_shr() { catch_up(); shr = true; set_video_mode(); }
 
     inline bool is_page_1() { return !page2; }
     inline bool is_page_2() { return  page2; }
@@ -227,25 +249,29 @@ public:
     inline bool is_altchrset()    { return altchrset; }
     inline bool is_dblres()       { return dblres; }
 
-    inline void set_80col()       { sw80col   = true;  set_video_mode(); }
-    inline void set_altchrset()   { altchrset = true;  set_video_mode(); }
-    inline void set_dblres()      { dblres    = true;  set_video_mode(); }
-    inline void set_dblres_f(bool fl) { dblres    = fl;  set_video_mode(); }
-    inline void set_80col_f(bool fl) { sw80col   = fl;  set_video_mode(); }
-    inline void set_altchrset_f(bool fl) { altchrset = fl;  set_video_mode(); }
+    inline void set_80col()       { catch_up(); sw80col   = true;  set_video_mode(); }
+    inline void set_altchrset()   { catch_up(); altchrset = true;  set_video_mode(); }
+    inline void set_dblres()      { catch_up(); dblres    = true;  set_video_mode(); }
+    inline void set_dblres_f(bool fl) { catch_up(); dblres    = fl;  set_video_mode(); }
+    inline void set_80col_f(bool fl) { catch_up(); sw80col   = fl;  set_video_mode(); }
+    inline void set_altchrset_f(bool fl) { catch_up(); altchrset = fl;  set_video_mode(); }
 
-    inline void reset_80col()     { sw80col   = false; set_video_mode(); }
-    inline void reset_altchrset() { altchrset = false; set_video_mode(); }
-    inline void reset_dblres()    { dblres    = false; set_video_mode(); }
-    inline void reset_shr()       { shr       = false; set_video_mode(); }
+    inline void reset_80col()     { catch_up(); sw80col   = false; set_video_mode(); }
+    inline void reset_altchrset() { catch_up(); altchrset = false; set_video_mode(); }
+    inline void reset_dblres()    { catch_up(); dblres    = false; set_video_mode(); }
+    inline void reset_shr()       { catch_up(); shr       = false; set_video_mode(); }
 
-    inline void set_text_bg(uint16_t bg) { text_bg = bg; text_color = text_fg << 4 | text_bg; }
-    inline void set_text_fg(uint16_t fg) { text_fg = fg; text_color = text_fg << 4 | text_bg; }
-    inline void set_border_color(uint16_t color) { border_color = color; }
+    inline void set_text_bg(uint16_t bg) { catch_up(); text_bg = bg; text_color = text_fg << 4 | text_bg; }
+    inline void set_text_fg(uint16_t fg) { catch_up(); text_fg = fg; text_color = text_fg << 4 | text_bg; }
+    inline void set_border_color(uint16_t color) { catch_up(); border_color = color; }
 
     inline virtual void set_irq_handler(device_irq_handler_s irq_handler) { this->irq_handler = irq_handler; }
 
     ScanBuffer *get_frame_scan();
+
+    /** Beam position and mode switches. The frame being scanned is not saved. */
+    virtual void save_state(SnapshotWriter &w);
+    virtual bool load_state(SnapshotReader &r);
 };
 
 void init_mb_video_scanner(computer_t *computer, SlotType_t slot);
@@ -114,6 +114,17 @@ void VideoScannerIIgs::init_video_addresses()
     /* dump_cycles(); */
 }
 
+void VideoScannerIIgs::save_state(SnapshotWriter &w)
+{
+    VideoScannerII::save_state(w);
+    w.put(palette_index);
+}
+
+bool VideoScannerIIgs::load_state(SnapshotReader &r)
+{
+    return VideoScannerII::load_state(r) && r.get(palette_index);
+}
+
 void VideoScannerIIgs::dump_cycles()
 {
     FILE *f = fopen("bordercycles.txt", "w");
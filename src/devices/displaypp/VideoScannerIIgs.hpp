@@ -6,6 +6,7 @@ class VideoScannerIIgs : public VideoScannerII
 {
 protected:
     inline virtual bool supports_dblres() const override { return true; }
+    inline virtual bool supports_lazy() const override { return false; } // raises scanline / VBL interrupts from video_cycle.
     uint8_t palette_index = 0;
 public:
     VideoScannerIIgs(MMU_II *mmu);
@@ -13,6 +14,8 @@ public:
     virtual void video_cycle() override;
     virtual void init_video_addresses() override;
     virtual void dump_cycles() ;
+    virtual void save_state(SnapshotWriter &w) override;
+    virtual bool load_state(SnapshotReader &r) override;
 };
 
 //void init_mb_video_scanner_iie(computer_t *computer, SlotType_t slot);
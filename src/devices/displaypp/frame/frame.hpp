@@ -115,6 +115,10 @@ public:
         return stream[0];
     }
 
+    inline bs_t *line_data(int line) {
+        return stream[line];
+    }
+
     inline void advance(int count = 1) noexcept {
         hloc += count;
     }
@@ -131,6 +135,13 @@ public:
         hloc += count;
     }
 
+    /** Claim the next count pixels of the line for the caller to fill in directly. */
+    inline bs_t *reserve(int count) noexcept {
+        bs_t *p = row + hloc;
+        hloc += count;
+        return p;
+    }
+
     inline bs_t pull() noexcept { 
         //return stream[scanline][hloc++];
         return row[hloc++];
@@ -169,6 +180,12 @@ public:
         }
     }
 
+    /** Draw into caller memory (pitch WIDTH) instead of the locked texture. Don't open()/close() around it. */
+    inline void attach(bs_t *pixels) {
+        stream = reinterpret_cast<bs_t(*)[WIDTH]>(pixels);
+        set_line_v(scanline);
+    }
+
     inline SDL_Texture* get_texture() { return texture; }
 
     inline void set_color_mode(uint32_t line, color_mode_t mode) {
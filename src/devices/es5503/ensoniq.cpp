@@ -4,6 +4,12 @@
 #include <cstring>
 #include <cassert>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "devices/speaker/speaker.hpp"
 #include "util/DebugHandlerIDs.hpp"
 #include "device_irq_id.hpp"
@@ -37,15 +43,10 @@ ES5503::~ES5503() {
 void ES5503::init(uint32_t clock_rate, uint32_t sample_rate, int output_channels) {
     m_clock_rate = clock_rate;
     m_sample_rate = sample_rate;
+    // Channel decode masks CA0 with (channels - 1), so only mono and stereo work.
+    assert(output_channels == 1 || output_channels == MAX_OUTPUT_CHANNELS);
     m_output_channels = output_channels;
     
-    // Calculate actual ES5503 output rate
-    uint32_t es5503_output_rate = calculate_output_rate();
-    
-    // Allocate mix buffer for audio generation
-    // Size needs to handle maximum samples per call
-    m_mix_buffer.resize((es5503_output_rate / 50) * output_channels * 8);
-    
     // Update SDL stream rate if stream is set
     if (m_sdl_stream) {
         update_sdl_stream_rate();
@@ -87,6 +88,22 @@ uint8_t ES5503::read_wave_byte(uint32_t address) {
     return 0;
 }
 
+void ES5503::save_state(SnapshotWriter &w) {
+    w.put(m_oscsenabled);
+    w.put(m_channel_strobe);
+    w.put(m_rege0);
+    w.put(m_rege1);
+    w.put(m_oscillators);
+}
+
+bool ES5503::load_state(SnapshotReader &r) {
+    bool ok = r.get(m_oscsenabled) && r.get(m_channel_strobe) && r.get(m_rege0)
+        && r.get(m_rege1) && r.get(m_oscillators);
+    if (!ok || m_oscsenabled < 0 || m_oscsenabled > 31) return false;
+    update_sdl_stream_rate();
+    return true;
+}
+
 void ES5503::update_sdl_stream_rate() {
     // SDL stream is fixed at the host device rate. DOC output rate changes only
     // affect Sound GLU's per-frame resampler — do not call SDL_SetAudioStreamFormat
@@ -148,6 +165,245 @@ void ES5503::halt_osc(int onum, int type, uint32_t *accumulator, int resshift, u
     }
 }
 
+/**
+ * generate_samples() keeps the per-oscillator values it touches every sample
+ * here, one array per field, so a group of oscillators can be stepped with
+ * vector ops. m_oscillators stays the real state: this is loaded at the start
+ * of a block, written back at the end, and reloaded around halt_osc(), which
+ * may change the partner's control and accumulator.
+ * Halted and disabled oscillators have run = 0, freq = 0 and gain = 0.
+ */
+struct ES5503::OscLanes {
+    static constexpr int WIDTH = 8;     // oscillators per step_group()
+
+    alignas(32) uint32_t acc[32];
+    alignas(32) uint32_t freq[32];
+    alignas(32) uint32_t wtptr[32];     // wavetblpointer & wavemask
+    alignas(32) uint32_t resshift[32];
+    alignas(32) uint32_t sizemask[32];
+    alignas(32) uint32_t wtsize_m1[32];
+    alignas(32) int32_t  gain[32];      // vol, x3 for the highest enabled oscillator
+    alignas(32) int32_t  chan[32];      // mix slot, 0 or 1
+    alignas(32) uint32_t run[32];       // ~0 if running
+    alignas(32) uint32_t data[32];      // last wave byte read
+    uint32_t live = 0;                  // bit n: oscillator n is running
+    bool scalar[32 / WIDTH];            // group has a sync/AM voice, step it one oscillator at a time
+};
+
+void ES5503::load_lane(OscLanes &L, int osc) {
+    Oscillator *pOsc = &m_oscillators[osc];
+    const bool running = (osc < m_oscsenabled) && !(pOsc->control & 1);
+
+    // Channel select is control[7:4] (CA0–CA3). With 2 host outputs we
+    // decode CA0 only. Apple TN #19 stereo cards: odd → left, even → right
+    // (interleaved [L,R]), so flip CA0 when mapping to the mix index.
+    int assigned = (pOsc->control >> 4) & (m_output_channels - 1);
+    if (m_output_channels == 2) {
+        assigned ^= 1;
+    }
+
+    L.acc[osc] = pOsc->accumulator;
+    L.freq[osc] = running ? pOsc->freq : 0;
+    L.wtptr[osc] = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize];
+    L.resshift[osc] = resshifts[pOsc->resolution] - pOsc->wavetblsize;
+    L.sizemask[osc] = accmasks[pOsc->wavetblsize];
+    L.wtsize_m1[osc] = (uint16_t)(pOsc->wtsize - 1);
+    L.gain[osc] = running ? pOsc->vol * ((osc == m_oscsenabled - 1) ? 3 : 1) : 0;
+    L.chan[osc] = assigned;
+    L.run[osc] = running ? ~0u : 0;
+    L.live = running ? (L.live | (1u << osc)) : (L.live & ~(1u << osc));
+}
+
+void ES5503::load_scalar_flags(OscLanes &L) {
+    for (int g = 0; g < 32 / OscLanes::WIDTH; g++) {
+        L.scalar[g] = false;
+    }
+    for (int osc = 0; osc < m_oscsenabled; osc++) {
+        const uint8_t control = m_oscillators[osc].control;
+        // an odd sync/AM voice rewrites the next voice's volume every sample.
+        if (!(control & 1) && ((control >> 1) & 3) == MODE_SYNCAM) {
+            L.scalar[osc / OscLanes::WIDTH] = true;
+            if ((osc & 1) && osc < 31) {
+                L.scalar[(osc + 1) / OscLanes::WIDTH] = true;
+            }
+        }
+    }
+}
+
+/** One sample of one oscillator, with halt / swap / sync / IRQ handling. Adds into mix[chan]. */
+void ES5503::step_osc(int osc, OscLanes &L, int32_t *mix) {
+    Oscillator *pOsc = &m_oscillators[osc];
+    if (pOsc->control & 1) {
+        return;
+    }
+    const int resshift = L.resshift[osc];
+    const int mode = (pOsc->control >> 1) & 3;
+
+    uint32_t altram = L.acc[osc] >> resshift;
+    uint32_t ramptr = altram & L.sizemask[osc];
+
+    L.acc[osc] += pOsc->freq;
+
+    // Set channel strobe for banking
+    m_channel_strobe = (pOsc->control >> 4) & 0xf;
+    uint8_t byte = read_wave_byte(ramptr + L.wtptr[osc]);
+    L.data[osc] = byte;
+
+    bool halt = false;
+    if (byte == 0x00) {
+        halt = true;
+    } else {
+        int32_t data = (int8_t)(byte ^ 0x80);
+        int32_t vol = pOsc->vol;
+        int32_t *mixp = &mix[L.chan[osc]];
+        if (mode != MODE_SYNCAM || !(osc & 1)) {
+            *mixp += data * vol;
+            // Volume glitch for highest enabled oscillator
+            if (osc == (m_oscsenabled - 1)) {
+                *mixp += data * vol;
+                *mixp += data * vol;
+            }
+        } else if (osc < 31) {
+            // Sync/AM mode: odd oscillator modulates the next one up
+            if (!(m_oscillators[osc + 1].control & 1)) {
+                m_oscillators[osc + 1].vol = byte;
+            }
+        }
+        // MAME: wrap/halt when pre-increment position reaches end
+        halt = (altram >= L.wtsize_m1[osc]);
+    }
+
+    if (halt) {
+        // halt_osc() can also restart the partner (swap) or the voice below (sync).
+        const int partner = osc ^ 1;
+        const int below = (osc > 0) ? osc - 1 : partner;
+        m_oscillators[partner].accumulator = L.acc[partner];
+        m_oscillators[below].accumulator = L.acc[below];
+        const bool syncam = (mode == MODE_SYNCAM) || (((m_oscillators[partner].control >> 1) & 3) == MODE_SYNCAM);
+
+        halt_osc(osc, (byte == 0x00) ? 1 : 0, &L.acc[osc], resshift, pOsc->control);
+
+        uint32_t acc = L.acc[osc];
+        load_lane(L, osc);
+        L.acc[osc] = acc;
+        load_lane(L, partner);
+        load_lane(L, below);
+        if (syncam) {
+            load_scalar_flags(L);
+        }
+    }
+}
+
+/**
+ * One sample of oscillators first..first+7, all at once. Returns false without
+ * changing anything if one of them would halt or wrap, or the group has a
+ * sync/AM voice; the caller then uses step_osc() for each. Without AVX2 or
+ * NEON there is no gather, so it steps them one by one and never returns false.
+ */
+bool ES5503::step_group(int first, OscLanes &L, int32_t *mix) {
+    if (L.scalar[first / OscLanes::WIDTH]) {
+        return false;
+    }
+#if defined(__AVX2__)
+    const __m256i acc = _mm256_load_si256((const __m256i *)(L.acc + first));
+    const __m256i run = _mm256_load_si256((const __m256i *)(L.run + first));
+    const __m256i altram = _mm256_srlv_epi32(acc, _mm256_load_si256((const __m256i *)(L.resshift + first)));
+    __m256i addr = _mm256_add_epi32(_mm256_and_si256(altram, _mm256_load_si256((const __m256i *)(L.sizemask + first))),
+                                    _mm256_load_si256((const __m256i *)(L.wtptr + first)));
+    addr = _mm256_and_si256(addr, _mm256_set1_epi32(0xFFFF));
+
+    // gather the aligned dword holding each byte (never reads past 64K), then shift the byte down.
+    const __m256i words = _mm256_i32gather_epi32((const int *)m_wave_memory,
+                                                 _mm256_andnot_si256(_mm256_set1_epi32(3), addr), 1);
+    const __m256i bytes = _mm256_and_si256(
+        _mm256_srlv_epi32(words, _mm256_slli_epi32(_mm256_and_si256(addr, _mm256_set1_epi32(3)), 3)),
+        _mm256_set1_epi32(0xFF));
+
+    const __m256i zero = _mm256_cmpeq_epi32(bytes, _mm256_setzero_si256());
+    const __m256i before_end = _mm256_cmpgt_epi32(_mm256_load_si256((const __m256i *)(L.wtsize_m1 + first)), altram);
+    const __m256i edge = _mm256_and_si256(run, _mm256_or_si256(zero, _mm256_andnot_si256(before_end, _mm256_set1_epi32(-1))));
+    if (!_mm256_testz_si256(edge, edge)) {
+        return false;
+    }
+
+    _mm256_store_si256((__m256i *)(L.acc + first),
+                       _mm256_add_epi32(acc, _mm256_load_si256((const __m256i *)(L.freq + first))));
+    _mm256_store_si256((__m256i *)(L.data + first),
+                       _mm256_blendv_epi8(_mm256_load_si256((const __m256i *)(L.data + first)), bytes, run));
+
+    const __m256i prod = _mm256_mullo_epi32(_mm256_sub_epi32(bytes, _mm256_set1_epi32(0x80)),
+                                            _mm256_load_si256((const __m256i *)(L.gain + first)));
+    const __m256i right = _mm256_cmpeq_epi32(_mm256_load_si256((const __m256i *)(L.chan + first)), _mm256_set1_epi32(1));
+    const __m256i p1 = _mm256_and_si256(prod, right);
+    __m256i sums = _mm256_hadd_epi32(_mm256_sub_epi32(prod, p1), p1);    // [c0 c0 c1 c1 | c0 c0 c1 c1]
+    sums = _mm256_hadd_epi32(sums, sums);                                  // [c0 c1 c0 c1 | c0 c1 c0 c1]
+    const __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    mix[0] += _mm_cvtsi128_si32(s);
+    mix[1] += _mm_extract_epi32(s, 1);
+    return true;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint32x4_t edge_any = vdupq_n_u32(0);
+    uint32x4_t acc[2], altram[2], bytes[2];
+    for (int h = 0; h < 2; h++) {
+        const int o = first + h * 4;
+        acc[h] = vld1q_u32(L.acc + o);
+        altram[h] = vshlq_u32(acc[h], vnegq_s32(vreinterpretq_s32_u32(vld1q_u32(L.resshift + o))));
+        uint32x4_t addr = vaddq_u32(vandq_u32(altram[h], vld1q_u32(L.sizemask + o)), vld1q_u32(L.wtptr + o));
+        addr = vandq_u32(addr, vdupq_n_u32(0xFFFF));
+        uint32_t a[4], b[4];
+        vst1q_u32(a, addr);
+        for (int i = 0; i < 4; i++) {
+            b[i] = m_wave_memory[a[i]];
+        }
+        bytes[h] = vld1q_u32(b);
+        const uint32x4_t edge = vandq_u32(vld1q_u32(L.run + o),
+                                          vorrq_u32(vceqzq_u32(bytes[h]), vcgeq_u32(altram[h], vld1q_u32(L.wtsize_m1 + o))));
+        edge_any = vorrq_u32(edge_any, edge);
+    }
+    if (vmaxvq_u32(edge_any) != 0) {
+        return false;
+    }
+
+    for (int h = 0; h < 2; h++) {
+        const int o = first + h * 4;
+        const uint32x4_t run = vld1q_u32(L.run + o);
+        vst1q_u32(L.acc + o, vaddq_u32(acc[h], vld1q_u32(L.freq + o)));
+        vst1q_u32(L.data + o, vbslq_u32(run, bytes[h], vld1q_u32(L.data + o)));
+
+        const int32x4_t prod = vmulq_s32(vsubq_s32(vreinterpretq_s32_u32(bytes[h]), vdupq_n_s32(0x80)), vld1q_s32(L.gain + o));
+        const int32x4_t chan = vld1q_s32(L.chan + o);
+        const int32x4_t p1 = vmulq_s32(prod, chan);
+        mix[0] += vaddvq_s32(vsubq_s32(prod, p1));
+        mix[1] += vaddvq_s32(p1);
+    }
+    return true;
+#else
+    // no gathers: walk the running oscillators in order, handing edges to step_osc() in place.
+    const int last = std::min(first + OscLanes::WIDTH, m_oscsenabled);
+    for (int o = first; o < last; o++) {
+        if (!L.run[o]) {
+            continue;
+        }
+        const uint32_t altram = L.acc[o] >> L.resshift[o];
+        const uint32_t byte = m_wave_memory[((altram & L.sizemask[o]) + L.wtptr[o]) & 0xFFFF];
+        if (byte == 0 || altram >= L.wtsize_m1[o]) {
+            step_osc(o, L, mix);
+            continue;
+        }
+        L.acc[o] += L.freq[o];
+        L.data[o] = byte;
+        mix[L.chan[o]] += ((int32_t)byte - 0x80) * L.gain[o];
+    }
+    return true;
+#endif
+}
+
+/**
+ * Sample-major, like the chip: every enabled oscillator advances one step per
+ * output sample, in oscillator order. Groups of 8 go through step_group(); a
+ * group that has a halt, wrap or sync/AM voice this sample falls back to
+ * step_osc() for each of its oscillators.
+ */
 void ES5503::generate_samples(int16_t *buffer, int num_samples) {
     if (!m_wave_memory) {
         // No wave memory, output silence
@@ -155,107 +411,37 @@ void ES5503::generate_samples(int16_t *buffer, int num_samples) {
         return;
     }
 
-    // Clear mix buffer
-    std::fill_n(&m_mix_buffer[0], num_samples * m_output_channels, 0);
-
-    // Generate samples for each channel
-    for (int chan = 0; chan < m_output_channels; chan++) {
-        for (int osc = 0; osc < m_oscsenabled; osc++) {
-            Oscillator *pOsc = &m_oscillators[osc];
+    OscLanes L;
+    for (int osc = 0; osc < 32; osc++) {
+        load_lane(L, osc);
+        L.data[osc] = m_oscillators[osc].data;
+    }
+    load_scalar_flags(L);
 
-            // Channel select is control[7:4] (CA0–CA3). With 2 host outputs we
-            // decode CA0 only. Apple TN #19 stereo cards: odd → left, even → right
-            // (interleaved [L,R]), so flip CA0 when mapping to the mix index.
-            int assigned = (pOsc->control >> 4) & (m_output_channels - 1);
-            if (m_output_channels == 2) {
-                assigned ^= 1;
+    for (int snum = 0; snum < num_samples; snum++) {
+        int32_t mix[MAX_OUTPUT_CHANNELS] = {};
+        for (int first = 0; first < m_oscsenabled; first += OscLanes::WIDTH) {
+            if (!((L.live >> first) & 0xFF)) {
+                continue;
             }
-            if (!(pOsc->control & 1) && assigned == chan) {
-                uint32_t wtptr = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize];
-                uint32_t acc = pOsc->accumulator;
-                const uint16_t wtsize = pOsc->wtsize - 1;
-                uint8_t ctrl = pOsc->control;
-                const uint16_t freq = pOsc->freq;
-                int16_t vol = pOsc->vol;
-                int8_t data = -128;
-                const int resshift = resshifts[pOsc->resolution] - pOsc->wavetblsize;
-                const uint32_t sizemask = accmasks[pOsc->wavetblsize];
-                const int mode = (pOsc->control >> 1) & 3;
-                int32_t *mixp = &m_mix_buffer[0] + chan;
-
-                for (int snum = 0; snum < num_samples; snum++) {
-                    uint32_t altram = acc >> resshift;
-                    uint32_t ramptr = altram & sizemask;
-
-                    acc += freq;
-
-                    // Set channel strobe for banking
-                    m_channel_strobe = (ctrl >> 4) & 0xf;
-                    data = (int32_t)read_wave_byte(ramptr + wtptr) ^ 0x80;
-
-                    if (read_wave_byte(ramptr + wtptr) == 0x00) {
-                        halt_osc(osc, 1, &acc, resshift, pOsc->control);
-                        // Update ctrl from pOsc->control since halt_osc may have modified it
-                        ctrl = pOsc->control;
-                    } else {
-                        if (mode != MODE_SYNCAM) {
-                            *mixp += data * vol;
-                            // Volume glitch for highest enabled oscillator
-                            if (osc == (m_oscsenabled - 1)) {
-                                *mixp += data * vol;
-                                *mixp += data * vol;
-                            }
-                        } else {
-                            // Sync/AM mode
-                            if (osc & 1) {
-                                // Odd oscillator modulates the next one up
-                                if (osc < 31) {
-                                    if (!(m_oscillators[osc + 1].control & 1)) {
-                                        m_oscillators[osc + 1].vol = data ^ 0x80;
-                                    }
-                                }
-                            } else {
-                                // Even oscillator plays normally
-                                *mixp += data * vol;
-                                if (osc == (m_oscsenabled - 1)) {
-                                    *mixp += data * vol;
-                                    *mixp += data * vol;
-                                }
-                            }
-                        }
-                        mixp += m_output_channels;
-
-                        // MAME: wrap/halt when pre-increment position reaches end
-                        // (wtsize here is already pOsc->wtsize - 1).
-                        if (altram >= wtsize) {
-                            halt_osc(osc, 0, &acc, resshift, pOsc->control);
-                            // Update ctrl from pOsc->control since halt_osc may have modified it
-                            ctrl = pOsc->control;
-                        }
-                    }
-
-                    // If oscillator halted, no more samples to generate
-                    // Check pOsc->control directly to ensure we see the latest state
-                    if (pOsc->control & 1) {
-                        ctrl = pOsc->control;
-                        break;
-                    }
+            if (!step_group(first, L, mix)) {
+                const int last = std::min(first + OscLanes::WIDTH, m_oscsenabled);
+                for (int osc = first; osc < last; osc++) {
+                    step_osc(osc, L, mix);
                 }
-
-                pOsc->control = ctrl;
-                pOsc->accumulator = acc;
-                pOsc->data = data ^ 0x80;
             }
         }
+        for (int chan = 0; chan < m_output_channels; chan++) {
+            int32_t sample = mix[chan] / 8;  // Scale down
+            if (sample > 32767) sample = 32767;
+            if (sample < -32768) sample = -32768;
+            *buffer++ = (int16_t)sample;
+        }
     }
 
-    // Convert mix buffer to output buffer
-    int32_t *mixp = &m_mix_buffer[0];
-    for (int i = 0; i < num_samples * m_output_channels; i++) {
-        int32_t sample = *mixp++ / 8;  // Scale down
-        if (sample > 32767) sample = 32767;
-        if (sample < -32768) sample = -32768;
-        buffer[i] = (int16_t)sample;
+    for (int osc = 0; osc < 32; osc++) {
+        m_oscillators[osc].accumulator = L.acc[osc];
+        m_oscillators[osc].data = (uint8_t)L.data[osc];
     }
 }
 
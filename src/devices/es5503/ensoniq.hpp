@@ -4,6 +4,7 @@
 #include <vector>
 #include <functional>
 #include "gs2.hpp"
+#include "util/Snapshot.hpp"
 #include <SDL3/SDL_audio.h>
 
 // Forward declarations
@@ -61,6 +62,10 @@ public:
         return (m_clock_rate / 8) / (m_oscsenabled + 2);
     }
 
+    // Registers and oscillator state, for snapshots. Wave memory is the caller's.
+    void save_state(SnapshotWriter &w);
+    bool load_state(SnapshotReader &r);
+
     // Oscillator modes
     enum {
         MODE_FREE = 0,
@@ -74,6 +79,7 @@ public:
     int m_oscsenabled;          // Number of oscillators enabled
     uint8_t m_channel_strobe;   // Current channel strobe
     int m_output_channels;      // Number of output channels (1=mono, 2=stereo)
+    static constexpr int MAX_OUTPUT_CHANNELS = 2;  // mix accumulators and the SIMD lane sums are sized for this
     uint32_t m_clock_rate;      // Input clock rate
     uint32_t m_sample_rate;     // Output sample rate
     
@@ -91,13 +97,18 @@ public:
     uint8_t *m_wave_memory;     // Pointer to wave memory (64KB DOC RAM)
     SDL_AudioStream *m_sdl_stream;  // SDL AudioStream for rate updates
     
-    std::vector<int32_t> m_mix_buffer;
-    
     std::function<void(bool)> m_irq_callback;
     std::function<uint8_t()> m_adc_callback;
     
+    // Per-block oscillator state, structure-of-arrays (defined in ensoniq.cpp)
+    struct OscLanes;
+
     // Helper methods
     void halt_osc(int onum, int type, uint32_t *accumulator, int resshift, uint8_t newCtrl);
+    void load_lane(OscLanes &L, int osc);
+    void load_scalar_flags(OscLanes &L);
+    void step_osc(int osc, OscLanes &L, int32_t *mix);
+    bool step_group(int first, OscLanes &L, int32_t *mix);
     uint8_t read_wave_byte(uint32_t address);
     void update_sdl_stream_rate();
     int update_irq_status();
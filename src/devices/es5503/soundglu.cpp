@@ -576,6 +576,32 @@ void init_ensoniq_slot(computer_t *computer, SlotType_t slot) {
             return pack_ensoniq_state(st, reply, err);
         });
 
+    computer->register_snapshot_handler(snapshot_tag("DOC "), 1,
+        [st](SnapshotWriter &w) {
+            ensoniq_catch_up(st, st->clock->get_c14m());
+            st->chip->save_state(w);
+            w.put(st->soundctl);
+            w.put(st->sounddata);
+            w.put(st->soundadrl);
+            w.put(st->soundadrh);
+            w.put(st->doc_read_complete_time);
+            w.put(st->doc_read_latched_addr);
+            w.put(st->vol_smooth);
+            w.put_memory(st->doc_ram, 0x10000);
+        },
+        [st](SnapshotReader &r, std::string &err) {
+            bool ok = st->chip->load_state(r)
+                && r.get(st->soundctl) && r.get(st->sounddata) && r.get(st->soundadrl) && r.get(st->soundadrh)
+                && r.get(st->doc_read_complete_time) && r.get(st->doc_read_latched_addr)
+                && r.get(st->vol_smooth) && r.get_memory(st->doc_ram, 0x10000);
+            if (!ok) return false;
+            // samples resume from the restored clock; drop what was staged for the old timeline.
+            st->last_catchup_c14m = st->clock->get_c14m();
+            st->c14m_accum = 0;
+            st->sdl_staging_count = 0;
+            return true;
+        });
+
     computer->register_reset_handler([st](bool cold_start) {
         // this caused the audio to get badly delayed / out of sync. added calculate_output_rate() to reset() to fix.
         st->chip->reset();
@@ -113,6 +113,38 @@ void Floppy35_woz::set_phase(uint8_t phase, uint8_t onoff) {
     refresh_sense();
 }
 
+void Floppy35_woz::save_state(SnapshotWriter &w) {
+    Floppy_woz::save_state(w);
+    w.put(ca0);
+    w.put(ca1);
+    w.put(ca2);
+    w.put(hdsel);
+    w.put(lstrb);
+    w.put(track_num);
+    w.put(side);
+    w.put(step_dir);
+    w.put(motor_on);
+    w.put(disk_in_place);
+    w.put(disk_switched);
+    w.put(sense_out);
+    w.put(ready_cycles_end);
+    w.put(disk_ready);
+    w.put(stepping_cycles_end);
+    w.put(disk_stepping);
+}
+
+bool Floppy35_woz::load_state(SnapshotReader &r, std::string &err) {
+    if (!Floppy_woz::load_state(r, err)) return false;
+    bool ok = r.get(ca0) && r.get(ca1) && r.get(ca2) && r.get(hdsel) && r.get(lstrb)
+        && r.get(track_num) && r.get(side) && r.get(step_dir) && r.get(motor_on)
+        && r.get(disk_in_place) && r.get(disk_switched) && r.get(sense_out)
+        && r.get(ready_cycles_end) && r.get(disk_ready)
+        && r.get(stepping_cycles_end) && r.get(disk_stepping);
+    if (!ok || track_num < 0 || track_num > 79 || side < 0 || side > 1) return false;
+    reload_track_ptr();
+    return true;
+}
+
 void Floppy35_woz::motor_off_callback(uint64_t cycles, void *userData) {
     Floppy35_woz *floppy = static_cast<Floppy35_woz *>(userData);
     floppy->motor_on = false;
@@ -113,6 +113,7 @@ public:
     Floppy35_woz(SoundEffect *sound_effect, NClockII *clock, EventTimer *event_timer, uint16_t drive_index)
         : Floppy_woz(sound_effect, clock, event_timer) {
             instanceID = 0xABAC0000 + drive_index;
+            if (event_timer) event_timer->registerCallback(instanceID, motor_off_callback, this);
             //dbglog = fopen("3.5_woz.dbg", "w");
         }
         ~Floppy35_woz() {
@@ -187,6 +188,9 @@ public:
     virtual bool unmount(uint64_t key) override;
     virtual drive_status_t status() override;
 
+    void save_state(SnapshotWriter &w) override;
+    bool load_state(SnapshotReader &r, std::string &err) override;
+
     static constexpr const char *statusNames[16] = {
         "stepDirection",
         "diskInPlace",
@@ -160,6 +160,23 @@ void Floppy525_woz::update_track() {
     }
 }
 
+void Floppy525_woz::save_state(SnapshotWriter &w) {
+    Floppy_woz::save_state(w);
+    w.put(phase0);
+    w.put(phase1);
+    w.put(phase2);
+    w.put(phase3);
+    w.put(track);
+}
+
+bool Floppy525_woz::load_state(SnapshotReader &r, std::string &err) {
+    if (!Floppy_woz::load_state(r, err)) return false;
+    if (!(r.get(phase0) && r.get(phase1) && r.get(phase2) && r.get(phase3) && r.get(track))) return false;
+    if (track < 0 || track > max_tracks) return false;
+    reload_track_ptr();
+    return true;
+}
+
 void Floppy525_woz::phase_change_callback(uint64_t instanceID, void *userData) {
     (void)instanceID;
     Floppy525_woz *floppy = static_cast<Floppy525_woz *>(userData);
@@ -59,6 +59,7 @@ public:
                   uint16_t slot, uint16_t drive)
         : Floppy_woz(sound_effect, clock, event_timer) {
             instanceID = 0xABAB0000ull | (static_cast<uint64_t>(slot) << 8) | drive;
+            if (event_timer) event_timer->registerCallback(instanceID, phase_change_callback, this);
         }
 
     bool mount(uint64_t key, media_descriptor *media) override;
@@ -68,6 +69,9 @@ public:
 
     virtual void set_phase(uint8_t phase, uint8_t onoff) override;
 
+    void save_state(SnapshotWriter &w) override;
+    bool load_state(SnapshotReader &r, std::string &err) override;
+
     virtual int get_track() override { return track; }
 
     int16_t get_max_tracks() const { return max_tracks; }
@@ -15,23 +15,36 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "Floppy_woz.hpp"
 //#include "devices/diskii/diskii_fmt.hpp"
+#include "gs2.hpp"
+#include "util/JournalWriter.hpp"
 #include "util/SoundEffectKeys.hpp"
 #include "util/woz_nibblizer.hpp"
 
 // ───────────────────────────── mount/unmount/writeback ─────────────────────────
 
+Floppy_woz::~Floppy_woz() {
+    delete flusher;  // finishes any queued writeback
+}
+
 bool Floppy_woz::mount(uint64_t key, media_descriptor *media_in) {
     if (is_mounted) {
         unmount(key);
     }
 
+    // Finish (or discard) a writeback that was cut short last time, before
+    // reading the image.
+    WriteJournal::recover(media_in->filename);
+
     int rc = 0;
     if (media_in->media_type == MEDIA_WOZ) {
         rc = woz.load(media_in->filename);
@@ -73,6 +86,12 @@ bool Floppy_woz::mount(uint64_t key, media_descriptor *media_in) {
 
 bool Floppy_woz::unmount(uint64_t key) {
     //(void)key;
+    if (flusher) {
+        flusher->wait_idle();
+        flusher->take_failure();  // belongs to this disk, not the next one
+    }
+    dirty_frames = 0;
+    journal_left = false;
     // Reset WOZ image to a clean blank state.
     woz = Woz{};
     cur_track_ptr = nullptr;
@@ -89,58 +108,113 @@ bool Floppy_woz::unmount(uint64_t key) {
     return true;
 }
 
+int Floppy_woz::stage_writeback(WriteJournal &journal) {
+    if ((media_d->media_type == MEDIA_NYBBLE) || (media_d->media_type == MEDIA_BLK)) {
+        std::unique_ptr<Woz_Nibblizer> nibblizer(make_nibblizer(media_d));
+        if (!nibblizer) return -1;
+        if (nibblizer->stage_dirty_tracks(woz, media_d, journal) != 0) return -1;
+        woz.clear_dirty_tracks();
+        return 0;
+    }
+    return woz.stage_dirty_tracks(journal);
+}
+
+void Floppy_woz::writeback_failed() {
+    woz.writeback_failed();
+    modified = true;
+    journal_left = true;
+}
+
+void Floppy_woz::settle_journal() {
+    if (!journal_left) return;
+    if (flusher) flusher->wait_idle();
+    // Replaying it is harmless since every track goes out again anyway; if
+    // even that fails, drop it.
+    if (WriteJournal::recover(media_d->filename) != 0) {
+        WriteJournal::discard(media_d->filename);
+    }
+    journal_left = false;
+}
+
 bool Floppy_woz::writeback() {
     if (!media_d) return false;
 
-    // MEDIA_NYBBLE means the mount source was a 143K block image
-    // (.do/.po/.dsk): decode the in-memory WOZ bit stream back into a raw
-    // disk_image_t and rewrite the file in place. For native WOZ images
-    // just save as WOZ2.
-    // TODO: we should dealloc the nibblizer here on exit
+    // Background flushes were queued earlier; let them land first so the
+    // file sees writes in order.
+    if (flusher) {
+        flusher->wait_idle();
+        if (flusher->take_failure()) writeback_failed();
+    }
+    settle_journal();
+
+    // Only tracks the drive wrote to go back to the file. MEDIA_NYBBLE /
+    // MEDIA_BLK (.do/.po/.dsk/.2mg) decode just those tracks back into
+    // sectors; native WOZ2 rewrites just those tracks' blocks and the
+    // header CRC. Either way the writes go through a journal, so a crash
+    // part way can't leave a half-updated image.
     std::cout << "Floppy_woz: writing back disk image " << media_d->filename
               << " (media_type=" << media_d->media_type << ")" << std::endl;
 
-    auto nibblizer = make_nibblizer(media_d);
-    if (!nibblizer) return false;
-
-    if ((media_d->media_type == MEDIA_NYBBLE) || (media_d->media_type == MEDIA_BLK)) {
-        std::cout << "Floppy_woz: writing back block disk image" << std::endl;
-        int rc = nibblizer->export_block_image(woz, media_d);
-        if (rc != 0) {
-            fprintf(stderr, "Floppy_woz: block export failed for '%s'\n",
-                    media_d->filename.c_str());
-            return false;
-        }
-#if 0
-        disk_image_t out{};
-        if (woz.export_to_disk_image(out, media_d->interleave) != 0) {
-            fprintf(stderr,
-                    "Floppy_woz: WOZ->block export had decode errors for '%s'; "
-                    "writing partial result\n",
-                    media_d->filename.c_str());
-            // Fall through and write whatever was recovered, matching
-            // Floppy525::writeback()'s always-write behaviour.
-        }
-        if (!write_disk_image_po_do(media_d, out)) {
-            fprintf(stderr, "Floppy_woz: block writeback failed for '%s'\n",
+    WriteJournal journal(media_d->filename);
+    if (stage_writeback(journal) == 0) {
+        if (journal.commit() != 0) {
+            fprintf(stderr, "Floppy_woz: writeback failed for '%s'\n",
                     media_d->filename.c_str());
+            writeback_failed();
             return false;
         }
-#endif    
+    } else if ((media_d->media_type == MEDIA_NYBBLE) || (media_d->media_type == MEDIA_BLK)) {
+        fprintf(stderr, "Floppy_woz: block export failed for '%s'\n",
+                media_d->filename.c_str());
+        return false;
     } else {
-        std::cout << "Floppy_woz: writing back WOZ disk image" << std::endl;
+        // WOZ1, imported .nib, or a track that outgrew its blocks.
+        std::cout << "Floppy_woz: writing back whole WOZ disk image" << std::endl;
         int rc = woz.save(media_d->filename);
         if (rc != 0) {
             fprintf(stderr, "Floppy_woz: writeback failed for '%s'\n",
                     media_d->filename.c_str());
             return false;
         }
+        // The whole file is current now; no journal may be replayed over it.
+        WriteJournal::discard(media_d->filename);
     }
 
     modified = false;
     return true;
 }
 
+void Floppy_woz::flush_update() {
+    // A flush failed on the worker. Its journal may have reached the file not
+    // at all, partly (left behind for recover()), or completely; either way
+    // send everything again.
+    if (flusher && is_mounted && flusher->take_failure()) {
+        fprintf(stderr, "Floppy_woz: background flush failed for '%s'\n",
+                media_d->filename.c_str());
+        writeback_failed();
+    }
+    if (gs2_app_values.disk_flush_seconds <= 0 || !is_mounted || !modified) {
+        dirty_frames = 0;
+        return;
+    }
+    // Wait for the write to finish (motor off) unless it's been going on
+    // for longer than the flush interval.
+    dirty_frames++;
+    if (lss_disk_spinning() && dirty_frames < (uint32_t)gs2_app_values.disk_flush_seconds * 60) {
+        return;
+    }
+    dirty_frames = 0;
+
+    settle_journal();
+    WriteJournal journal(media_d->filename);
+    if (stage_writeback(journal) != 0) {
+        return;  // needs a whole-file save(); left for writeback() at unmount
+    }
+    if (!flusher) flusher = new JournalWriter("gs2-disk-flush");
+    flusher->submit(std::move(journal));
+    modified = false;
+}
+
 // ───────────────────────────── status / reset ─────────────────────────────────
 
 drive_status_t Floppy_woz::status() {
@@ -157,6 +231,27 @@ void Floppy_woz::reset() {
 
 // ───────────────────────────── track / bit stream helpers ────────────────────
 
+void Floppy_woz::save_state(SnapshotWriter &w) {
+    w.put(is_mounted);
+    w.put(enable);
+    w.put(last_cycle);
+    w.put(read_position);
+    w.put(head_position);
+    w.put(random_bits);
+    w.put(windowBits);
+}
+
+bool Floppy_woz::load_state(SnapshotReader &r, std::string &err) {
+    bool mounted;
+    if (!r.get(mounted)) return false;
+    if (mounted != is_mounted) {
+        err = mounted ? "snapshot has a disk in a drive that is empty now" : "snapshot has an empty drive that has a disk now";
+        return false;
+    }
+    return r.get(enable) && r.get(last_cycle) && r.get(read_position) && r.get(head_position)
+        && r.get(random_bits) && r.get(windowBits);
+}
+
 void Floppy_woz::update_track_ptr() {
     const uint64_t old_bits = cur_track_ptr ? cur_track_ptr->bit_count : 0;
     cur_track_ptr = woz.get_track_ptr(current_tmap_index());
@@ -196,7 +291,7 @@ uint64_t Floppy_woz::fast_forward(/* uint64_t now */) {
     // bits, all prior history is gone. So when the lag exceeds this cap
     // we snap read_position forward to leave a warm-up window in front
     // of the head and discard the rest. The IWM2 fast_forward_impl loop
-    // drives one bit per iteration, so after MAX_BITS_TO_SIM iterations
+    // consumes exactly the bits returned, so after MAX_BITS_TO_SIM bits
     // read_position lands exactly on (head_position >> 3).
     constexpr uint64_t MAX_BITS_TO_SIM = 32;
 
@@ -275,6 +370,58 @@ uint8_t Floppy_woz::read_pulse() {
     return bit;
 }
 
+// count (1..32) bits starting at bit index bi, MSB-first. Bytes past the end
+// of the buffer (WOZ metadata vs. buffer inconsistency) read as zero.
+static inline uint64_t extract_track_bits(const std::vector<uint8_t> &buf, uint64_t bi, uint32_t count) {
+    const size_t byte_idx = bi >> 3;
+    const uint32_t skip   = bi & 7;
+    const uint32_t nbytes = (skip + count + 7) >> 3;
+    uint64_t w = 0;
+    if (byte_idx + nbytes <= buf.size()) {
+        const uint8_t *p = buf.data() + byte_idx;
+        for (uint32_t k = 0; k < nbytes; k++) w = (w << 8) | p[k];
+    } else {
+        for (uint32_t k = 0; k < nbytes; k++) {
+            w = (w << 8) | (byte_idx + k < buf.size() ? buf[byte_idx + k] : 0);
+        }
+    }
+    return (w >> (nbytes * 8 - skip - count)) & ((1ull << count) - 1);
+}
+
+uint32_t Floppy_woz::read_bits(uint32_t n) {
+    uint64_t raw = 0;
+    if (lss_disk_spinning() && cur_track_ptr && cur_track_ptr->bit_count > 0) {
+        const uint64_t track_bits = cur_track_ptr->bit_count;
+        uint64_t bi = (read_position >> POSITION_FP_SHIFT) % track_bits;
+        uint32_t left = n;
+        while (left) {
+            uint32_t take = static_cast<uint32_t>(std::min<uint64_t>(left, track_bits - bi));
+            raw = (raw << take) | extract_track_bits(cur_track_ptr->bits, bi, take);
+            left -= take;
+            bi += take;
+            if (bi == track_bits) bi = 0;
+        }
+    }
+
+    // Four-zero fake-bit shim, all n cells at once: a cell is fake when it
+    // and the three before it (including the tail of windowBits) are zero.
+    // Random bits are drawn earliest cell first, as read_pulse() would.
+    uint64_t window = (static_cast<uint64_t>(windowBits & 0x07) << n) | raw;
+    uint64_t fake = ~(window | (window >> 1) | (window >> 2) | (window >> 3)) & ((1ull << n) - 1);
+    windowBits = static_cast<uint32_t>((static_cast<uint64_t>(windowBits) << n) | raw);
+    while (fake) {
+        int b = 63 - __builtin_clzll(fake);
+        fake &= ~(1ull << b);
+        raw |= static_cast<uint64_t>(get_random_bit()) << b;
+    }
+
+    read_position += n * POSITION_FP_MUL;
+    if (cur_track_ptr && cur_track_ptr->bit_count > 0) {
+        read_position %= cur_track_ptr->bit_count * POSITION_FP_MUL;
+    }
+    return static_cast<uint32_t>(raw);
+}
+
 void Floppy_woz::write_pulse(uint8_t bit) {
     if (lss_disk_spinning() && cur_track_ptr && cur_track_ptr->bit_count > 0) {
         uint64_t track_bits  = cur_track_ptr->bit_count;
@@ -288,6 +435,7 @@ void Floppy_woz::write_pulse(uint8_t bit) {
             uint8_t mask = static_cast<uint8_t>(1u << (7 - static_cast<int>(bit_in_byte)));
             if (bit & 1) cur_track_ptr->bits[byte_idx] |= mask;
             else         cur_track_ptr->bits[byte_idx] &= static_cast<uint8_t>(~mask);
+            cur_track_ptr->dirty = true;
             modified = true;
         }
     }
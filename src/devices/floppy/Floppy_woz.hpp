@@ -19,16 +19,19 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <string>
 
 #include "util/woz.hpp"
 #include "util/SoundEffect.hpp"
 #include "NClock.hpp"
 #include "util/media.hpp"
 #include "util/mount.hpp"
+#include "util/Snapshot.hpp"
 
 
 class EventTimer;
 class Woz_Nibblizer;
+class JournalWriter;
 
 // Abstract base for floppy drives backed by a WOZ in-memory bit stream.
 //
@@ -87,6 +90,22 @@ protected:
     EventTimer *event_timer = nullptr;
     FILE       *dbglog      = nullptr;
 
+    // Background writeback (--disk-flush). Created on first use.
+    JournalWriter *flusher      = nullptr;
+    uint32_t       dirty_frames = 0;
+    bool           journal_left = false;  // a commit failed; its journal may still be on disk
+
+    // Queue every dirty track into journal as in-place writes: its WOZ2
+    // blocks for WOZ media, its re-decoded sectors for block images.
+    // Returns -1 if the WOZ file has to be rewritten whole instead.
+    int stage_writeback(WriteJournal &journal);
+    // A journal from stage_writeback() failed to commit. We don't know which
+    // tracks it held, so everything goes back out with the next writeback.
+    void writeback_failed();
+    // Deal with the journal a failed commit left behind before anything else
+    // is written, so a later mount can't replay it over newer data.
+    void settle_journal();
+
     virtual uint64_t get_current_time() { return clock->get_cycles(); }
 
     // Angular-preserving track switch. Looks up the new track via
@@ -115,6 +134,10 @@ protected:
     // spindle command and media present.
     virtual bool lss_disk_spinning() const { return enable; }
 
+    // After a snapshot load: point at the restored track without the
+    // angular rescale update_track_ptr() does for a head step.
+    void reload_track_ptr() { cur_track_ptr = woz.get_track_ptr(current_tmap_index()); }
+
     void note_spinning_inputs_changed(bool was_spinning) {
         if (!was_spinning && lss_disk_spinning()) {
             last_cycle = get_current_time();
@@ -124,7 +147,7 @@ protected:
 public:
     Floppy_woz(SoundEffect *sound_effect, NClockII *clock, EventTimer *event_timer)
         : sound_effect(sound_effect), clock(clock), event_timer(event_timer) {}
-    virtual ~Floppy_woz() = default;
+    virtual ~Floppy_woz();
 
     virtual Woz_Nibblizer* make_nibblizer(media_descriptor *media) { return nullptr; };
 
@@ -134,12 +157,28 @@ public:
     virtual bool mount(uint64_t key, media_descriptor *media);
     virtual bool unmount(uint64_t key);
     virtual bool writeback();
+
+    // Call once per frame. With --disk-flush, hands dirty tracks to a
+    // background writer once the disk stops spinning, or after the
+    // configured interval if it keeps spinning.
+    void flush_update();
     virtual drive_status_t status();
     virtual void reset();
 
+    // Snapshot of the drive mechanics and head position. The media isn't
+    // saved: the same image has to be mounted when the snapshot is loaded,
+    // and load_state fails if a disk is present in one and not the other.
+    virtual void save_state(SnapshotWriter &w);
+    virtual bool load_state(SnapshotReader &r, std::string &err);
+
     virtual uint8_t read_pulse();
     virtual void    write_pulse(uint8_t bit);
 
+    // Equivalent to n (<= 32) read_pulse() calls, first bit in bit n-1 of
+    // the result. Reads the track a byte at a time and wraps the bit index
+    // instead of taking a modulo per bit.
+    uint32_t read_bits(uint32_t n);
+
     virtual void set_phase(uint8_t phase, uint8_t onoff) = 0;
 
     virtual int get_track() = 0;
@@ -0,0 +1,370 @@
+/*
+ * Directory listing cache for the Host FST. See host_dircache.h.
+ * Copyright (c) 2025-2026 Jawaid Bazyar — GSSquared adapter.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#define HOST_DIRCACHE_INOTIFY 1
+#else
+#define HOST_DIRCACHE_INOTIFY 0
+#endif
+
+#include "defc_shim.h"
+#include "gsos.h"
+
+#include "host_common.h"
+#include "host_dircache.h"
+
+#if defined(__APPLE__)
+#define ST_MTIM(st) ((st).st_mtimespec)
+#define ST_CTIM(st) ((st).st_ctimespec)
+#else
+#define ST_MTIM(st) ((st).st_mtim)
+#define ST_CTIM(st) ((st).st_ctim)
+#endif
+
+/* listings kept around with no open reference, most recently used first. */
+#define HOST_DIRCACHE_MAX 64
+
+static struct host_dir *cache_head = NULL;
+
+#if HOST_DIRCACHE_INOTIFY
+static int inotify_fd = -1;
+static int inotify_failed = 0;
+
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | \
+                    IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF)
+#endif
+
+static int same_time(const struct timespec *a, const struct timespec *b) {
+  return a->tv_sec == b->tv_sec && a->tv_nsec == b->tv_nsec;
+}
+
+static int entry_cmp(const void *a, const void *b) {
+  return strcmp(((const struct host_dir_entry *)a)->name, ((const struct host_dir_entry *)b)->name);
+}
+
+static struct host_dir_entry *find_entry(struct host_dir *dir, const char *name) {
+  struct host_dir_entry key;
+  if (dir->num_entries == 0) return NULL; /* entries may be NULL */
+  key.name = (char *)name;
+  return bsearch(&key, dir->entries, dir->num_entries, sizeof(struct host_dir_entry), entry_cmp);
+}
+
+/* path without trailing /s; returns its length. */
+static size_t path_len(const char *path) {
+  size_t len = strlen(path);
+  while (len > 1 && path[len - 1] == '/') --len;
+  return len;
+}
+
+static struct host_dir *find_dir(const char *path, size_t len) {
+  for (struct host_dir *d = cache_head; d; d = d->next) {
+    if (strlen(d->path) == len && !memcmp(d->path, path, len)) return d;
+  }
+  return NULL;
+}
+
+static void free_dir(struct host_dir *dir) {
+  for (int i = 0; i < dir->num_entries; ++i) free(dir->entries[i].name);
+  free(dir->entries);
+  free(dir->path);
+  free(dir);
+}
+
+static void unwatch(struct host_dir *dir) {
+#if HOST_DIRCACHE_INOTIFY
+  if (dir->wd >= 0 && inotify_fd >= 0) inotify_rm_watch(inotify_fd, dir->wd);
+#endif
+  dir->wd = -1;
+}
+
+/* take dir out of the cache; an open directory keeps it until released. */
+static void drop_dir(struct host_dir *dir) {
+  struct host_dir **pp = &cache_head;
+  while (*pp && *pp != dir) pp = &(*pp)->next;
+  if (*pp) *pp = dir->next;
+  dir->next = NULL;
+  dir->stale = 1;
+  unwatch(dir);
+  if (dir->refcount == 0) free_dir(dir);
+}
+
+static void trim_cache(void) {
+  int n = 0;
+  struct host_dir *victim = NULL;
+  for (struct host_dir *d = cache_head; d; d = d->next) {
+    ++n;
+    if (d->refcount == 0) victim = d;   /* least recently used idle listing */
+  }
+  if (n > HOST_DIRCACHE_MAX && victim) drop_dir(victim);
+}
+
+#if HOST_DIRCACHE_INOTIFY
+static struct host_dir *find_wd(int wd) {
+  for (struct host_dir *d = cache_head; d; d = d->next) {
+    if (d->wd == wd) return d;
+  }
+  return NULL;
+}
+
+static void watch(struct host_dir *dir) {
+  if (inotify_fd < 0 && !inotify_failed) {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+      fprintf(stderr, "Host FST: inotify unavailable (%s), checking mtimes instead\n", strerror(errno));
+      inotify_failed = 1;
+    }
+  }
+  if (inotify_fd < 0) return;
+  /* ENOSPC (out of watches) etc. just means this listing is checked by mtime. */
+  int wd = inotify_add_watch(inotify_fd, dir->path, WATCH_MASK | IN_ONLYDIR);
+  /* same inode under another path: the kernel hands back that listing's watch. */
+  if (wd >= 0 && find_wd(wd)) wd = -1;
+  dir->wd = wd;
+}
+
+static void drain_events(void) {
+  if (inotify_fd < 0) return;
+
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  for (;;) {
+    ssize_t n = read(inotify_fd, buf, sizeof(buf));
+    if (n <= 0) break;
+    for (char *p = buf; p < buf + n; ) {
+      const struct inotify_event *ev = (const struct inotify_event *)p;
+      p += sizeof(struct inotify_event) + ev->len;
+
+      if (ev->mask & IN_Q_OVERFLOW) {
+        /* lost track; start over. */
+        host_dircache_flush();
+        continue;
+      }
+      struct host_dir *dir = find_wd(ev->wd);
+      if (!dir) continue;
+
+      if (ev->mask & (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE)) {
+        if (ev->len && ev->name[0]) {
+          struct host_dir_entry *e = find_entry(dir, ev->name);
+          if (e) e->fi_valid = 0;
+        }
+        /* IN_ATTRIB on the directory itself changes nothing we list. */
+        if (!(ev->mask & ~(IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_ISDIR))) continue;
+      }
+      /* names came or went, or the directory itself did. */
+      if (ev->mask & IN_IGNORED) dir->wd = -1;
+      drop_dir(dir);
+    }
+  }
+}
+#else
+static void watch(struct host_dir *dir) {
+  (void)dir;
+}
+
+static void drain_events(void) {
+}
+#endif
+
+/* the directory as it is now; for listings that aren't watched. */
+static int dir_unchanged(struct host_dir *dir) {
+  struct stat st;
+  if (stat(dir->path, &st) < 0) return 0;
+  return st.st_dev == dir->dev && st.st_ino == dir->ino && st.st_size == dir->size
+      && same_time(&ST_MTIM(st), &dir->mtime);
+}
+
+static void discard_dir(struct host_dir *dir) {
+  unwatch(dir);
+  free_dir(dir);
+}
+
+static struct host_dir *scan_dir(const char *path, size_t len, int (*filter)(const char *), word16 *error) {
+  struct host_dir *dir = calloc(1, sizeof(struct host_dir));
+  if (!dir || !(dir->path = malloc(len + 1))) {
+    free(dir);
+    *error = outOfMem;
+    return NULL;
+  }
+  memcpy(dir->path, path, len);
+  dir->path[len] = 0;
+  dir->wd = -1;
+
+  /* watch first, so a change made while we read can't be missed. */
+  watch(dir);
+
+  struct stat st;
+  DIR *dirp = NULL;
+  if (stat(path, &st) < 0 || !(dirp = opendir(path))) {
+    *error = host_map_errno_path(errno, path);
+    discard_dir(dir);
+    return NULL;
+  }
+  dir->dev = st.st_dev;
+  dir->ino = st.st_ino;
+  dir->size = st.st_size;
+  dir->mtime = ST_MTIM(st);
+
+  int capacity = 0;
+  for (;;) {
+    struct dirent *d = readdir(dirp);
+    if (!d) break;
+    if (filter && filter(d->d_name)) continue;
+
+    if (dir->num_entries >= capacity) {
+      int new_capacity = capacity ? capacity * 2 : 100;
+      struct host_dir_entry *tmp = realloc(dir->entries, new_capacity * sizeof(struct host_dir_entry));
+      if (!tmp) {
+        *error = outOfMem;
+        discard_dir(dir);
+        closedir(dirp);
+        return NULL;
+      }
+      dir->entries = tmp;
+      capacity = new_capacity;
+    }
+    struct host_dir_entry *e = &dir->entries[dir->num_entries];
+    memset(e, 0, sizeof(*e));
+    e->name = strdup(d->d_name);
+    if (!e->name) {
+      *error = outOfMem;
+      discard_dir(dir);
+      closedir(dirp);
+      return NULL;
+    }
+    dir->num_entries++;
+  }
+  closedir(dirp);
+
+  if (dir->num_entries > 0)
+    qsort(dir->entries, dir->num_entries, sizeof(struct host_dir_entry), entry_cmp);
+  return dir;
+}
+
+struct host_dir *host_dircache_open(const char *path, int (*filter)(const char *name), word16 *error) {
+  size_t len = path_len(path);
+
+  drain_events();
+
+  struct host_dir *dir = find_dir(path, len);
+  if (dir && dir->wd < 0 && !dir_unchanged(dir)) {
+    drop_dir(dir);
+    dir = NULL;
+  }
+
+  if (dir) {
+    /* move to the front. */
+    struct host_dir **pp = &cache_head;
+    while (*pp != dir) pp = &(*pp)->next;
+    *pp = dir->next;
+  } else {
+    dir = scan_dir(path, len, filter, error);
+    if (!dir) return NULL;
+  }
+  dir->next = cache_head;
+  cache_head = dir;
+  dir->refcount++;
+
+  trim_cache();
+  return dir;
+}
+
+void host_dircache_release(struct host_dir *dir) {
+  if (!dir) return;
+  if (--dir->refcount == 0 && dir->stale) free_dir(dir);
+}
+
+static word32 fill_entry(struct host_dir_entry *e, const char *fullpath, struct file_info *fi) {
+  struct stat st;
+  int have_stat = (stat(fullpath, &st) == 0);
+
+  e->fi_error = host_get_file_info(fullpath, &e->fi);
+  e->fi_valid = 1;
+  if (have_stat) {
+    e->mtime = ST_MTIM(st);
+    e->ctime = ST_CTIM(st);
+    e->size = st.st_size;
+    e->is_dir = S_ISDIR(st.st_mode);
+  } else {
+    e->fi_valid = 0;    /* vanished under us; don't keep the error */
+  }
+  *fi = e->fi;
+  return e->fi_error;
+}
+
+static word32 entry_info(struct host_dir *dir, struct host_dir_entry *e, const char *fullpath, struct file_info *fi) {
+  if (e->fi_valid && (dir->wd < 0 || e->is_dir)) {
+    struct stat st;
+    if (stat(fullpath, &st) < 0
+        || st.st_size != e->size
+        || !same_time(&ST_MTIM(st), &e->mtime)
+        || !same_time(&ST_CTIM(st), &e->ctime)) {
+      e->fi_valid = 0;
+    }
+  }
+  if (!e->fi_valid) return fill_entry(e, fullpath, fi);
+  *fi = e->fi;
+  return e->fi_error;
+}
+
+word32 host_dircache_entry_info(struct host_dir *dir, int index, const char *fullpath, struct file_info *fi) {
+  drain_events();
+  if (dir->stale || index < 0 || index >= dir->num_entries) return host_get_file_info(fullpath, fi);
+  return entry_info(dir, &dir->entries[index], fullpath, fi);
+}
+
+word32 host_dircache_file_info(const char *path, struct file_info *fi) {
+  drain_events();
+
+  size_t len = path_len(path);
+  const char *slash = NULL;
+  for (size_t i = 0; i < len; ++i) {
+    if (path[i] == '/') slash = path + i;
+  }
+  if (!slash || (size_t)(slash - path) + 1 >= len) return host_get_file_info(path, fi);
+
+  struct host_dir *dir = find_dir(path, slash == path ? 1 : (size_t)(slash - path));
+  if (!dir || (dir->wd < 0 && !dir_unchanged(dir))) return host_get_file_info(path, fi);
+
+  char name[256];
+  size_t nlen = len - (size_t)(slash - path) - 1;
+  if (nlen >= sizeof(name)) return host_get_file_info(path, fi);
+  memcpy(name, slash + 1, nlen);
+  name[nlen] = 0;
+
+  struct host_dir_entry *e = find_entry(dir, name);
+  if (!e) return host_get_file_info(path, fi);   /* filtered out, or not there */
+  return entry_info(dir, e, path, fi);
+}
+
+void host_dircache_invalidate(const char *path) {
+  size_t len = path_len(path);
+
+  drain_events();
+
+  struct host_dir *dir = find_dir(path, len);
+  if (dir) drop_dir(dir);
+
+  for (size_t i = len; i > 0; --i) {
+    if (path[i - 1] != '/') continue;
+    dir = find_dir(path, i == 1 ? 1 : i - 1);
+    if (dir) drop_dir(dir);
+    break;
+  }
+}
+
+void host_dircache_flush(void) {
+  while (cache_head) drop_dir(cache_head);
+#if HOST_DIRCACHE_INOTIFY
+  if (inotify_fd >= 0) close(inotify_fd);
+  inotify_fd = -1;
+  inotify_failed = 0;
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <time.h>
+
+#include "defc_shim.h"
+#include "host_common.h"
+
+/*
+ * Directory listing cache.
+ *
+ * A cached listing keeps a directory's sorted names and, filled in lazily,
+ * each entry's file_info, so repeated opens and GetDirEntry calls don't go
+ * back to the host.
+ *
+ * On Linux each cached directory gets an inotify watch: a change to an
+ * entry drops that entry's info and a create/delete/rename drops the
+ * listing. Elsewhere (or if the watch can't be added) the directory's
+ * mtime is checked on open, and an entry's info is reused only while its
+ * mtime, ctime and size are unchanged. Subdirectory entries are always
+ * re-stat'ed, since changes inside them don't reach the parent's watch.
+ *
+ * An open directory holds a reference to its listing, so GetDirEntry
+ * positions stay put while it is open. If the listing goes stale in the
+ * meantime, entry info for it is read live from the host.
+ */
+
+struct host_dir_entry {
+  char *name;
+  int fi_valid;
+  word32 fi_error;
+  struct file_info fi;
+  struct timespec mtime;
+  struct timespec ctime;
+  off_t size;
+  int is_dir;
+};
+
+struct host_dir {
+  struct host_dir *next;
+  char *path;
+  int refcount;
+  int stale;          /* out of the cache; freed when the last reference goes */
+  int wd;             /* inotify watch descriptor, -1 if validated by mtime */
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+  off_t size;
+  int num_entries;
+  struct host_dir_entry *entries;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* returns a referenced, sorted listing of path with filtered names left out. */
+struct host_dir *host_dircache_open(const char *path, int (*filter)(const char *name), word16 *error);
+void host_dircache_release(struct host_dir *dir);
+
+/* file info for entry index of dir; fullpath is dir->path + name. */
+word32 host_dircache_entry_info(struct host_dir *dir, int index, const char *fullpath, struct file_info *fi);
+
+/* host_get_file_info, answered from the parent's cached listing when there is one. */
+word32 host_dircache_file_info(const char *path, struct file_info *fi);
+
+/* the FST changed path (or its parent directory) itself. */
+void host_dircache_invalidate(const char *path);
+
+/* drop everything, e.g. when the host root changes. */
+void host_dircache_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
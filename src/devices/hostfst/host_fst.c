@@ -38,6 +38,7 @@
 #include "fst.h"
 
 #include "host_common.h"
+#include "host_dircache.h"
 
 /*
  * MFS/HFS classic limit. Volume/dir entries report mfsFSID; Finder assumes
@@ -65,8 +66,7 @@ extern Engine_reg engine;
 
 struct directory {
   int displacement;
-  int num_entries;
-  char *entries[1];
+  struct host_dir *listing;
 };
 
 struct fd_entry {
@@ -511,6 +511,7 @@ static word32 fst_create(int class, const char *path) {
     if (ok < 0) {
       return host_map_errno_path(errno, path);
     }
+    host_dircache_invalidate(path);
 
     if (class) {
       if (pcount >= 5) set_memory16_c(pb + CreateRecGS_storageType, fi.storage_type, 0);
@@ -528,6 +529,7 @@ static word32 fst_create(int class, const char *path) {
     // set ftype, auxtype...
     host_set_file_info(path, &fi);
     close(ok);
+    host_dircache_invalidate(path);
 
     fi.storage_type = 1;
 
@@ -574,6 +576,7 @@ static word32 fst_destroy(int class, const char *path) {
 
 
   if (ok < 0) return host_map_errno_path(errno, path);
+  host_dircache_invalidate(path);
   return 0;
 }
 
@@ -636,7 +639,9 @@ static word32 fst_set_file_info(int class, const char *path) {
   }
 
 
-  return host_set_file_info(path, &fi);
+  word32 rv = host_set_file_info(path, &fi);
+  host_dircache_invalidate(path);
+  return rv;
 }
 
 static word32 fst_get_file_info(int class, const char *path) {
@@ -646,7 +651,7 @@ static word32 fst_get_file_info(int class, const char *path) {
   struct file_info fi;
   int rv = 0;
 
-  rv = host_get_file_info(path, &fi);
+  rv = host_dircache_file_info(path, &fi);
   if (rv) return rv;
 
   if (class) {
@@ -1352,16 +1357,10 @@ static word32 fst_get_eof(int class) {
 
 static void free_directory(struct directory *dd) {
   if (!dd) return;
-  for (int i = 0; i < dd->num_entries; ++i) {
-    free(dd->entries[i]);
-  }
+  host_dircache_release(dd->listing);
   free(dd);
 }
 
-static int qsort_callback(const void *a, const void *b) {
-  return strcmp(*(const char **)a, *(const char **)b);
-}
-
 /*
  * exclude files from get_dir_entries.
  *
@@ -1393,50 +1392,17 @@ static int filter_directory_entry(const char *name) {
 
 
 static struct directory *read_directory(const char *path, word16 *error) {
-  DIR *dirp;
-  struct directory *dd;
-  int capacity = 100;
-  int size = sizeof(struct directory) + capacity * sizeof(char *);
-
-  dirp = opendir(path);
-  if (!dirp) {
-    *error = host_map_errno_path(errno, path);
-    return NULL;
-  }
-
-  dd = (struct directory *)malloc(size);
+  struct directory *dd = calloc(1, sizeof(struct directory));
   if (!dd) {
     *error = outOfMem;
-    closedir(dirp);
     return NULL;
   }
-  memset(dd, 0, size);
-
-  for(;;) {
-    struct dirent *d = readdir(dirp);
-    if (!d) break;
-    if (filter_directory_entry(d->d_name)) continue;
-
-    if (dd->num_entries >= capacity) {
-      capacity += capacity;
-      size = sizeof(struct directory) + capacity * sizeof(char *);
-      struct directory * tmp = realloc(dd, size);
-      if (!tmp) {
-        *error = host_map_errno(errno);
-        free_directory(dd);
-        closedir(dirp);
-        return NULL;
-      }
-      dd = tmp;
-    }
-    dd->entries[dd->num_entries++] = strdup(d->d_name);
-  };
-
-  closedir(dirp);
-
-  // sort them....
-  qsort(dd->entries, dd->num_entries, sizeof(char *), qsort_callback);
 
+  dd->listing = host_dircache_open(path, filter_directory_entry, error);
+  if (!dd->listing) {
+    free(dd);
+    return NULL;
+  }
   return dd;
 }
 
@@ -1472,7 +1438,7 @@ static word32 fst_get_dir_entry(int class) {
 
   if (base == 0 && displacement == 0) {
     // count them up.
-    int count = e->dir->num_entries;
+    int count = e->dir->listing->num_entries;
     e->dir->displacement = 0;
 
     if (class) {
@@ -1501,15 +1467,16 @@ static word32 fst_get_dir_entry(int class) {
   //if (displacement) --displacement;
   --displacement;
   if (displacement < 0) return endOfDir;
-  if (displacement >= e->dir->num_entries) return endOfDir;
+  if (displacement >= e->dir->listing->num_entries) return endOfDir;
 
 
   word32 rv = 0;
-  const char *dname = e->dir->entries[displacement++];
+  int index = displacement++;
+  const char *dname = e->dir->listing->entries[index].name;
   e->dir->displacement = displacement;
   char *fullpath = host_gc_append_path(e->path, dname);
   struct  file_info fi;
-  rv = host_get_file_info(fullpath, &fi);
+  rv = host_dircache_entry_info(e->dir->listing, index, fullpath, &fi);
 
   if (dname) fprintf(stderr, " - %s", dname);
 
@@ -1575,6 +1542,8 @@ static word32 fst_change_path(int class, const char *path1, const char *path2) {
   if (stat(path2, &st) == 0) return dupPathname;
 
   if (rename(path1, path2) < 0) return host_map_errno_path(errno, path2);
+  host_dircache_invalidate(path1);
+  host_dircache_invalidate(path2);
   return 0;
 }
 
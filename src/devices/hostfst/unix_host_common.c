@@ -44,6 +44,7 @@
 #include "gsos.h"
 
 #include "host_common.h"
+#include "host_dircache.h"
 
 
 static ino_t root_ino = 0;
@@ -75,6 +76,7 @@ unsigned host_startup(void) {
 }
 
 void host_shutdown(void) {
+  host_dircache_flush();
   if (host_root) free(host_root);
   host_root = NULL;
   root_ino = 0;
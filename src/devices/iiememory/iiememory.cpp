@@ -25,6 +25,7 @@
 #include "devices/languagecard/languagecard.hpp" // to get bit flag names
 
 #include "mmus/mmu_iie.hpp"
+#include "mmus/iie_map_templates.hpp"
 
 #include "mbus/KeyboardMessage.hpp"
 #include "mbus/MessageBus.hpp"
@@ -45,54 +46,8 @@
 
 void bsr_map_memory(iiememory_state_t *lc) {
 
-    uint32_t bankd0offset = (lc->ll.FF_BANK_1 == 1) ? 0xC000 : 0xD000;
-    uint32_t banke0offset = 0xE000;
-    if (lc->f_altzp) {
-        bankd0offset += 0x1'0000; // alternate bank!
-        banke0offset += 0x1'0000; // alternate bank!
-    }
-
-    //uint8_t *bank = (lc->FF_BANK_1 == 1) ? lc->ram : lc->ram + 0x1000;
-    uint8_t *bankd0 = lc->ram + bankd0offset;
-    uint8_t *banke0 = lc->ram + banke0offset;
-    uint8_t *rom = lc->mmu->get_rom_base();
-
-    const char *bank_d = (lc->ll.FF_BANK_1 == 1) ? "LC_BANK1" : "LC_BANK2";
-
-    /* Map D0 - DF */
-    for (int i = 0; i < 16; i++) {
-        if (lc->ll.FF_READ_ENABLE) {
-            lc->mmu->map_page_read(i + 0xD0, bankd0 + (i*GS2_PAGE_SIZE), bank_d);
-        } else { // reads == READ_ROM
-        // TODO: this is wrong - needs to somehow know to return to ROM D0/etc wherever that may be.
-        // right now hard-code to what we know about the iie rom.
-            lc->mmu->map_page_read(i + 0xD0, rom + 0x1000 + (i*GS2_PAGE_SIZE), "SYS_ROM");
-        }
-
-        if (!lc->ll._FF_WRITE_ENABLE) {
-            lc->mmu->map_page_write(i+0xD0, bankd0 + (i*GS2_PAGE_SIZE), bank_d);
-
-        } else { // writes == WRITE_NONE - set it to the ROM and can_write = 0
-            lc->mmu->map_page_write(i+0xD0, nullptr, "NONE"); // much simpler actually.. no write enable means null write pointer.
-        }
-    }
-
-    /* Map E0 - FF */
-    for (int i = 0; i < 32; i++) {
-        if (lc->ll.FF_READ_ENABLE) {
-            lc->mmu->map_page_read(i+0xE0, banke0 + (i * GS2_PAGE_SIZE), "LC RAM");
-
-        } else { // reads == READ_ROM
-            // TODO: this is wrong - needs to somehow know to return to ROM D0/etc wherever that may be.
-            lc->mmu->map_page_read(i+0xE0, rom + 0x2000 + (i * GS2_PAGE_SIZE), "SYS_ROM");
-        }
-
-        if (!lc->ll._FF_WRITE_ENABLE) {
-            lc->mmu->map_page_write(i+0xE0, banke0 + (i * GS2_PAGE_SIZE), "LC RAM");
-        } else { // writes == WRITE_NONE - set it to the ROM and can_write = 0
-            lc->mmu->map_page_write(i+0xE0, nullptr, "NONE"); // much simpler actually.. no write enable means null write pointer.
-        }
-    }
+    int v = iie_bsr_index(lc->ll.FF_BANK_1 == 1, lc->ll.FF_READ_ENABLE, !lc->ll._FF_WRITE_ENABLE, lc->f_altzp);
+    lc->mmu->apply_page_maps(0xD0, 0x30, lc->maps->bsr[v]);
 
     if (DEBUG(DEBUG_LANGCARD)) {
         lc->mmu->dump_page_table(0xD0, 0xD0);
@@ -162,9 +117,6 @@ void iiememory_debug(iiememory_state_t *iiememory_d) {
 }
 
 void iiememory_compose_map(iiememory_state_t *iiememory_d) {
-    const char *TAG_MAIN = "MAIN";
-    const char *TAG_ALT = "AUX";
-        
     bool n_zp; 
     bool n_text1_r;
     bool n_text1_w;
@@ -195,73 +147,30 @@ void iiememory_compose_map(iiememory_state_t *iiememory_d) {
         n_hires1_w = iiememory_d->f_ramwrt;
     }
 
-    uint8_t *memory_base = iiememory_d->ram;
+    MMU_II *mmu = iiememory_d->mmu;
+    iie_map_templates_t *maps = iiememory_d->maps;
 
     if (n_zp != iiememory_d->m_zp) { // this is both read and write.
         // change $00, $01, $D0 - $FF
-        uint32_t altoffset = n_zp ? 0x1'0000 : 0x0'0000;
+        mmu->apply_page_maps(0x00, 0x02, maps->zp[n_zp]);
 
-        iiememory_d->mmu->map_page_read(0x00, memory_base + altoffset + 0x0000, n_zp ? TAG_ALT : TAG_MAIN);
-        iiememory_d->mmu->map_page_write(0x00, memory_base + altoffset + 0x0000, n_zp ? TAG_ALT : TAG_MAIN);
-        iiememory_d->mmu->map_page_read(0x01, memory_base + altoffset + 0x0100, n_zp ? TAG_ALT : TAG_MAIN);
-        iiememory_d->mmu->map_page_write(0x01, memory_base + altoffset + 0x0100, n_zp ? TAG_ALT : TAG_MAIN);
-        
         // handle mapping the "language card" portion.
         bsr_map_memory(iiememory_d); // handle the 'language card' portion.
     }
-    if (n_text1_r != iiememory_d->m_text1_r) {
-        // change $04 - $07
-        uint32_t altoffset = n_text1_r ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x04; i <= 0x07; i++) {
-            iiememory_d->mmu->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_text1_r ? TAG_ALT : TAG_MAIN);
-        }
-    }
-    if (n_text1_w != iiememory_d->m_text1_w) {
+    if (n_text1_r != iiememory_d->m_text1_r || n_text1_w != iiememory_d->m_text1_w) {
         // change $04 - $07
-        uint32_t altoffset = n_text1_w ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x04; i <= 0x07; i++) {
-            iiememory_d->mmu->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_text1_w ? TAG_ALT : TAG_MAIN);
-        }
-    }
-    if (n_hires1_r != iiememory_d->m_hires1_r) {
-        // change $20 - $3F
-        uint32_t altoffset = n_hires1_r ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x20; i <= 0x3F; i++) {
-            iiememory_d->mmu->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_hires1_r ? TAG_ALT : TAG_MAIN);
-        }
+        mmu->apply_page_maps(0x04, 0x04, maps->text1[iie_aux_index(n_text1_r, n_text1_w)]);
     }
-    if (n_hires1_w != iiememory_d->m_hires1_w) {
+    if (n_hires1_r != iiememory_d->m_hires1_r || n_hires1_w != iiememory_d->m_hires1_w) {
         // change $20 - $3F
-        uint32_t altoffset = n_hires1_w ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x20; i <= 0x3F; i++) {
-            iiememory_d->mmu->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_hires1_w ? TAG_ALT : TAG_MAIN);
-        }
-    }
-    if (n_all_r != iiememory_d->m_all_r) {  
-        // change $02 - $03, $08 - $1F, $40 - $BF
-        uint32_t altoffset = n_all_r ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x02; i <= 0x03; i++) {
-            iiememory_d->mmu->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_r ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x08; i <= 0x1F; i++) {
-            iiememory_d->mmu->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_r ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x40; i <= 0xBF; i++) {
-            iiememory_d->mmu->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_r ? TAG_ALT : TAG_MAIN);
-        }
+        mmu->apply_page_maps(0x20, 0x20, maps->hires1[iie_aux_index(n_hires1_r, n_hires1_w)]);
     }
-    if (n_all_w != iiememory_d->m_all_w) {
+    if (n_all_r != iiememory_d->m_all_r || n_all_w != iiememory_d->m_all_w) {
         // change $02 - $03, $08 - $1F, $40 - $BF
-        uint32_t altoffset = n_all_w ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x02; i <= 0x03; i++) {
-            iiememory_d->mmu->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_w ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x08; i <= 0x1F; i++) {
-            iiememory_d->mmu->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_w ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x40; i <= 0xBF; i++) {
-            iiememory_d->mmu->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_w ? TAG_ALT : TAG_MAIN);
-        }
+        int v = iie_aux_index(n_all_r, n_all_w);
+        mmu->apply_page_maps(0x02, 0x02, maps->low[v]);
+        mmu->apply_page_maps(0x08, 0x18, maps->mid[v]);
+        mmu->apply_page_maps(0x40, 0x80, maps->high[v]);
     }
 
     // update the "current memory map state" flags.
@@ -452,6 +361,8 @@ void init_iiememory(computer_t *computer, SlotType_t slot) {
     iiememory_d->mmu = computer->mmu;
     iiememory_d->ram = computer->mmu->get_memory_base();
     iiememory_d->mbus = computer->mbus;
+    iiememory_d->maps = new iie_map_templates_t;
+    iie_map_templates_build(iiememory_d->maps, iiememory_d->ram, computer->mmu->get_rom_base());
 
     computer->set_module_state(MODULE_IIEMEMORY, iiememory_d);
     
@@ -497,6 +408,35 @@ void init_iiememory(computer_t *computer, SlotType_t slot) {
             return true;
         });
 
+    // the RAM itself is in the MMU's chunk.
+    computer->register_snapshot_handler(snapshot_tag("IIEM"), 1,
+        [iiememory_d](SnapshotWriter &w) {
+            w.put(iiememory_d->f_80store);
+            w.put(iiememory_d->f_ramrd);
+            w.put(iiememory_d->f_ramwrt);
+            w.put(iiememory_d->f_altzp);
+            w.put(iiememory_d->s_hires);
+            w.put(iiememory_d->s_page2);
+            w.put(iiememory_d->s_text);
+            w.put(iiememory_d->s_mixed);
+            w.put(iiememory_d->ll.FF_BANK_1);
+            w.put(iiememory_d->ll.FF_READ_ENABLE);
+            w.put(iiememory_d->ll.FF_PRE_WRITE);
+            w.put(iiememory_d->ll._FF_WRITE_ENABLE);
+        },
+        [iiememory_d](SnapshotReader &r, std::string &err) {
+            bool ok = r.get(iiememory_d->f_80store) && r.get(iiememory_d->f_ramrd)
+                && r.get(iiememory_d->f_ramwrt) && r.get(iiememory_d->f_altzp)
+                && r.get(iiememory_d->s_hires) && r.get(iiememory_d->s_page2)
+                && r.get(iiememory_d->s_text) && r.get(iiememory_d->s_mixed)
+                && r.get(iiememory_d->ll.FF_BANK_1) && r.get(iiememory_d->ll.FF_READ_ENABLE)
+                && r.get(iiememory_d->ll.FF_PRE_WRITE) && r.get(iiememory_d->ll._FF_WRITE_ENABLE);
+            if (!ok) return false;
+            bsr_map_memory(iiememory_d);
+            iiememory_compose_map(iiememory_d);
+            return true;
+        });
+
     computer->register_debug_display_handler(
         "iiememory",
         DH_IIEMEMORY, // unique ID for this, need to have in a header.
@@ -6,6 +6,7 @@
 #include "display/display.hpp"
 #include "mbus/KeyboardMessage.hpp"
 #include "devices/languagecard/LanguageCardLogic.hpp"
+#include "mmus/iie_map_templates.hpp"
 
 struct iiememory_state_t {
     //uint8_t switch_state;
@@ -14,6 +15,7 @@ struct iiememory_state_t {
     uint8_t *ram;
     MMU_II *mmu;
     MessageBus *mbus;
+    iie_map_templates_t *maps; // precomputed aux / BSR page maps
 
     bool f_80store = false;
     bool f_ramrd = false;
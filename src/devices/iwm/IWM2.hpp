@@ -6,6 +6,7 @@
 
 #include "devices/floppy/Floppy525_woz.hpp"
 #include "devices/floppy/Floppy35_woz.hpp"
+#include "IWM_LSS.hpp"
 
 #include "util/SoundEffectKeys.hpp"
 #include "debug.hpp"
@@ -181,6 +182,7 @@ class IWM : public StorageDevice {
             drives[1][0] = new Floppy35_woz(sound_effect, clock, event_timer,0 );
             drives[1][1] = new Floppy35_woz(sound_effect, clock, event_timer,1 );
             reset();
+            IWM_LSS::init();
 
             this->sound_effect = sound_effect;
             this->clock = clock;
@@ -224,6 +226,47 @@ class IWM : public StorageDevice {
             }
         }
 
+        // Controller registers and LSS state, then the four drives.
+        void save_state(SnapshotWriter &w) {
+            w.put(switches);
+            w.put(disk_register);
+            w.put(reg_mode);
+            w.put(reg_handshake);
+            w.put(sense_input);
+            w.put(data_register);
+            w.put(internal_data_register);
+            w.put(async_shift_reg);
+            w.put(async_bits_remaining);
+            w.put(async_buffer_register);
+            w.put(sequencer_state);
+            w.put(mark_cycles_turnoff);
+            w.put(enable_asserted);
+            for (int f = 0; f < 2; f++) {
+                drives[f][0]->save_state(w);
+                drives[f][1]->save_state(w);
+            }
+        }
+
+        bool load_state(SnapshotReader &r, std::string &err) {
+            bool ok = r.get(switches) && r.get(disk_register) && r.get(reg_mode)
+                && r.get(reg_handshake) && r.get(sense_input) && r.get(data_register)
+                && r.get(internal_data_register) && r.get(async_shift_reg)
+                && r.get(async_bits_remaining) && r.get(async_buffer_register)
+                && r.get(sequencer_state) && r.get(mark_cycles_turnoff) && r.get(enable_asserted);
+            if (!ok) return false;
+            for (int f = 0; f < 2; f++) {
+                if (!drives[f][0]->load_state(r, err) || !drives[f][1]->load_state(r, err)) return false;
+            }
+            return true;
+        }
+
+        void flush_update() {
+            drives[0][0]->flush_update();
+            drives[0][1]->flush_update();
+            drives[1][0]->flush_update();
+            drives[1][1]->flush_update();
+        }
+
         /* Floppy525_woz *get_drive_525(int index) {
             return drives_525[index];
         } */
@@ -335,34 +378,31 @@ class IWM : public StorageDevice {
             const bool latch_read = dr_enable35 && mr_latch;
             const bool async_wr   = dr_enable35 && mr_hsprotocol;
 
-            for (uint64_t i = 0; i < bits_to_sim; i++) {
-                if (iwm_q7 == 0 && iwm_q6 == 0) {
-                    // READSHIFT (mirrors OpenEmulator's SEQUENCER_READSHIFT):
-                    // while QA (bit 7) is 0, shift incoming RP bits left.
-                    // 5.25 / sync: expose partial nibbles on data_register.
-                    // 3.5 latch (L=1): accumulate in internal_data_register;
-                    // CPU-visible data_register hides MSB until valid byte.
-                    uint8_t bit = drive->read_pulse();
+            if (iwm_q7 == 0 && iwm_q6 == 0) {
+                // READSHIFT (mirrors OpenEmulator's SEQUENCER_READSHIFT):
+                // while QA (bit 7) is 0, shift incoming RP bits left.
+                // 5.25 / sync: expose partial nibbles on data_register.
+                // 3.5 latch (L=1): accumulate in internal_data_register;
+                // CPU-visible data_register hides MSB until valid byte.
+                // The mode can't change mid-call, so take the bits in bulk
+                // and clock them through the IWM_LSS tables a byte at a time.
+                while (bits_to_sim) {
+                    uint32_t n = bits_to_sim < 32 ? static_cast<uint32_t>(bits_to_sim) : 32;
+                    uint32_t bits = drive->read_bits(n);
                     if (latch_read) {
-                        internal_data_register = static_cast<uint8_t>((internal_data_register << 1) | bit);
-                        if (internal_data_register & 0x80) {
-                            data_register = internal_data_register;
-                            internal_data_register = 0;
-                        }
+                        IWM_LSS::shift_latch(internal_data_register, data_register, bits, n);
                     } else {
-                        uint8_t &shift_reg = data_register;
-                        if (shift_reg & 0x80) {
-                            if (!sequencer_state) {
-                                sequencer_state = bit;
-                            } else {
-                                sequencer_state = false;
-                                shift_reg       = static_cast<uint8_t>(0x02 | bit);
-                            }
-                        } else {
-                            shift_reg = static_cast<uint8_t>((shift_reg << 1) | bit);
-                        }
+                        uint16_t state = IWM_LSS::shift_sync(data_register | (sequencer_state ? 0x100 : 0), bits, n);
+                        data_register   = state & 0xFF;
+                        sequencer_state = (state & 0x100) != 0;
                     }
-                } else if (iwm_q7 == 0 && iwm_q6 == 1) {
+                    bits_to_sim -= n;
+                }
+                return;
+            }
+
+            for (uint64_t i = 0; i < bits_to_sim; i++) {
+                if (iwm_q7 == 0 && iwm_q6 == 1) {
                     // READLOAD (SEQUENCER_READLOAD): shift the WP-sense bit
                     // right into bit 7 of the shift register.
                     drive->read_pulse(); // advance but discard.
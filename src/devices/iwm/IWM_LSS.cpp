@@ -0,0 +1,26 @@
+#include "IWM_LSS.hpp"
+
+uint16_t IWM_LSS::sync_table[512][256];
+uint16_t IWM_LSS::latch_table[256][256];
+
+void IWM_LSS::build_tables() {
+    for (uint32_t state = 0; state < 512; state++) {
+        for (uint32_t byte = 0; byte < 256; byte++) {
+            uint16_t s = state;
+            for (int b = 7; b >= 0; b--) s = step_sync(s, (byte >> b) & 1);
+            sync_table[state][byte] = s;
+        }
+    }
+    for (uint32_t state = 0; state < 256; state++) {
+        for (uint32_t byte = 0; byte < 256; byte++) {
+            uint16_t s = state;
+            for (int b = 7; b >= 0; b--) s = step_latch(s, (byte >> b) & 1);
+            latch_table[state][byte] = s;
+        }
+    }
+}
+
+void IWM_LSS::init() {
+    static const bool tables_built = (build_tables(), true);
+    (void)tables_built;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Byte-at-a-time IWM read sequencer (READSHIFT, Q7=0 Q6=0).
+ *
+ * READSHIFT has very little state: the shift register and the QA-hold flag
+ * in sync mode, or the internal register in 3.5 latch mode. That's small
+ * enough to precompute what eight bit cells do to every state, so the read
+ * path advances the sequencer a byte per table lookup instead of a bit per
+ * loop iteration. step_sync()/step_latch() are the single-cell rules; the
+ * tables are built from them and they finish off any tail bits, so both
+ * paths produce identical results.
+ */
+class IWM_LSS {
+    public:
+        /**
+         * Sync (5.25, and 3.5 with L=0) state: data_register in bits 0-7,
+         * sequencer_state in bit 8.
+         */
+        static inline uint16_t step_sync(uint16_t state, uint32_t bit) {
+            uint8_t shift_reg = state & 0xFF;
+            if (shift_reg & 0x80) {
+                if (!(state & 0x100)) {
+                    return bit ? (state | 0x100) : state;
+                }
+                return 0x02 | bit;
+            }
+            return (state & 0x100) | static_cast<uint8_t>((shift_reg << 1) | bit);
+        }
+
+        /**
+         * Latch (3.5, L=1) state: internal_data_register in bits 0-7, the last
+         * byte latched into data_register in bits 8-15 (0 = none latched yet;
+         * a latched byte always has bit 7 set).
+         */
+        static inline uint16_t step_latch(uint16_t state, uint32_t bit) {
+            uint8_t idr = static_cast<uint8_t>((state << 1) | bit);
+            if (idr & 0x80) {
+                return static_cast<uint16_t>(idr << 8);
+            }
+            return (state & 0xFF00) | idr;
+        }
+
+        /** Clock n bit cells, first cell in bit n-1 of bits, through the sync shifter. */
+        static inline uint16_t shift_sync(uint16_t state, uint32_t bits, uint32_t n) {
+            while (n >= 8) {
+                n -= 8;
+                state = sync_table[state][(bits >> n) & 0xFF];
+            }
+            while (n) {
+                n--;
+                state = step_sync(state, (bits >> n) & 1);
+            }
+            return state;
+        }
+
+        /** Same for latch mode; data_register only changes if a byte completed. */
+        static inline void shift_latch(uint8_t &internal_data_register, uint8_t &data_register, uint32_t bits, uint32_t n) {
+            uint16_t state = internal_data_register;
+            while (n >= 8) {
+                n -= 8;
+                uint16_t next = latch_table[state & 0xFF][(bits >> n) & 0xFF];
+                state = (next & 0xFF00) ? next : ((state & 0xFF00) | next);
+            }
+            while (n) {
+                n--;
+                state = step_latch(state, (bits >> n) & 1);
+            }
+            internal_data_register = state & 0xFF;
+            if (state & 0xFF00) data_register = state >> 8;
+        }
+
+        /** Build the tables. Cheap, and only does the work once. */
+        static void init();
+
+    private:
+        static void build_tables();
+        static uint16_t sync_table[512][256];
+        static uint16_t latch_table[256][256];
+};
@@ -68,6 +68,10 @@ void init_iwm_slot(computer_t *computer, SlotType_t slot) {
             return true;
         });
 
+    computer->register_snapshot_handler(snapshot_tag("IWM "), 1,
+        [st](SnapshotWriter &w) { st->iwm->save_state(w); },
+        [st](SnapshotReader &r, std::string &err) { return st->iwm->load_state(r, err); });
+
     // Register both pairs of drives with the Mounts subsystem. The IWM
     // routes slot 6 to drives_525[] and slot 5 to drives_35[] internally.
     storage_key_t key;
@@ -88,6 +92,7 @@ void init_iwm_slot(computer_t *computer, SlotType_t slot) {
         [st]() {
             // motor off timer check. WAY easier to do here than in the drive.
             st->iwm->check_motor_off_timer();
+            st->iwm->flush_update();
 
             if (st->computer->execution_mode == EXEC_NORMAL) {
                 if (st->iwm->get_motor()) {
@@ -128,4 +128,21 @@ void init_slot_languagecard(computer_t *computer, SlotType_t slot) {
             reset_languagecard(lc);
             return true;
         });
+
+    computer->register_snapshot_handler(snapshot_tag("LC  "), 1,
+        [lc](SnapshotWriter &w) {
+            w.put(lc->ll.FF_BANK_1);
+            w.put(lc->ll.FF_READ_ENABLE);
+            w.put(lc->ll.FF_PRE_WRITE);
+            w.put(lc->ll._FF_WRITE_ENABLE);
+            w.put_memory(lc->ram_bank, 0x4000);
+        },
+        [lc](SnapshotReader &r, std::string &err) {
+            bool ok = r.get(lc->ll.FF_BANK_1) && r.get(lc->ll.FF_READ_ENABLE)
+                && r.get(lc->ll.FF_PRE_WRITE) && r.get(lc->ll._FF_WRITE_ENABLE)
+                && r.get_memory(lc->ram_bank, 0x4000);
+            if (!ok) return false;
+            set_memory_pages_based_on_flags(lc);
+            return true;
+        });
 }
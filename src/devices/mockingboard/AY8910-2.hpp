@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <deque>
@@ -8,6 +9,7 @@
 #include "util/EventTimer.hpp"
 #include "util/InterruptController.hpp"
 #include "util/AudioSystem.hpp"
+#include "util/Snapshot.hpp"
 #include "NClock.hpp"
 #include <cmath>
 
@@ -54,14 +56,14 @@ constexpr uint32_t SAMPLES_PER_FRAME_INT = 740;
 
 // Event to represent register changes with timestamps
 struct RegisterEvent {
-    double timestamp;      // Time in seconds when this event occurs
+    uint64_t cycle;        // PHI0 cycle (NClock video cycles) when this event occurs
     uint8_t chip_index;    // Which AY chip (0 or 1)
     uint8_t register_num;  // Which register (0-13)
     uint8_t value;         // New value for the register
     
     // For sorting events by timestamp
     bool operator<(const RegisterEvent& other) const {
-        return timestamp < other.timestamp;
+        return cycle < other.cycle;
     }
 };
 
@@ -109,19 +111,52 @@ static const float normalized_levels[16] = {
  class AY8910s {
     private:
         // Constants
-        static constexpr double MASTER_CLOCK = /* 1020500.0 */ 1020484.0; // 1MHz
-        static constexpr int CLOCK_DIVIDER = 16;
-        static constexpr double CHIP_FREQUENCY = MASTER_CLOCK / CLOCK_DIVIDER; // 62.5kHz
+        // The AY is clocked from the Apple's PHI0 (~1.02MHz); these divide that down.
+        static constexpr int CLOCK_DIVIDER = 16;            // chip clock, ~63.8kHz
         static constexpr int ENVELOPE_CLOCK_DIVIDER = 256;  // First stage divider for envelope
+        static constexpr int ENVELOPE_PRESCALE = ENVELOPE_CLOCK_DIVIDER / CLOCK_DIVIDER; // chip clocks per envelope clock
+        static constexpr float ENVELOPE_INTERPOLATION_SPEED = 0.0003f;  // Our known good value for the test case
         static constexpr float FILTER_CUTOFF = 0.3f; // Filter coefficient (0-1) (lower is more aggressive)
+        static constexpr size_t MAX_PENDING_EVENTS = 4096;  // writes waiting for synthesis to reach them
         
+        // State for each tone channel (3 per chip, 2 chips)
+        struct ToneChannel {
+            uint16_t period;     // Tone period (12 bits, 0-4095)
+            uint16_t counter;    // Current counter value
+            bool output;         // Current output state
+            float volume;        // Volume (0-1)
+            bool use_envelope;   // Whether to use envelope generator
+        };
+        
+        // State for each chip
+        struct AY3_8910 {
+            ToneChannel tone_channels[3];
+            uint16_t noise_period;
+            uint16_t noise_counter;
+            uint32_t noise_rng;
+            bool noise_output;    // Add noise output state
+            uint8_t mixer_control;
+            uint16_t envelope_period;  // Changed to 16-bit
+            uint8_t envelope_shape;
+            uint16_t envelope_counter;  // Changed to 16-bit to handle larger counts at master clock rate
+            uint16_t envelope_prescale; // chip clocks until the next envelope clock
+            uint8_t envelope_output;   // Current envelope value (0-15) integer.
+            bool envelope_hold;        // Whether envelope is holding
+            bool envelope_attack;      // Whether envelope is in attack phase
+            float current_envelope_level;  // Interpolated envelope level
+            float target_envelope_level;   // Target level we're interpolating towards
+            float interpolation_speed;     // per-sample step toward target, from envelope_period
+            uint8_t registers[AY_8913_REGISTER_COUNT];  // register states during playback
+            uint8_t live_registers[AY_8913_REGISTER_COUNT];  // Live register values as the 6502 sees them
+        };
+
         float get_volume(uint8_t volsetting) {
             return normalized_levels[volsetting]; /*  * 0.25f */;
         }
 
     public:
         AY8910s(std::vector<float>* buffer, EventTimer *event_timer,  NClock *clock, AudioSystem *audio_system /* , InterruptController *irq_control, uint8_t slot */) 
-            : current_time(0.0), time_accumulator(0.0), envelope_time_accumulator(0.0), audio_buffer(buffer), audio_system(audio_system) {
+            : cycles_per_second(clock->get_vid_cycles_per_second()), audio_buffer(buffer), audio_system(audio_system) {
             // Initialize per-chip bus address latch to "invalid / no register
             // selected" so writes without a preceding LATCH are ignored
             // (matches AY8913 power-on/reset behavior; audited by mb-audit
@@ -158,9 +193,12 @@ static const float normalized_levels[16] = {
                 chips[c].envelope_output = 0;
                 chips[c].envelope_hold = false;
                 chips[c].envelope_attack = false;
+                chips[c].envelope_prescale = ENVELOPE_PRESCALE;
                 chips[c].current_envelope_level = 0.0f;
                 chips[c].target_envelope_level = 0.0f;
+                chips[c].interpolation_speed = ENVELOPE_INTERPOLATION_SPEED;
             }
+            resync(clock->get_vid_cycles());
             for (int i = 0; i < 7; i++) {
                 filters[i].last_sample = 0.0f;
             }
@@ -207,7 +245,7 @@ static const float normalized_levels[16] = {
         //
         // Returns { drove_data=true, data } on read cycles so the board
         // can latch the byte into the matching VIA IRA.
-        AyBusResult busCycle(uint8_t chip_index, uint8_t pa, uint8_t pb, double time_seconds) {
+        AyBusResult busCycle(uint8_t chip_index, uint8_t pa, uint8_t pb, uint64_t cycle) {
             if (chip_index > 1) return { false, 0 };
 
             // ~RESET asserted: zero all 16 registers at this timestamp and
@@ -216,7 +254,7 @@ static const float normalized_levels[16] = {
             // (no data driven onto Port A).
             if ((pb & 0b100) == 0) {
                 for (uint8_t r = 0; r < AY_8913_REGISTER_COUNT; r++) {
-                    queueRegisterChange(time_seconds, chip_index, r, 0);
+                    queueRegisterChange(cycle, chip_index, r, 0);
                 }
                 reg_num[chip_index] = 0xFF;
                 return { false, 0 };
@@ -234,8 +272,8 @@ static const float normalized_levels[16] = {
                     return { false, 0 };
                 case 0b10: // write
                     if (reg_num[chip_index] < AY_8913_REGISTER_COUNT) {
-                        queueRegisterChange(time_seconds, chip_index, reg_num[chip_index], pa);
-                        if (DEBUG(DEBUG_MOCKINGBOARD)) printf("AY busCycle: write [%lf] chip %u reg %02x val %02x\n", time_seconds, chip_index, reg_num[chip_index], pa);
+                        queueRegisterChange(cycle, chip_index, reg_num[chip_index], pa);
+                        if (DEBUG(DEBUG_MOCKINGBOARD)) printf("AY busCycle: write [%llu] chip %u reg %02x val %02x\n", (unsigned long long)cycle, chip_index, reg_num[chip_index], pa);
                     } else {
                         if (DEBUG(DEBUG_MOCKINGBOARD)) printf("AY busCycle: write ignored (unlatched) chip %u latch=%02x val %02x\n", chip_index, reg_num[chip_index], pa);
                     }
@@ -259,13 +297,20 @@ static const float normalized_levels[16] = {
         }
     
         // Add a register change event
-        void queueRegisterChange(double timestamp, uint8_t chip_index, uint8_t reg, uint8_t value) {
+        void queueRegisterChange(uint64_t cycle, uint8_t chip_index, uint8_t reg, uint8_t value) {
             RegisterEvent event;
-            event.timestamp = timestamp;
+            event.cycle = cycle;
             event.chip_index = chip_index;
             event.register_num = reg;
             event.value = value;
 
+            // Nothing should queue this many writes in one frame; if something
+            // does (or synthesis has stalled), apply the oldest now rather than
+            // grow without bound.
+            if (pending_events.size() >= MAX_PENDING_EVENTS) {
+                processRegisterChange(pending_events.front());
+                pending_events.pop_front();
+            }
             pending_events.push_back(event);
             // Keep events sorted by timestamp
             //std::sort(pending_events.begin(), pending_events.end()); // TODO: say what now?
@@ -274,11 +319,11 @@ static const float normalized_levels[16] = {
             chip.live_registers[event.register_num] = event.value;
     
             // for debugging, store the timestamp of event and current emulated time.
-            dbg_last_event = event.timestamp;
-            dbg_last_time = current_time;
+            dbg_last_event = event.cycle;
+            dbg_last_time = current_cycle;
     
-            if (dbg_last_event < current_time) {
-                printf("[Current Time: %12.6f] Event timestamp is in the past: %12.6f\n", current_time, dbg_last_event);
+            if (dbg_last_event < current_cycle) {
+                printf("[Current Cycle: %llu] Event timestamp is in the past: %llu\n", (unsigned long long)current_cycle, (unsigned long long)dbg_last_event);
             }
         }
         
@@ -291,7 +336,7 @@ static const float normalized_levels[16] = {
             AY3_8910& chip = chips[event.chip_index];
             chip.registers[event.register_num] = event.value;
             
-            //debug_register_change(current_time, event.chip_index, event.register_num, event.value);
+            //debug_register_change(current_cycle, event.chip_index, event.register_num, event.value);
             if (DEBUG(DEBUG_MOCKINGBOARD)) display_registers();
             
             // Update internal state based on register change
@@ -325,10 +370,12 @@ static const float normalized_levels[16] = {
                     
                 case Envelope_Period_Low: // Envelope period low bits
                     chip.envelope_period = (chip.envelope_period & 0xFF00) | event.value;
+                    setInterpolationSpeed(chip);
                     break;
                     
                 case Envelope_Period_High: // Envelope period high bits
                     chip.envelope_period = (chip.envelope_period & 0x00FF) | (event.value << 8);
+                    setInterpolationSpeed(chip);
                     break;
                     
                 case Envelope_Shape: // Envelope shape
@@ -371,277 +418,369 @@ static const float normalized_levels[16] = {
             }
         }
         
-        // Process a single chip clock cycle
-        void processChipCycle(double cycle_time) {
-            // Process any pending register changes that should happen by this time
-            while (!pending_events.empty() && pending_events.front().timestamp <= cycle_time) {
-                processRegisterChange(pending_events.front());
-                pending_events.pop_front();
-            }
-            
-            // Process both chips
-            for (int c = 0; c < 2; c++) {
-                AY3_8910& chip = chips[c];
-#if 1                
-                // Process tone generators
-                for (int i = 0; i < 3; i++) {
-                    ToneChannel& channel = chip.tone_channels[i];
-
-                    // If period is 0 (e.g. right after reset, before the CPU
-                    // has programmed the tone period), do NOT toggle every
-                    // cycle. Toggling at chip_freq while the two chips wait
-                    // for period-register writes to arrive at slightly
-                    // different times would desynchronize them by a large,
-                    // random phase offset on startup.
-                    if (channel.period == 0) {
-                        continue;
-                    }
+        // One chip clock (PHI0 / 16): step the tone and noise generators, and
+        // every ENVELOPE_PRESCALE chip clocks, the envelope.
+        void tickChip(AY3_8910& chip) {
+            for (int i = 0; i < 3; i++) {
+                ToneChannel& channel = chip.tone_channels[i];
 
-                    if (channel.counter > 0) {
-                        channel.counter--;
-                        // Check for half period
-                        if (channel.counter == channel.period / 2) {
-                            channel.output = !channel.output;
-                        }
-                    } else {
-                        // Reset counter and toggle output
-                        channel.counter = channel.period;
+                // If period is 0 (e.g. right after reset, before the CPU
+                // has programmed the tone period), do NOT toggle every
+                // cycle. Toggling at chip_freq while the two chips wait
+                // for period-register writes to arrive at slightly
+                // different times would desynchronize them by a large,
+                // random phase offset on startup.
+                if (channel.period == 0) {
+                    continue;
+                }
+
+                if (channel.counter > 0) {
+                    channel.counter--;
+                    // Check for half period
+                    if (channel.counter == channel.period / 2) {
                         channel.output = !channel.output;
                     }
+                } else {
+                    // Reset counter and toggle output
+                    channel.counter = channel.period;
+                    channel.output = !channel.output;
                 }
-#endif            
-#if 0    
-                for (int i = 0; i < 3; i++) {
-                    ToneChannel& ch = chip.tone_channels[i];
-                    ch.counter++;
-                    if (ch.counter >= ch.period/2) {
-                        ch.counter = 0;
-                        ch.output = !ch.output;
+            }
+
+            // Process noise generator (simplified)
+            chip.noise_counter--;
+            if (chip.noise_counter <= 0) {
+                chip.noise_counter = chip.noise_period;
+                stepNoise(chip);
+            }
+
+            if (--chip.envelope_prescale == 0) {
+                chip.envelope_prescale = ENVELOPE_PRESCALE;
+                tickEnvelope(chip);
+            }
+        }
+
+        void stepNoise(AY3_8910& chip) {
+            // Update noise RNG (simplified LFSR)
+            uint32_t bit0 = chip.noise_rng & 1;
+            uint32_t bit3 = (chip.noise_rng >> 3) & 1;
+            uint32_t new_bit = bit0 ^ bit3;
+            chip.noise_rng = (chip.noise_rng >> 1) | (new_bit << 16);
+            chip.noise_output = (chip.noise_rng & 1) != 0;  // Use LSB of RNG as noise output
+        }
+
+        // Chip clocks until the next one that can change what the chip outputs
+        // right now: a tone flip, or a noise shift if any channel mixes noise in.
+        // Envelope clocks only move the target level, which is picked up per
+        // sample, so they aren't edges. Always >= 1.
+        uint32_t ticksToEdge(const AY3_8910& chip) const {
+            uint32_t ticks = UINT32_MAX;
+            if ((chip.mixer_control & 0x38) != 0x38) ticks = chip.noise_counter;
+            for (int i = 0; i < 3; i++) {
+                const ToneChannel& channel = chip.tone_channels[i];
+                if (channel.period == 0) continue;
+                uint32_t half = channel.period / 2;
+                uint32_t t;
+                if (channel.counter == 0) t = 1;                               // reload + flip
+                else if (half < channel.counter) t = channel.counter - half;   // counts down to the half-period flip
+                else t = channel.counter + 1;                                  // counts down to 0, then reload + flip
+                if (t < ticks) ticks = t;
+            }
+            return ticks;
+        }
+
+        // Run n chip clocks in one go. Only valid for n < ticksToEdge(chip): no tone
+        // flips on the way, and noise shifts only if nothing is listening to them.
+        void skipChip(AY3_8910& chip, uint32_t n) {
+            for (int i = 0; i < 3; i++) {
+                if (chip.tone_channels[i].period != 0) chip.tone_channels[i].counter -= n;
+            }
+            uint32_t k = n;
+            while (k >= chip.noise_counter) {
+                k -= chip.noise_counter;
+                chip.noise_counter = chip.noise_period;
+                stepNoise(chip);
+            }
+            chip.noise_counter -= k;
+            k = n;
+            while (k >= chip.envelope_prescale) {
+                k -= chip.envelope_prescale;
+                chip.envelope_prescale = ENVELOPE_PRESCALE;
+                tickEnvelope(chip);
+            }
+            chip.envelope_prescale -= k;
+        }
+
+        // Envelope generator, clocked at PHI0 / 256.
+        void tickEnvelope(AY3_8910& chip) {
+            if (chip.envelope_period == 0) {
+                return;
+            }
+            // Update envelope counter at the correct rate
+            chip.envelope_counter++;
+            if (chip.envelope_counter < (chip.envelope_period / 16)) {
+                return;
+            }
+            chip.envelope_counter = 0;
+                
+            // Extract control bits
+            bool hold = (chip.envelope_shape & 0x01) != 0;      // Bit 0 (inverted in hardware)
+            bool alternate = (chip.envelope_shape & 0x02) != 0; // Bit 1
+            bool attack = (chip.envelope_shape & 0x04) != 0;    // Bit 2
+            bool cont = (chip.envelope_shape & 0x08) != 0;      // Bit 3
+                
+            // State machine logic
+            if (chip.envelope_hold) {
+                // Do nothing when in hold state
+                return;
+            }
+                
+            if (chip.envelope_attack) {
+                // In attack (rising) phase
+                if (chip.envelope_output < 15) {
+                    // Still rising
+                    chip.envelope_output++;
+                    chip.target_envelope_level = get_volume(chip.envelope_output);
+                } else {
+                    // Reached peak, determine next state
+                    // If continue and hold are both set, determine held value by (attack XOR alternate)
+                    if (cont && hold) {
+                        bool held_at_15 = attack != alternate; // XOR operation
+                        chip.envelope_output = held_at_15 ? 15 : 0;
+                        chip.target_envelope_level = get_volume(chip.envelope_output);
+                        chip.envelope_hold = true;
+                    }
+                    // Regular processing for other cases
+                    else if (hold) {
+                        chip.envelope_hold = true;
+                    } else if (!cont) {
+                        chip.envelope_output = 0;
+                        chip.target_envelope_level = 0;
+                        chip.envelope_hold = true;
+                    } else if (alternate) {
+                        chip.envelope_attack = false; // Switch to decay
+                    } else {
+                        // Reset to start of phase
+                        chip.envelope_output = attack ? 0 : 15;
+                        chip.target_envelope_level = get_volume(chip.envelope_output);
                     }
                 }
-#endif
-                // Process noise generator (simplified)
-                chip.noise_counter--;
-                if (chip.noise_counter <= 0) {
-                    chip.noise_counter = chip.noise_period;
-                    
-                    // Update noise RNG (simplified LFSR)
-                    uint32_t bit0 = chip.noise_rng & 1;
-                    uint32_t bit3 = (chip.noise_rng >> 3) & 1;
-                    uint32_t new_bit = bit0 ^ bit3;
-                    chip.noise_rng = (chip.noise_rng >> 1) | (new_bit << 16);
-                    chip.noise_output = (chip.noise_rng & 1) != 0;  // Use LSB of RNG as noise output
+            } else {
+                // In decay (falling) phase
+                if (chip.envelope_output > 0) {
+                    // Still falling
+                    chip.envelope_output--;
+                    chip.target_envelope_level = get_volume(chip.envelope_output);
+                } else {
+                    // Reached zero, determine next state
+                    // If continue and hold are both set, determine held value by (attack XOR alternate)
+                    if (cont && hold) {
+                        bool held_at_15 = attack != alternate; // XOR operation
+                        chip.envelope_output = held_at_15 ? 15 : 0;
+                        chip.target_envelope_level = get_volume(chip.envelope_output);
+                        chip.envelope_hold = true;
+                    }
+                    // Regular processing for other cases
+                    else if (hold) {
+                        chip.envelope_hold = true;
+                    } else if (!cont) {
+                        chip.envelope_hold = true;
+                    } else if (alternate) {
+                        chip.envelope_attack = true; // Switch to attack
+                    } else {
+                        // Reset to start of phase
+                        chip.envelope_output = attack ? 0 : 15;
+                        chip.target_envelope_level = get_volume(chip.envelope_output);
+                    }
                 }
             }
         }
-        
-        // Process envelope generator at correct rate
-        void processEnvelope(double time_step) {
-            for (int c = 0; c < 2; c++) {
-                AY3_8910& chip = chips[c];
-                
-                if (chip.envelope_period > 0) {
-                    // Update envelope counter at the correct rate
-                    chip.envelope_counter++;
-                    if (chip.envelope_counter >= (chip.envelope_period / 16)) {
-                        chip.envelope_counter = 0;
-                        
-                        // Extract control bits
-                        bool hold = (chip.envelope_shape & 0x01) != 0;      // Bit 0 (inverted in hardware)
-                        bool alternate = (chip.envelope_shape & 0x02) != 0; // Bit 1
-                        bool attack = (chip.envelope_shape & 0x04) != 0;    // Bit 2
-                        bool cont = (chip.envelope_shape & 0x08) != 0;      // Bit 3
-                        
-                        // State machine logic
-                        if (chip.envelope_hold) {
-                            // Do nothing when in hold state
-                            return;
-                        }
-                        
-                        if (chip.envelope_attack) {
-                            // In attack (rising) phase
-                            if (chip.envelope_output < 15) {
-                                // Still rising
-                                chip.envelope_output++;
-                                chip.target_envelope_level = get_volume(chip.envelope_output);
-                            } else {
-                                // Reached peak, determine next state
-                                // If continue and hold are both set, determine held value by (attack XOR alternate)
-                                if (cont && hold) {
-                                    bool held_at_15 = attack != alternate; // XOR operation
-                                    chip.envelope_output = held_at_15 ? 15 : 0;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                    chip.envelope_hold = true;
-                                }
-                                // Regular processing for other cases
-                                else if (hold) {
-                                    chip.envelope_hold = true;
-                                } else if (!cont) {
-                                    chip.envelope_output = 0;
-                                    chip.target_envelope_level = 0;
-                                    chip.envelope_hold = true;
-                                } else if (alternate) {
-                                    chip.envelope_attack = false; // Switch to decay
-                                } else {
-                                    // Reset to start of phase
-                                    chip.envelope_output = attack ? 0 : 15;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                }
-                            }
-                        } else {
-                            // In decay (falling) phase
-                            if (chip.envelope_output > 0) {
-                                // Still falling
-                                chip.envelope_output--;
-                                chip.target_envelope_level = get_volume(chip.envelope_output);
-                            } else {
-                                // Reached zero, determine next state
-                                // If continue and hold are both set, determine held value by (attack XOR alternate)
-                                if (cont && hold) {
-                                    bool held_at_15 = attack != alternate; // XOR operation
-                                    chip.envelope_output = held_at_15 ? 15 : 0;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                    chip.envelope_hold = true;
-                                }
-                                // Regular processing for other cases
-                                else if (hold) {
-                                    chip.envelope_hold = true;
-                                } else if (!cont) {
-                                    chip.envelope_hold = true;
-                                } else if (alternate) {
-                                    chip.envelope_attack = true; // Switch to attack
-                                } else {
-                                    // Reset to start of phase
-                                    chip.envelope_output = attack ? 0 : 15;
-                                    chip.target_envelope_level = get_volume(chip.envelope_output);
-                                }
-                            }
-                        }
-                    }
+
+        // Base the interpolation speed on the envelope period
+        // Shorter periods need faster interpolation
+        void setInterpolationSpeed(AY3_8910& chip) {
+            float period_factor = 1.0f;
+            if (chip.envelope_period > 0) {
+                // Scale interpolation speed inversely with period
+                // The larger the period, the slower the interpolation should be
+                period_factor = static_cast<float>(0x3000) / chip.envelope_period;  // 0x3000 is a reference period
+            }
+            chip.interpolation_speed = ENVELOPE_INTERPOLATION_SPEED * period_factor;
+        }
+
+        // Do envelope interpolation at audio rate. This makes changes to envelope levels transition smoothly on a per-sample basis.
+        void interpolateEnvelope(AY3_8910& chip) {
+            chip.current_envelope_level += (chip.target_envelope_level - chip.current_envelope_level) * chip.interpolation_speed;
+            
+            // Update channel volumes with interpolated value
+            for (int i = 0; i < 3; i++) {
+                if (chip.tone_channels[i].use_envelope) {
+                    chip.tone_channels[i].volume = chip.current_envelope_level; // target_envelope_level is already normalized to 0-1
                 }
             }
         }
-        
-        // Generate audio samples at 44.1kHz
-        void generateSamples(int num_samples) {
+
+        // Sum of the chip's three channels with the generators as they are right now.
+        float chipOutput(const AY3_8910& chip) const {
+            float output = 0.0f;
+            for (int channel = 0; channel < 3; channel++) {
+                const ToneChannel& tone = chip.tone_channels[channel];
+                bool tone_enabled = !(chip.mixer_control & (1 << channel));
+                bool noise_enabled = !(chip.mixer_control & (1 << (channel + 3)));
+
+                // Only process if the channel has volume
+                // If either tone or noise is enabled for this channel
+                bool is_tone = tone_enabled && tone.period > 0 && (chip.registers[Ampl_A + channel] > 0);
+                bool is_noise = noise_enabled;
+
+                // For tone / noise: true = +volume, false = 0. If both are enabled they add.
+                if (is_tone && tone.output) output += tone.volume;
+                if (is_noise && chip.noise_output) output += tone.volume;
+            }
+            return output;
+        }
+
+        // Start the synthesis clock over at cycle, e.g. after single-stepping left a long gap.
+        // Queued writes are all from before the discontinuity, so apply them now.
+        void resync(uint64_t cycle) {
+            while (!pending_events.empty()) {
+                processRegisterChange(pending_events.front());
+                pending_events.pop_front();
+            }
+            current_cycle = cycle;
+            next_tick_cycle = cycle;
+            sample_end_cycle = cycle + cycles_per_second / OUTPUT_SAMPLE_RATE_INT;
+            sample_end_frac = cycles_per_second % OUTPUT_SAMPLE_RATE_INT;
+            ticks_to_edge = 1;
+        }
+
+        // Chip state, synthesis position and not-yet-synthesized writes. All
+        // times are video cycles, so they line up with the restored NClock.
+        void save_state(SnapshotWriter &w) {
+            w.put(chips);
+            w.put(reg_num);
+            w.put(filters);
+            w.put(r_delay_buf);
+            w.put(r_delay_idx);
+            w.put(current_cycle);
+            w.put(next_tick_cycle);
+            w.put(ticks_to_edge);
+            w.put(sample_end_cycle);
+            w.put(sample_end_frac);
+            w.put<uint32_t>((uint32_t)pending_events.size());
+            for (const RegisterEvent &e : pending_events) w.put(e);
+        }
+
+        bool load_state(SnapshotReader &r) {
+            uint32_t count = 0;
+            bool ok = r.get(chips) && r.get(reg_num) && r.get(filters)
+                && r.get(r_delay_buf) && r.get(r_delay_idx)
+                && r.get(current_cycle) && r.get(next_tick_cycle) && r.get(ticks_to_edge)
+                && r.get(sample_end_cycle) && r.get(sample_end_frac) && r.get(count);
+            if (!ok || count > MAX_PENDING_EVENTS || r_delay_idx >= MONO_DECORR_DELAY) return false;
+            pending_events.clear();
+            for (uint32_t i = 0; i < count; i++) {
+                RegisterEvent e;
+                if (!r.get(e)) return false;
+                pending_events.push_back(e);
+            }
+            return true;
+        }
+
+        // Where synthesis has got to. Stands in for the clock when the clock isn't advancing it.
+        uint64_t synth_cycle() const { return current_cycle; }
+
+        // PHI0 cycles spanned by samples output samples.
+        uint64_t cycles_for_samples(uint32_t samples) const {
+            return cycles_per_second * samples / OUTPUT_SAMPLE_RATE_INT;
+        }
+
+        /**
+         * Generate 44.1kHz stereo samples for everything up to end_cycle.
+         *
+         * Time is kept in PHI0 cycles (NClock video cycles), the clock the AY
+         * is actually driven from: a chip clock every 16 cycles, an envelope
+         * clock every 256. Sample boundaries step by PHI0 / 44100 cycles with
+         * the remainder carried exactly, so there is no drift against NClock.
+         *
+         * Within a sample we jump from edge to edge (a tone flip, a noise
+         * shift, an envelope clock, or a register write) instead of stepping
+         * every chip clock, and the output is the time-weighted average of the
+         * levels in between. That box filter is a cheap band limit on the
+         * square waves: a step landing mid-sample lands as a partial value
+         * instead of aliasing to the nearest sample.
+         */
+        void generateSamples(uint64_t end_cycle) {
             if (!audio_buffer) {
                 return;  // No buffer to write to
             }
-            
-            // Debug output for envelope level at start of each call
-            if (0 && DEBUG(DEBUG_MOCKINGBOARD)) std::cout << "[" << current_time << "] Envelope status - Level: " << static_cast<int>(chips[0].envelope_output) 
-                      << " (counter: " << static_cast<int>(chips[0].envelope_counter) 
-                      << "/" << static_cast<int>(chips[0].envelope_period) 
-                      << ", shape: " << static_cast<int>(chips[0].envelope_shape)
-                      << ", attack: " << (chips[0].envelope_attack ? "true" : "false")
-                      << ", hold: " << (chips[0].envelope_hold ? "true" : "false")
-                      << ")" << std::endl;
-            
-            const double output_time_step = 1.0f / OUTPUT_SAMPLE_RATE_INT;
-            const double chip_time_step = 1.0 / CHIP_FREQUENCY;
-            const double envelope_base_frequency = MASTER_CLOCK / ENVELOPE_CLOCK_DIVIDER;
-            const double envelope_base_time_step = 1.0 / envelope_base_frequency;
-            
-            for (int i = 0; i < num_samples; i++) {
-                // Track current time based on the sample index and output time step
-                double sample_time = current_time + (i * output_time_step);
-                time_accumulator += output_time_step;
-                envelope_time_accumulator += output_time_step;
-                
-                // Process all chip cycles that should occur during this output sample
-                while (time_accumulator >= chip_time_step) {
-                    double cycle_time = sample_time - time_accumulator;
-                    processChipCycle(cycle_time);
-                    time_accumulator -= chip_time_step;
-                }
-                
-                // Process envelope at the correct rate (master_clock / 256)
-                while (envelope_time_accumulator >= envelope_base_time_step) {
-                    processEnvelope(envelope_base_time_step);
-                    envelope_time_accumulator -= envelope_base_time_step;
-                }
-                
-                // Do envelope interpolation at audio rate. This makes changes to envelope levels transition smoothly on a per-sample basis.
+            if (end_cycle < current_cycle || end_cycle - current_cycle > cycles_per_second / 4) {
+                resync(end_cycle);
+                return;
+            }
+
+            float level[2] = { chipOutput(chips[0]), chipOutput(chips[1]) };
+
+            while (sample_end_cycle <= end_cycle) {
+                uint64_t sample_start = current_cycle;
+                uint64_t sample_end = sample_end_cycle;
+
                 for (int c = 0; c < 2; c++) {
-                    AY3_8910& chip = chips[c];
-                    
-                    // Base the interpolation speed on the envelope period
-                    // Shorter periods need faster interpolation
-                    float base_speed = 0.0003f;  // Our known good value for the test case
-                    float period_factor = 1.0f;
-                    if (chip.envelope_period > 0) {
-                        // Scale interpolation speed inversely with period
-                        // The larger the period, the slower the interpolation should be
-                        period_factor = static_cast<float>(0x3000) / chip.envelope_period;  // 0x3000 is a reference period
-                    }
-                    float interpolation_speed = base_speed * period_factor;
-                    
-                    chip.current_envelope_level += (chip.target_envelope_level - chip.current_envelope_level) * interpolation_speed;
-                    
-                    // Update channel volumes with interpolated value
-                    for (int i = 0; i < 3; i++) {
-                        if (chip.tone_channels[i].use_envelope) {
-                            // Keep as float, divide by 15 here to normalize to 0-1 range
-                            chip.tone_channels[i].volume = chip.current_envelope_level; // target_envelope_level is already normalized to 0-1
-                        }
-                    }
+                    interpolateEnvelope(chips[c]);
+                    level[c] = chipOutput(chips[c]);
                 }
-                
-                // Mix output from 3 channels of each chip separately.
+
                 float mixed_output[2] = {0.0f, 0.0f};
-    
-                for (int c = 0; c < 2; c++) {
-    
-                    const AY3_8910& chip = chips[c];
-#if 0
-                    for (int channel = 0; channel < 3; channel++) {
-                        const ToneChannel& tone = chip.tone_channels[channel];
-                        bool tone_dis  = (chip.mixer_control >> channel) & 1;       // 1 = disabled
-                        bool noise_dis = (chip.mixer_control >> (channel + 3)) & 1; // 1 = disabled
-                    
-                        bool tone_gate  = tone.output  || tone_dis;   // disabled = forced open
-                        bool noise_gate = chip.noise_output || noise_dis;
-                    
-                        bool gate = tone_gate && noise_gate;           // AND logic
-                    
-                        float channel_output = gate ? tone.volume : 0.0f;
-                        mixed_output[c] += channel_output;
+                while (current_cycle < sample_end) {
+                    uint64_t t = next_tick_cycle + (uint64_t)(ticks_to_edge - 1) * CLOCK_DIVIDER;
+                    if (sample_end < t) t = sample_end;
+                    if (!pending_events.empty() && pending_events.front().cycle < t) {
+                        t = std::max(pending_events.front().cycle, current_cycle);
                     }
-#endif
-#if 1
-                    for (int channel = 0; channel < 3; channel++) {
-                        const ToneChannel& tone = chip.tone_channels[channel];
-                        bool tone_enabled = !(chip.mixer_control & (1 << channel));
-                        bool noise_enabled = !(chip.mixer_control & (1 << (channel + 3)));
-    
-                        // Only process if the channel has volume
-                        // If either tone or noise is enabled for this channel
-                        bool is_tone = tone_enabled && tone.period > 0 && (chip.registers[Ampl_A + channel] > 0);
-                        bool is_noise = noise_enabled;
-    
-                        if (is_tone || is_noise) {
-                            // For tone: true = +volume, false = -volume
-                            float tone_contribution = tone.output ? tone.volume : 0 /* -tone.volume */;
-                            
-                            // For noise: true = +volume, false = -volume
-                            float noise_contribution = (chip.noise_output ? tone.volume : 0 /* -tone.volume */) /* * 0.6f */;
-                            float channel_output;
-    
-                            // If both are enabled, average them
-                            if (is_tone && is_noise) {
-                                channel_output = (tone_contribution + noise_contribution) /* * 0.5f */;
-                            } else if (is_tone) {
-                                channel_output = tone_contribution;
-                            } else if (is_noise) {
-                                channel_output = noise_contribution;
-                            }
-                            //channel_output = applyLowPassFilter(channel_output, c, channel);
-                            mixed_output[c] += channel_output;
-                        }
+
+                    mixed_output[0] += level[0] * (float)(t - current_cycle);
+                    mixed_output[1] += level[1] * (float)(t - current_cycle);
+                    current_cycle = t;
+
+                    // chip clocks before now can't flip anything (we stopped at or before the edge).
+                    if (next_tick_cycle < current_cycle) {
+                        uint32_t n = (uint32_t)((current_cycle - next_tick_cycle + CLOCK_DIVIDER - 1) / CLOCK_DIVIDER);
+                        skipChip(chips[0], n);
+                        skipChip(chips[1], n);
+                        next_tick_cycle += (uint64_t)n * CLOCK_DIVIDER;
+                        ticks_to_edge -= n;
                     }
-#endif
-                    
+
+                    // register writes land before a chip clock at the same cycle.
+                    bool changed = false;
+                    while (!pending_events.empty() && pending_events.front().cycle <= current_cycle) {
+                        processRegisterChange(pending_events.front());
+                        pending_events.pop_front();
+                        changed = true;
+                    }
+                    if (next_tick_cycle == current_cycle) {
+                        tickChip(chips[0]);
+                        tickChip(chips[1]);
+                        next_tick_cycle += CLOCK_DIVIDER;
+                        changed = true;
+                    }
+                    if (changed) {
+                        ticks_to_edge = std::min(ticksToEdge(chips[0]), ticksToEdge(chips[1]));
+                        level[0] = chipOutput(chips[0]);
+                        level[1] = chipOutput(chips[1]);
+                    }
+                }
+                sample_end_cycle += cycles_per_second / OUTPUT_SAMPLE_RATE_INT;
+                sample_end_frac += cycles_per_second % OUTPUT_SAMPLE_RATE_INT;
+                if (sample_end_frac >= OUTPUT_SAMPLE_RATE_INT) {
+                    sample_end_cycle++;
+                    sample_end_frac -= OUTPUT_SAMPLE_RATE_INT;
                 }
+
+                float scale = 1.0f / (float)(sample_end - sample_start);
+                mixed_output[0] *= scale;
+                mixed_output[1] *= scale;
+
                 // TODO: add checks here to detect overdriving/exceeding -1.0/1.0.
                 // Append the mixed samples to the buffer.
                 //
@@ -668,9 +807,6 @@ static const float normalized_levels[16] = {
                     audio_buffer->push_back(mixed_output[1]);
                 }
             }
-            
-            // Update current_time for the next call
-            current_time += num_samples * output_time_step;
         }
         
         // Write audio samples to a WAV file
@@ -769,46 +905,20 @@ static const float normalized_levels[16] = {
         // Filter state
         filter_state filters[7] = {0.0f}; // One state per channel, and one for the mixed output
         
-        // State for each tone channel (3 per chip, 2 chips)
-        struct ToneChannel {
-            uint16_t period;     // Tone period (12 bits, 0-4095)
-            uint16_t counter;    // Current counter value
-            bool output;         // Current output state
-            float volume;        // Volume (0-1)
-            bool use_envelope;   // Whether to use envelope generator
-        };
-        
-        // State for each chip
-        struct AY3_8910 {
-            ToneChannel tone_channels[3];
-            uint16_t noise_period;
-            uint16_t noise_counter;
-            uint32_t noise_rng;
-            bool noise_output;    // Add noise output state
-            uint8_t mixer_control;
-            uint16_t envelope_period;  // Changed to 16-bit
-            uint8_t envelope_shape;
-            uint16_t envelope_counter;  // Changed to 16-bit to handle larger counts at master clock rate
-            uint8_t envelope_output;   // Current envelope value (0-15) integer.
-            bool envelope_hold;        // Whether envelope is holding
-            bool envelope_attack;      // Whether envelope is in attack phase
-            float current_envelope_level;  // Interpolated envelope level
-            float target_envelope_level;   // Target level we're interpolating towards
-            uint8_t registers[AY_8913_REGISTER_COUNT];  // register states during playback
-            uint8_t live_registers[AY_8913_REGISTER_COUNT];  // Live register values as the 6502 sees them
-        };
-        
         // Emulator state
     public:
         AY3_8910 chips[2];
     
-        double dbg_last_event =0.0f;
-        double dbg_last_time =0.0f;
+        uint64_t dbg_last_event = 0;
+        uint64_t dbg_last_time = 0;
 
     private:
-        double current_time;
-        double time_accumulator;
-        double envelope_time_accumulator;  // New accumulator for envelope timing
+        uint64_t cycles_per_second;     // PHI0 rate, from NClock
+        uint64_t current_cycle = 0;     // synthesized up to here
+        uint64_t next_tick_cycle = 0;   // next chip clock
+        uint32_t ticks_to_edge = 1;     // chip clocks from next_tick_cycle to the next one that changes the output
+        uint64_t sample_end_cycle = 0;  // where the next output sample ends
+        uint32_t sample_end_frac = 0;   // sample_end_cycle's fraction, in 1/44100ths of a cycle
         std::deque<RegisterEvent> pending_events;
         std::vector<float>* audio_buffer;  // Pointer to external audio buffer
         AudioSystem *audio_system = nullptr;  // Shared audio settings (decorrelation, etc.)
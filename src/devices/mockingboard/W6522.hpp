@@ -23,6 +23,7 @@
 #include "debug.hpp"
 #include "util/DebugFormatter.hpp"
 #include "util/InterruptController.hpp"
+#include "util/Snapshot.hpp"
 #include "regs.hpp"
 
 #define MB_6522_1 0x00
@@ -515,6 +516,43 @@ public:
         update_interrupt(); // this reads the slot number and does the right IRQ thing.
     }
 
+    void save_state(SnapshotWriter &w) {
+        w.put(ora);
+        w.put(ira);
+        w.put(orb);
+        w.put(irb);
+        w.put(ddra);
+        w.put(ddrb);
+        w.put(sr);
+        w.put(acr);
+        w.put(pcr);
+        w.put(ifr.value);
+        w.put(ier.value);
+        w.put(t1_latch);
+        w.put(t1_counter);
+        w.put(t2_latch);
+        w.put(t2_counter);
+        w.put(t1_oneshot_pending);
+        w.put(t2_oneshot_pending);
+        w.put(t1_rollover);
+        w.put(t2_rollover);
+        w.put(t1_skip_next_decrement);
+        w.put(t2_skip_next_decrement);
+    }
+
+    bool load_state(SnapshotReader &r) {
+        bool ok = r.get(ora) && r.get(ira) && r.get(orb) && r.get(irb)
+            && r.get(ddra) && r.get(ddrb) && r.get(sr) && r.get(acr) && r.get(pcr)
+            && r.get(ifr.value) && r.get(ier.value)
+            && r.get(t1_latch) && r.get(t1_counter) && r.get(t2_latch) && r.get(t2_counter)
+            && r.get(t1_oneshot_pending) && r.get(t2_oneshot_pending)
+            && r.get(t1_rollover) && r.get(t2_rollover)
+            && r.get(t1_skip_next_decrement) && r.get(t2_skip_next_decrement);
+        if (!ok) return false;
+        update_interrupt();
+        return true;
+    }
+
 
     void debug(DebugFormatter *df) {
 
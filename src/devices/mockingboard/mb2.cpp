@@ -105,6 +105,8 @@ DebugFormatter *debug_registers_6522(mb_cpu_data *mb_d) {
 
 class Mockingboard {
 private:
+    static constexpr uint32_t FREE_RUN_FRAME_SAMPLES = OUTPUT_SAMPLE_RATE_INT / 60;  // 735
+
     N6522 *n6522[2];
     AY8910s *ay8910s;
     SDL_AudioStream *stream;
@@ -114,13 +116,6 @@ private:
     InterruptController *irq_control = nullptr;
     AudioSystem *audio_system;
 
-    float samples_accumulated = 0.0f;
-    float frame_rate;
-    float samples_per_frame;
-    uint32_t samples_per_frame_int;
-    float samples_per_frame_remainder;
-    uint64_t vid_cycles_rate;
-
     NClock *clock;
 
     // TODO: this is an undimensioned vector, which will be doing all kinds of memory allocation
@@ -155,12 +150,6 @@ public:
         this->audio_system = audio_system;
         last_cycle = 0;
 
-        frame_rate = (double)clock->get_vid_cycles_per_second() / (double)clock->get_vid_cycles_per_frame();
-        samples_per_frame = (float)OUTPUT_SAMPLE_RATE_INT / frame_rate;
-        samples_per_frame_int = (int32_t)samples_per_frame;
-        samples_per_frame_remainder = samples_per_frame - samples_per_frame_int;
-        vid_cycles_rate = clock->get_vid_cycles_per_second();
-
         stream = audio_system->create_stream(OUTPUT_SAMPLE_RATE_INT, 2, SDL_AUDIO_F32LE, false);
 
         // Port A pull-ups hold the bus high at power-on; match reset().
@@ -194,8 +183,7 @@ public:
         if (reg == MB_6522_ORB) {
             uint8_t pa = n6522[chip]->get_ora() & n6522[chip]->get_ddra();
             uint8_t pb = n6522[chip]->get_orb() & n6522[chip]->get_ddrb();
-            double  t  = (double)clock->get_vid_cycles() / (double)vid_cycles_rate;
-            AyBusResult r = ay8910s->busCycle(chip, pa, pb, t);
+            AyBusResult r = ay8910s->busCycle(chip, pa, pb, ay_time());
             if (r.drove_data) {
                 n6522[chip]->set_ira(r.data);
             } else {
@@ -216,19 +204,30 @@ public:
         return n6522[chip]->read(reg);
     }
     
+    /**
+     * The time the AY runs on. Normally that's PHI0 (video cycles), but in
+     * CLOCK_FREE_RUN NClock only counts CPU cycles and video cycles stand
+     * still. Then the AY keeps its own time: writes are stamped with where
+     * synthesis has got to (so they land at the start of the next frame's
+     * samples) and generate_frame() advances it by a frame's worth of audio.
+     * Switching back to a paced mode resyncs to the video clock.
+     */
+    uint64_t ay_time() {
+        if (clock->get_clock_mode() == CLOCK_FREE_RUN) return ay8910s->synth_cycle();
+        return clock->get_vid_cycles();
+    }
+
     void generate_frame() {
         static int frames = 0;
 
-        samples_accumulated += samples_per_frame_remainder;
-        uint32_t samples_this_frame = samples_per_frame_int;
-        if (samples_accumulated >= 1.0f) {
-            samples_this_frame = samples_per_frame_int+1;
-            samples_accumulated -= 1.0f;
+        if (clock->get_clock_mode() == CLOCK_FREE_RUN) {
+            last_cycle = ay8910s->synth_cycle() + ay8910s->cycles_for_samples(FREE_RUN_FRAME_SAMPLES);
+        } else {
+            last_cycle = clock->get_vid_cycles();
         }
-    
-        last_cycle = clock->get_vid_cycles();
-    
-        ay8910s->generateSamples(samples_this_frame);
+
+        // synthesize right up to where the emulated clock is now.
+        ay8910s->generateSamples(last_cycle);
     
         // Clear the audio buffer after each frame to prevent memory buildup
         // Send the generated audio data to the SDL audio stream
@@ -247,11 +246,23 @@ public:
                 if (stream) {
                     samples_in_buffer = SDL_GetAudioStreamAvailable(stream) / sizeof(float);
                 }
-                printf("MB Status: buffer: %d, audio buffer size: %d, samples_per_frame: %d\n", samples_in_buffer, abs, samples_this_frame);
+                printf("MB Status: buffer: %d, audio buffer size: %d, samples_this_frame: %d\n", samples_in_buffer, abs, abs / 2);
             }
         }
     }
 
+    void save_state(SnapshotWriter &w) {
+        n6522[0]->save_state(w);
+        n6522[1]->save_state(w);
+        ay8910s->save_state(w);
+    }
+
+    bool load_state(SnapshotReader &r) {
+        if (!n6522[0]->load_state(r) || !n6522[1]->load_state(r) || !ay8910s->load_state(r)) return false;
+        audio_buffer.clear();  // samples from the old timeline
+        return true;
+    }
+
     void reset() {
         n6522[0]->reset();
         n6522[1]->reset();
@@ -320,6 +331,13 @@ void init_slot_mockingboard(computer_t *computer, SlotType_t slot) {
         return true;
     });
 
+    // one chunk per card: "MB" plus the slot digit.
+    char tag[5] = "MB 0";
+    tag[3] = (char)('0' + slot);
+    computer->register_snapshot_handler(snapshot_tag(tag), 1,
+        [mb_d](SnapshotWriter &w) { mb_d->mockingboard->save_state(w); },
+        [mb_d](SnapshotReader &r, std::string &err) { return mb_d->mockingboard->load_state(r); });
+
     computer->register_shutdown_handler([mb_d]() {
         delete mb_d->mockingboard;
         //SDL_DestroyAudioStream(mb_d->stream);
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstdio>
 #include "util/media.hpp"
+#include "util/BlockImage.hpp"
 #include "SlotData.hpp"
 #include "util/StorageDevice.hpp"
 
@@ -28,12 +29,24 @@ using packed16 = packed_uint<2>;
 using packed24 = packed_uint<3>;
 using packed32 = packed_uint<4>;
 
+// Dirty blocks are written back once the guest has left a drive alone this long.
+#define PDB_FLUSH_IDLE_NS 250000000
+
 struct media_t {
-    FILE *file;
+    BlockImage *image;
     media_descriptor *media;
     storage_key_t key;
     int last_block_accessed;
     uint64_t last_block_access_time;
+
+    // called every frame; batches a burst of writes into one flush.
+    void flush_if_idle(uint64_t now) {
+        if (image && image->is_dirty() && now - last_block_access_time >= PDB_FLUSH_IDLE_NS) {
+            image->flush();
+            // blocks that failed to write are retried after another idle period, not every frame.
+            if (image->is_dirty()) last_block_access_time = now;
+        }
+    }
 };
 
 struct pdblock_cmd_v1 {
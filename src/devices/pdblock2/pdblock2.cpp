@@ -24,6 +24,7 @@
 #include "util/media.hpp"
 #include "util/ResourceFile.hpp"
 #include "util/mount.hpp"
+#include "util/DebugHandlerIDs.hpp"
 
 void pdblock2_print_cmdbuffer(pdblock_cmd_buffer *pdb) {
     std::cout << "PD_CMD_BUFFER: ";
@@ -57,7 +58,7 @@ drive_status_t pdblock2_osd_status(pdblock2_data *pdblock_d, storage_key_t key)
 
 uint8_t pdblock2_status(pdblock2_data *pdblock_d, uint8_t drive) {
     
-    if (pdblock_d->drives[drive].file == nullptr) {
+    if (pdblock_d->drives[drive].image == nullptr) {
         return 0x01; // device not ready
     }
     return 0x00; // device ready
@@ -76,15 +77,9 @@ void pdblock2_read_block(pdblock2_data *pdblock_d, uint8_t drive, uint16_t block
 
     // TODO: read the block into the address.
     /* static */ uint8_t block_buffer[512]; // uhh, no!
-    FILE *fp = pdblock_d->drives[drive].file;
-    
     media_descriptor *media = pdblock_d->drives[drive].media;
 
-    if (fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET) < 0) {
-        pdblock_d->cmd_buffer.error = PD_ERROR_IO;
-    }
-    size_t bytes_read = fread(block_buffer, 1, media->block_size, fp);
-    if (bytes_read != media->block_size) {
+    if (!pdblock_d->drives[drive].image->read_block(block, block_buffer)) {
         pdblock_d->cmd_buffer.error = PD_ERROR_IO;
     }
     for (int i = 0; i < media->block_size; i++) {
@@ -104,7 +99,6 @@ void pdblock2_write_block(pdblock2_data *pdblock_d, uint8_t drive, uint16_t bloc
 
     // TODO: read the block into the address.
     /* static */ uint8_t block_buffer[512];
-    FILE *fp = pdblock_d->drives[drive].file;
     media_descriptor *media = pdblock_d->drives[drive].media;
 
     if (media->write_protected) {
@@ -117,12 +111,23 @@ void pdblock2_write_block(pdblock2_data *pdblock_d, uint8_t drive, uint16_t bloc
         //block_buffer[i] = read_memory(cpu, addr + i); 
         block_buffer[i] = pdblock_d->mmu->read(addr + i); 
     }
-    fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET);
-    fwrite(block_buffer, 1, media->block_size, fp);
+    if (!pdblock_d->drives[drive].image->write_block(block, block_buffer)) {
+        pdblock_d->cmd_buffer.error = PD_ERROR_IO;
+    }
     pdblock_d->drives[drive].last_block_accessed = block;
     pdblock_d->drives[drive].last_block_access_time = SDL_GetTicksNS();
 }
 
+DebugFormatter *pdblock2_debug_display(pdblock2_data *pdblock_d) {
+    DebugFormatter *f = new DebugFormatter();
+    for (int j = 0; j < 2; j++) {
+        f->addLine("PDBlock2 S%d D%d", (int)pdblock_d->_slot, j + 1);
+        if (pdblock_d->drives[j].image) pdblock_d->drives[j].image->debug(f);
+        else f->addLine("  (not mounted)");
+    }
+    return f;
+}
+
 void pdblock2_execute(pdblock2_data *pdblock_d) {
     uint8_t cmd, dev, unit, slot, drive;
     uint16_t block, addr;
@@ -176,15 +181,15 @@ void pdblock2_execute(pdblock2_data *pdblock_d) {
         pdblock_d->cmd_buffer.status1 = media->block_count & 0xFF;
         pdblock_d->cmd_buffer.status2 = (media->block_count >> 8) & 0xFF;
     } else if (cmd == 0x01) {
-        pdblock2_read_block(pdblock_d, drive, block, addr);
         pdblock_d->cmd_buffer.error = 0x00;
         pdblock_d->cmd_buffer.status1 = 0x00;
         pdblock_d->cmd_buffer.status2 = 0x00;
+        pdblock2_read_block(pdblock_d, drive, block, addr);
     } else if (cmd == 0x02) {
-        pdblock2_write_block(pdblock_d, drive, block, addr);
         pdblock_d->cmd_buffer.error = 0x00;
         pdblock_d->cmd_buffer.status1 = 0x00;
         pdblock_d->cmd_buffer.status2 = 0x00;
+        pdblock2_write_block(pdblock_d, drive, block, addr);
     } else if (cmd == 0x03) { // not implemented
         pdblock_d->cmd_buffer.error = PD_ERROR_NO_DEVICE;
     }
@@ -198,13 +203,12 @@ bool mount_pdblock2(pdblock2_data *pdblock_d, uint8_t drive, media_descriptor *m
     //if (DEBUG(DEBUG_PD_BLOCK)) printf("Mounting ProDOS block device %s slot %d drive %d\n", media->filename, slot, drive);
     if (DEBUG(DEBUG_PD_BLOCK)) std::cout << "Mounting ProDOS block device " << media->filename << " slot: " << pdblock_d->_slot << " drive " << drive << std::endl;
 
-    const char *mode = media->write_protected ? "rb" : "r+b";
-    FILE *fp = fopen(media->filename.c_str(), mode);
-    if (fp == nullptr) {
-        std::cerr << "Could not open ProDOS block device file: " << media->filename << std::endl;
+    BlockImage *image = new BlockImage();
+    if (!image->open(media)) {
+        delete image;
         return false;
     }
-    pdblock_d->drives[drive].file = fp;
+    pdblock_d->drives[drive].image = image;
     pdblock_d->drives[drive].media = media;
     return true;
 }
@@ -212,9 +216,9 @@ bool mount_pdblock2(pdblock2_data *pdblock_d, uint8_t drive, media_descriptor *m
 bool unmount_pdblock2(pdblock2_data *pdblock_d, storage_key_t key) {
     uint8_t drive = key.drive;
 
-    if (pdblock_d->drives[drive].file) {
-        fclose(pdblock_d->drives[drive].file);
-        pdblock_d->drives[drive].file = nullptr;
+    if (pdblock_d->drives[drive].image) {
+        delete pdblock_d->drives[drive].image; // closes, writing back anything dirty
+        pdblock_d->drives[drive].image = nullptr;
         pdblock_d->drives[drive].media = nullptr;
     }
     return true;
@@ -264,7 +268,7 @@ void init_pdblock2(computer_t *computer, SlotType_t slot)
     pdblock2_data * pdblock_d = new pdblock2_data;
     pdblock_d->id = DEVICE_ID_PD_BLOCK2;
     for (int j = 0; j < 2; j++) {
-        pdblock_d->drives[j].file = nullptr;
+        pdblock_d->drives[j].image = nullptr;
         pdblock_d->drives[j].media = nullptr;
     }
     pdblock_d->cmd_buffer.index = 0;
@@ -305,4 +309,29 @@ void init_pdblock2(computer_t *computer, SlotType_t slot)
     computer->mmu->set_C0XX_read_handler((slot * 0x10) + PD_ERROR_GET, { pdblock2_read_C0x0, pdblock_d });
     computer->mmu->set_C0XX_read_handler((slot * 0x10) + PD_STATUS1_GET, { pdblock2_read_C0x0, pdblock_d });
     computer->mmu->set_C0XX_read_handler((slot * 0x10) + PD_STATUS2_GET, { pdblock2_read_C0x0, pdblock_d });
+
+    computer->device_frame_dispatcher->registerHandler(
+        [pdblock_d]() {
+            uint64_t now = SDL_GetTicksNS();
+            for (int j = 0; j < 2; j++) {
+                pdblock_d->drives[j].flush_if_idle(now);
+            }
+            return true;
+        });
+
+    computer->register_shutdown_handler([pdblock_d]() {
+        for (int j = 0; j < 2; j++) {
+            delete pdblock_d->drives[j].image; // closes, writing back anything dirty
+            pdblock_d->drives[j].image = nullptr;
+        }
+        return true;
+    });
+
+    computer->register_debug_display_handler(
+        "pdblock2",
+        DH_PDBLOCK2,
+        [pdblock_d]() -> DebugFormatter * {
+            return pdblock2_debug_display(pdblock_d);
+        }
+    );
 }
@@ -25,6 +25,7 @@
 #include "util/media.hpp"
 #include "util/ResourceFile.hpp"
 #include "util/mount.hpp"
+#include "util/DebugHandlerIDs.hpp"
 
 
 class PDBlock3; // forward declaration
@@ -55,7 +56,7 @@ private:
 public:
     PDBlock3(uint8_t slot, MMU *mmu) : _slot(slot), mmu(mmu) {
         for (int j = 0; j < PDB3_MAX_UNITS; j++) {
-            drives[j].file = nullptr;
+            drives[j].image = nullptr;
             drives[j].media = nullptr;
             disk_switched[j] = false;
         }
@@ -74,11 +75,14 @@ public:
     }
 
     ~PDBlock3() {
+        close_all();
+    }
+
+    /* Close every unit's image, writing back anything dirty. */
+    void close_all() {
         for (int j = 0; j < PDB3_MAX_UNITS; j++) {
-            if (drives[j].file) {
-                fclose(drives[j].file);
-                drives[j].file = nullptr;
-            }
+            delete drives[j].image;
+            drives[j].image = nullptr;
         }
     }
 
@@ -96,7 +100,7 @@ public:
 
     uint8_t internal_status(uint8_t drive) {
         if (drive >= PDB3_MAX_UNITS) return 0x01;
-        if (drives[drive].file == nullptr) {
+        if (drives[drive].image == nullptr) {
             return 0x01; // device not ready
         }
         return 0x00; // device ready
@@ -120,7 +124,6 @@ public:
 
         key_info[drives[drive].key].last_active_unit = drive; // mark this as the last active unit for this key
 
-        FILE *fp = drives[drive].file;
         media_descriptor *media = drives[drive].media;
 
         if (media->block_size == 0 || media->block_size > 512) {
@@ -131,11 +134,7 @@ public:
             cmd_buffer.error = PD_ERROR_IO;
             return;
         }
-        if (fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET) < 0) {
-            cmd_buffer.error = PD_ERROR_IO;
-        }
-        size_t bytes_read = fread(block_buffer, 1, media->block_size, fp);
-        if (bytes_read != media->block_size) {
+        if (!drives[drive].image->read_block(block, block_buffer)) {
             cmd_buffer.error = PD_ERROR_IO;
         }
         for (int i = 0; i < media->block_size; i++) {
@@ -153,7 +152,6 @@ public:
 
         key_info[drives[drive].key].last_active_unit = drive; // mark this as the last active unit for this key
 
-        FILE *fp = drives[drive].file;
         media_descriptor *media = drives[drive].media;
 
         if (media->block_size == 0 || media->block_size > 512) {
@@ -173,8 +171,9 @@ public:
         for (int i = 0; i < media->block_size; i++) {
             block_buffer[i] = mmu->read(addr + i); 
         }
-        fseek(fp, media->data_offset + (block * media->block_size), SEEK_SET);
-        fwrite(block_buffer, 1, media->block_size, fp);
+        if (!drives[drive].image->write_block(block, block_buffer)) {
+            cmd_buffer.error = PD_ERROR_IO;
+        }
         drives[drive].last_block_accessed = block;
         drives[drive].last_block_access_time = SDL_GetTicksNS();
     }
@@ -210,7 +209,7 @@ public:
     }
 
     bool check_online(uint8_t unit) {
-        if (drives[unit].file == nullptr || drives[unit].media == nullptr) {
+        if (drives[unit].image == nullptr || drives[unit].media == nullptr) {
             cmd_buffer.error = PD_ERROR_DEVICE_OFFLINE;
             return false;
         }
@@ -405,13 +404,12 @@ public:
         //if (DEBUG(DEBUG_PD_BLOCK)) printf("Mounting ProDOS block device %s slot %d drive %d\n", media->filename, slot, drive);
         if (DEBUG(DEBUG_PD_BLOCK)) std::cout << "Mounting PDB3 device " << media->filename << " slot: " << _slot << " drive " << key.drive << std::endl;
         
-        const char *mode = media->write_protected ? "rb" : "r+b";
-        FILE *fp = fopen(media->filename.c_str(), mode);
-        if (fp == nullptr) {
-            std::cerr << "Could not open PDB3 device file: " << media->filename << std::endl;
+        BlockImage *image = new BlockImage();
+        if (!image->open(media)) {
+            delete image;
             return false;
         }
-        drives[key.drive].file = fp;
+        drives[key.drive].image = image;
         drives[key.drive].media = media;
         disk_switched[key.drive] = true;
         return true;
@@ -426,7 +424,7 @@ public:
         for (media_descriptor *media : media_list) {
             // find unused unit
             while (unused_unit < PDB3_MAX_UNITS) {
-                if (drives[unused_unit].file == nullptr) break;
+                if (drives[unused_unit].image == nullptr) break;
                 unused_unit++;
             }
             if (unused_unit == PDB3_MAX_UNITS) return false; // no units free
@@ -436,13 +434,12 @@ public:
             //if (DEBUG(DEBUG_PD_BLOCK)) printf("Mounting ProDOS block device %s slot %d drive %d\n", media->filename, slot, drive);
             if (DEBUG(DEBUG_PD_BLOCK)) std::cout << "Mounting PDB3 device " << media->filename << " slot: " << _slot << " drive " << key.drive << std::endl;
             
-            const char *mode = media->write_protected ? "rb" : "r+b";
-            FILE *fp = fopen(media->filename.c_str(), mode);
-            if (fp == nullptr) {
-                std::cerr << "Could not open PDB3 device file: " << media->filename << std::endl;
+            BlockImage *image = new BlockImage();
+            if (!image->open(media)) {
+                delete image;
                 return false;
             }
-            drives[unused_unit].file = fp;
+            drives[unused_unit].image = image;
             drives[unused_unit].media = media;
             drives[unused_unit].key = key;  // mark this as being mounted on this key
             disk_switched[unused_unit] = true;
@@ -457,9 +454,9 @@ public:
 
     bool unmounto(storage_key_t key) {
         if (key.drive >= PDB3_MAX_UNITS) return true;
-        if (drives[key.drive].file) {
-            fclose(drives[key.drive].file);
-            drives[key.drive].file = nullptr;
+        if (drives[key.drive].image) {
+            delete drives[key.drive].image;
+            drives[key.drive].image = nullptr;
             drives[key.drive].media = nullptr;
             disk_switched[key.drive] = true;
         }
@@ -473,8 +470,8 @@ public:
 
         for (int i = 0; i < PDB3_MAX_UNITS; i++) {
             if (drives[i].key == key) {
-                fclose(drives[i].file);
-                drives[i].file = nullptr;
+                delete drives[i].image; // closes, writing back anything dirty
+                drives[i].image = nullptr;
                 drives[i].media = nullptr;
                 disk_switched[i] = true;
             }
@@ -587,6 +584,24 @@ public:
         reset();
     }
 
+    /* Called every frame: write back drives the guest has stopped using. */
+    void frame_flush() {
+        uint64_t now = SDL_GetTicksNS();
+        for (int j = 0; j < PDB3_MAX_UNITS; j++) {
+            drives[j].flush_if_idle(now);
+        }
+    }
+
+    DebugFormatter *debug() {
+        DebugFormatter *f = new DebugFormatter();
+        for (int j = 0; j < PDB3_MAX_UNITS; j++) {
+            if (drives[j].image == nullptr) continue;
+            f->addLine("PDB3 S%d unit %d: %s", (int)_slot, j + 1, drives[j].media->filestub.c_str());
+            drives[j].image->debug(f);
+        }
+        return f;
+    }
+
     /* Getters for command status */
     uint8_t get_error() {
         return cmd_buffer.error;
@@ -694,4 +709,23 @@ void init_pdblock3(computer_t *computer, SlotType_t slot)
     
     computer->mmu->set_C8xx_handler(slot, map_rom_pdblock3, pdblock_d);
 
+    computer->device_frame_dispatcher->registerHandler(
+        [pd3]() {
+            pd3->frame_flush();
+            return true;
+        });
+
+    computer->register_shutdown_handler([pd3]() {
+        pd3->close_all();
+        return true;
+    });
+
+    computer->register_debug_display_handler(
+        "pdblock3",
+        DH_PDBLOCK3,
+        [pd3]() -> DebugFormatter * {
+            return pd3->debug();
+        }
+    );
+
 }
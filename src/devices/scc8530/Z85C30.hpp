@@ -5,6 +5,7 @@
 #include "util/DebugFormatter.hpp"
 #include "util/InterruptController.hpp"
 #include "util/EventTimer.hpp"
+#include "util/Snapshot.hpp"
 #include "NClock.hpp"
 #include "serial_devices/SerialDevice.hpp"
 
@@ -578,6 +579,12 @@ class Z85C30 {
             tx_timer_id[SCC_CHANNEL_B] = base_instance_id + 1;
             rx_timer_id[SCC_CHANNEL_A] = base_instance_id + 2;
             rx_timer_id[SCC_CHANNEL_B] = base_instance_id + 3;
+            if (event_timer) {
+                for (int ch = 0; ch < SCC_CHANNEL_COUNT; ch++) {
+                    event_timer->registerCallback(tx_timer_id[ch], tx_complete_callback, this);
+                    event_timer->registerCallback(rx_timer_id[ch], rx_complete_callback, this);
+                }
+            }
             
             // clear the data structures on boot.
             memset(reg_select, 0, sizeof(reg_select));
@@ -669,6 +676,22 @@ class Z85C30 {
             hw_reset_channel(SCC_CHANNEL_A);
             hw_reset_channel(SCC_CHANNEL_B);
         }
+
+        // Chip registers only; characters in flight on the host side (serial devices) aren't saved.
+        void save_state(SnapshotWriter &w) {
+            w.put(registers);
+            w.put(reg_select);
+            w.put(baud_rate);
+            w.put(clock_mode);
+        }
+
+        bool load_state(SnapshotReader &r) {
+            if (!(r.get(registers) && r.get(reg_select) && r.get(baud_rate) && r.get(clock_mode))) return false;
+            // the interrupt-pending bits all live in channel A's RR3.
+            bool pending = registers[SCC_CHANNEL_A].r9_mie && (registers[SCC_CHANNEL_A].r_reg_3 & 0x3F);
+            irq_control->set_irq(IRQ_ID_SCC, pending);
+            return true;
+        }
         
         void writeCmd(scc_channel_t channel, uint8_t data) {
             // current reg_select for channel
@@ -114,6 +114,10 @@ void init_scc8530_slot(computer_t *computer, SlotType_t slot) {
         return true;
     });
 
+    computer->register_snapshot_handler(snapshot_tag("SCC "), 1,
+        [st](SnapshotWriter &w) { st->scc->save_state(w); },
+        [st](SnapshotReader &r, std::string &err) { return st->scc->load_state(r); });
+
     // chip reset by pulling r and w low at same time and holding a bit. there's logic on the mobo for this, mixing reset and the normal r/w signal.
     computer->register_reset_handler([st](bool cold_start) {
         st->scc->reset();
@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cstring>
+
+#include "SpeakerBlep.hpp"
+
+alignas(16) float SpeakerBlep::kernel[SpeakerBlep::PHASES][SpeakerBlep::TAPS];
+
+// Blackman-windowed sinc, cut off a little under Nyquist. Each phase is
+// normalized to sum to 1 so a step always lands at exactly its full height.
+void SpeakerBlep::build_kernel() {
+    const double cutoff = 0.45; // of the output sample rate
+    for (int p = 0; p < PHASES; p++) {
+        double frac = (double)p / PHASES;
+        double sum = 0.0;
+        double taps[TAPS];
+        for (int k = 0; k < TAPS; k++) {
+            double x = k - frac - (TAPS / 2 - 1);          // distance from the step, in samples
+            double t = (x + TAPS / 2) / TAPS;              // window position, 0..1
+            double w = 0.42 - 0.5 * cos(2.0 * M_PI * t) + 0.08 * cos(4.0 * M_PI * t);
+            double s = (x == 0.0) ? 1.0 : sin(2.0 * M_PI * cutoff * x) / (2.0 * M_PI * cutoff * x);
+            taps[k] = w * s;
+            sum += taps[k];
+        }
+        for (int k = 0; k < TAPS; k++) {
+            kernel[p][k] = (float)(taps[k] / sum);
+        }
+    }
+}
+
+SpeakerBlep::SpeakerBlep(uint32_t max_samples, float leak) : max_samples(max_samples), leak(leak) {
+    static const bool kernel_built = (build_kernel(), true);
+    (void)kernel_built;
+    acc = new float[max_samples + TAPS];
+    memset(acc, 0, sizeof(float) * (max_samples + TAPS));
+}
+
+SpeakerBlep::~SpeakerBlep() {
+    delete[] acc;
+}
+
+void SpeakerBlep::reset() {
+    memset(acc, 0, sizeof(float) * (max_samples + TAPS));
+    level = 0.0f;
+}
+
+/**
+ * level[i] = leak * level[i-1] + acc[i], four samples at a time: two
+ * shift-and-add steps give each lane the weighted sum of the lanes before it,
+ * then the previous group's last level is added in with leak^1..leak^4.
+ */
+void SpeakerBlep::render(int16_t *out, uint32_t num_samples) {
+    uint32_t i = 0;
+    float l2 = leak * leak;
+
+#if defined(__SSE2__)
+    const __m128 a1 = _mm_set1_ps(leak);
+    const __m128 a2 = _mm_set1_ps(l2);
+    const __m128 carry_w = _mm_setr_ps(leak, l2, l2 * leak, l2 * l2);
+    __m128 carry = _mm_set1_ps(level);
+    for (; i + 4 <= num_samples; i += 4) {
+        __m128 v = _mm_loadu_ps(acc + i);
+        v = _mm_add_ps(v, _mm_mul_ps(a1, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4))));
+        v = _mm_add_ps(v, _mm_mul_ps(a2, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8))));
+        v = _mm_add_ps(v, _mm_mul_ps(carry_w, carry));
+        carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i s = _mm_cvtps_epi32(v);
+        _mm_storel_epi64((__m128i *)(out + i), _mm_packs_epi32(s, s));
+    }
+    _mm_store_ss(&level, carry);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float carry_init[4] = { leak, l2, l2 * leak, l2 * l2 };
+    const float32x4_t carry_w = vld1q_f32(carry_init);
+    float32x4_t carry = vdupq_n_f32(level);
+    for (; i + 4 <= num_samples; i += 4) {
+        float32x4_t v = vld1q_f32(acc + i);
+        v = vaddq_f32(v, vmulq_n_f32(vextq_f32(zero, v, 3), leak));
+        v = vaddq_f32(v, vmulq_n_f32(vextq_f32(zero, v, 2), l2));
+        v = vmlaq_f32(v, carry_w, carry);
+        carry = vdupq_laneq_f32(v, 3);
+        vst1_s16(out + i, vqmovn_s32(vcvtnq_s32_f32(v)));
+    }
+    level = vgetq_lane_f32(carry, 0);
+#endif
+
+    for (; i < num_samples; i++) {
+        level = level * leak + acc[i];
+        long s = lrintf(level);
+        out[i] = (int16_t)(s > 32767 ? 32767 : (s < -32768 ? -32768 : s));
+    }
+
+    // carry the kernel tails into the next block.
+    memmove(acc, acc + num_samples, sizeof(float) * TAPS);
+    memset(acc + TAPS, 0, sizeof(float) * num_samples);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * Band-limited step synthesis for the speaker.
+ *
+ * Each toggle adds one windowed-sinc impulse (the derivative of a band-limited
+ * step) into an accumulation buffer, at the sub-sample phase where it happened.
+ * render() then integrates the buffer with a leaky integrator, which turns the
+ * impulses back into steps and lets a held level drain toward zero the way the
+ * speaker cone does. Cost is O(toggles) plus one vector pass per block, and
+ * toggle rates above Nyquist no longer alias.
+ *
+ * Output is delayed by TAPS / 2 samples; the kernel tail that spills past a
+ * block is carried into the next one.
+ */
+class SpeakerBlep {
+    public:
+        static constexpr int TAPS = 16;     // kernel width, in output samples
+        static constexpr int PHASES = 64;   // sub-sample positions
+
+        SpeakerBlep(uint32_t max_samples, float leak);
+        ~SpeakerBlep();
+
+        SpeakerBlep(const SpeakerBlep &) = delete;
+        SpeakerBlep &operator=(const SpeakerBlep &) = delete;
+
+        /** Add a step of height delta at sample + phase / PHASES. sample must be < the next render()'s num_samples. */
+        inline void add_step(uint32_t sample, uint32_t phase, float delta) {
+            const float *k = kernel[phase];
+            float *a = acc + sample;
+#if defined(__SSE2__)
+            const __m128 d = _mm_set1_ps(delta);
+            for (int i = 0; i < TAPS; i += 4) {
+                _mm_storeu_ps(a + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_mul_ps(_mm_load_ps(k + i), d)));
+            }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+            for (int i = 0; i < TAPS; i += 4) {
+                vst1q_f32(a + i, vmlaq_n_f32(vld1q_f32(a + i), vld1q_f32(k + i), delta));
+            }
+#else
+            for (int i = 0; i < TAPS; i++) {
+                a[i] += k[i] * delta;
+            }
+#endif
+        }
+
+        /** Integrate num_samples (<= max_samples) of steps into out, saturating to int16. */
+        void render(int16_t *out, uint32_t num_samples);
+
+        /** Drop pending steps and return the output to zero. */
+        void reset();
+
+    private:
+        static void build_kernel();
+        alignas(16) static float kernel[PHASES][TAPS];
+
+        uint32_t max_samples;
+        float *acc;                 // max_samples + TAPS impulse sums
+        float leak;                 // integrator decay per sample
+        float level = 0.0f;         // integrator state
+};
@@ -3,6 +3,7 @@
 #include <SDL3/SDL.h>
 
 #include "devices/speaker/NEventBuffer.hpp"
+#include "devices/speaker/SpeakerBlep.hpp"
 #include "util/AudioSystem.hpp"
 
 typedef uint64_t speaker_t;
@@ -72,6 +73,14 @@ class SpeakerFX {
         uint64_t last_event_time = 0;
         uint32_t last_event_fake = 1;
 
+        // band-limited step generator (enable_blep()). Sample 0 of the next block starts at
+        // blep_cycle + blep_frac / 2^FRACTION_BITS.
+        SpeakerBlep *blep = nullptr;
+        uint32_t blep_max_samples;
+        uint64_t blep_cycle = 0;
+        speaker_t blep_frac = 0;
+        float blep_level = 0.0f;
+
         FILE *speaker_recording = nullptr;
         AudioSystem *audio_system;
 
@@ -90,6 +99,7 @@ class SpeakerFX {
 
             // make sure we allocate plenty of room for extra samples for catchup in generate.
             working_buffer = new int16_t[min_sample_buffer_size];
+            blep_max_samples = min_sample_buffer_size;
                     
             stream = audio_system->create_stream(output_rate, 1, SDL_AUDIO_S16LE, false);
             audio_system->pause(); // leave this in here for now - we need to handle this better (pause system startup when starting //e?)
@@ -101,6 +111,7 @@ class SpeakerFX {
 
             delete[] working_buffer;
             delete event_buffer;
+            delete blep;
         }
 
         void print() {
@@ -134,6 +145,24 @@ class SpeakerFX {
         void reset(uint64_t cycle) {
             last_event_time = cycle;
             rect_remain = 0;
+            blep_cycle = cycle;
+            blep_frac = 0;
+        }
+
+        /** Drop queued toggles and restart timing at cycle, e.g. after a snapshot restore. */
+        void restart(uint64_t cycle) {
+            event_wdata_t event;
+            while (event_buffer->peek_oldest(event)) event_buffer->pop();
+            if (blep) blep->reset();
+            reset(cycle);
+        }
+
+        /** Switch to the band-limited step generator. Call before the first generate. */
+        void enable_blep() {
+            if (blep) return;
+            blep = new SpeakerBlep(blep_max_samples, 0.9990f);
+            blep_cycle = last_event_time;
+            blep_frac = 0;
         }
 
         // Discard all buffered audio waiting in the SDL stream.  Call this
@@ -155,6 +184,8 @@ class SpeakerFX {
         */
         uint64_t generate_samples(int16_t *buffer, uint64_t num_samples, uint64_t frame_next_cycle_start) {
 
+            if (blep) return generate_samples_blep(buffer, num_samples);
+
             for (uint64_t i = 0; i < num_samples; i++) {
                 sample_remain = cycles_per_sample;
                 speaker_t contrib = 0;
@@ -226,6 +257,43 @@ class SpeakerFX {
             return num_samples;
         }
         
+        /*
+        Band-limited version of generate_samples. Each toggle becomes one step at its
+        sub-sample position; the 30ms hold + decay is replaced by SpeakerBlep's leaky
+        integrator, so a held level drains toward zero (AC coupled, like the real speaker)
+        instead of toward the low rail.
+        */
+        uint64_t generate_samples_blep(int16_t *buffer, uint64_t num_samples) {
+            speaker_t span = num_samples * cycles_per_sample;
+            double blep_phase_scale = (double)SpeakerBlep::PHASES / (double)cycles_per_sample;
+            event_wdata_t event_time;
+
+            while (event_buffer->peek_oldest(event_time)) {
+                // offset of the event into this block. Stale events (from before a reset()) go at 0.
+                speaker_t offset = 0;
+                if (event_time.cycle > blep_cycle) {
+                    offset = (event_time.cycle - blep_cycle) << FRACTION_BITS;
+                    offset = (offset > blep_frac) ? offset - blep_frac : 0;
+                }
+                if (offset >= span) break;
+                event_buffer->pop();
+
+                volume = (uint16_t)event_time.data;
+                polarity_impulse = polarity_impulse ^ polarity_flipper;
+                float target = polarity_impulse ? (float)volume_table[volume] : 0.0f;
+                uint32_t pos = (uint32_t)(offset * blep_phase_scale); // in 1/PHASES samples
+                blep->add_step(pos / SpeakerBlep::PHASES, pos % SpeakerBlep::PHASES, target - blep_level);
+                blep_level = target;
+            }
+            blep->render(buffer, num_samples);
+
+            speaker_t end = blep_frac + span;
+            blep_cycle += end >> FRACTION_BITS;
+            blep_frac = end & FRACTION_MASK;
+            last_event_time = blep_cycle;
+            return num_samples;
+        }
+
         void configure(uint64_t input_rate) {
             this->input_rate = input_rate;
             cycles_per_sample = (input_rate << FRACTION_BITS) / output_rate;
@@ -315,6 +383,7 @@ class SpeakerFX {
         }
         void fast_forward(uint64_t cycles) {
             last_event_time += cycles;
+            blep_cycle += cycles;
         }
         bool started() { return (device_started == 1); }
 };
@@ -170,6 +170,9 @@ void init_mb_speaker(computer_t *computer,  SlotType_t slot) {
 
     speaker_state->sp = new SpeakerFX(speaker_state->audio_system, speaker_state->clock->get_c14m_per_second(), 44100, 128*1024, 4096);
     speaker_state->event_buffer = speaker_state->sp->event_buffer;
+    if (gs2_app_values.speaker_blep) {
+        speaker_state->sp->enable_blep();
+    }
     
     speaker_state->speaker_recording = nullptr;
 
@@ -208,6 +211,16 @@ void init_mb_speaker(computer_t *computer,  SlotType_t slot) {
         speaker_state->sp->reset(clock->get_frame_end_c14M() - clock->get_c14m_per_frame());
     });
 
+    // nothing to save: toggles are not kept past a frame. On restore, drop the
+    // queued ones and pick up timing from the restored clock.
+    computer->register_snapshot_handler(snapshot_tag("SPKR"), 1,
+        [](SnapshotWriter &w) {},
+        [speaker_state](SnapshotReader &r, std::string &err) {
+            NClock *clock = speaker_state->clock;
+            speaker_state->sp->restart(clock->get_frame_end_c14M() - clock->get_c14m_per_frame());
+            return true;
+        });
+
     computer->device_frame_dispatcher->registerHandler([speaker_state]() {
         audio_generate_frame(speaker_state);
 
@@ -36,6 +36,7 @@
 #include "devices/displaypp/VideoScanGenerator_Intf.hpp"
 #include "devices/displaypp/VideoScanGenerator_RGB.hpp"
 #include "devices/displaypp/VideoScanGenerator_Comp.hpp"
+#include "devices/displaypp/FrameRenderThread.hpp"
 #include "mbus/MessageBus.hpp"
 #include "mbus/KeyboardMessage.hpp"
 #include "util/EventTimer.hpp"
@@ -71,11 +72,59 @@ constexpr SDL_FRect content_rec_vsg2[4][2] = {
     { { 168.0-42, 35.0-19, 560+42+42, 192.0+19+29 }, { 192.0-48.0, 35.0-19.0, 640.0+48+48, 200+19+21.0 } },
 };
 
+/**
+ * Cheap content signature of the coming frame: the scans through VSYNC (bytes,
+ * mode, flags, and SHR palette / color data all ride in the scans), plus the
+ * generator settings that change how they're drawn.
+ */
+static uint64_t frame_signature(display_state_t *ds, ScanBuffer *scanbuf) {
+    video_system_t *vs = ds->video_system;
+    uint64_t h = scanbuf->frame_signature();
+    uint64_t settings = (uint64_t)vs->display_color_engine
+        | (uint64_t)ds->vsg->next_flash_state() << 8
+        | (uint64_t)ds->vsg->get_mono_mode() << 9
+        | (uint64_t)ds->vsg->get_dhgr_mono_mode() << 10
+        | (uint64_t)ds->vsg->get_display_shift() << 11
+        | (uint64_t)ds->f_langsel << 16
+        | (uint64_t)ds->border_color << 24
+        | (uint64_t)vs->get_mono_color().rgba << 32;
+    h = (h ^ settings) * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)(uintptr_t)ds->vsg;
+    return h;
+}
+
+/**
+ * With --render-thread the worker may be running a generator right now.
+ * Anything that changes generator settings or the LUTs it reads must wait
+ * for it first; collect() is a no-op when no frame is in flight.
+ */
+static inline void render_sync(display_state_t *ds) {
+    if (ds->render_thread) ds->render_thread->collect();
+}
+
+/* Push the soft-switch generator settings into both generators. Frame boundary only. */
+static void apply_vsg_settings(display_state_t *ds) {
+    if (!ds->vsg_settings_pending) return;
+    ds->vsg_settings_pending = false;
+    VideoScanGeneratorIntf *gens[2] = { ds->vsgc, ds->vsgr };
+    for (VideoScanGeneratorIntf *g : gens) {
+        if (!g) continue;
+        g->set_dhgr_mono_mode(ds->new_video & 0x20);
+        g->set_mono_mode(ds->monocolor & 0x80);
+        g->set_char_set((ds->f_langsel & 0xE0) >> 5);
+    }
+}
+
 bool update_display_apple2_cycle(display_state_t *ds) {
     video_system_t *vs = ds->video_system;
 
     ScanBuffer *scanbuf = ds->video_scanner->get_frame_scan();
 
+    // pipelined: the worker has been drawing last frame's scans while we emulated this one.
+    // get it into the texture and make sure the worker is idle before touching the generators.
+    render_sync(ds);
+    apply_vsg_settings(ds);
+
     // TODO: This stuff takes basically no time, but it might make more sense to encap this in a helper routine somewhere else
 
     switch (vs->display_color_engine) {
@@ -96,9 +145,21 @@ bool update_display_apple2_cycle(display_state_t *ds) {
             assert(false && "Invalid display color engine");
     }
 
-    ds->frame_vsg->open();
-    ds->vsg->generate_frame(scanbuf);
-    ds->frame_vsg->close();
+    // if nothing visible changed, the texture already holds this frame: skip the generate and the upload.
+    uint64_t signature = frame_signature(ds, scanbuf);
+    if (ds->last_frame_valid && signature == ds->last_frame_signature) {
+        ds->vsg->skip_frame(scanbuf);
+    } else if (ds->render_thread) {
+        ds->render_thread->submit(ds->vsg, scanbuf);
+        ds->last_frame_signature = signature;
+        ds->last_frame_valid = true;
+    } else {
+        ds->frame_vsg->open();
+        ds->vsg->generate_frame(scanbuf);
+        ds->frame_vsg->close();
+        ds->last_frame_signature = signature;
+        ds->last_frame_valid = true;
+    }
 
     SDL_FRect ii_frame_src;
     ii_frame_src = content_rec_vsg2[ds->video_scanner_type][(ds->new_video & 0x80) ? 1 : 0];
@@ -302,6 +363,7 @@ display_state_t::display_state_t() {
 }
 
 display_state_t::~display_state_t() {
+    delete render_thread;
     delete vsg;
     delete video_scanner;
     delete char_rom;
@@ -323,7 +385,9 @@ bool handle_display_event(display_state_t *ds, const SDL_Event &event) {
             if (config.videoSaturation < 0.0f) config.videoSaturation = 0.0f;
             if (config.videoSaturation > 1.0f) config.videoSaturation = 1.0f;
         }
+        render_sync(ds);
         init_hgr_LUT();
+        ds->last_frame_valid = false; // same scans, new colors.
         static char msgbuf[256];
         snprintf(msgbuf, sizeof(msgbuf), "Hue set to: %f, Saturation to: %f\n", config.videoHue, config.videoSaturation);
         ds->event_queue->addEvent(new Event(EVENT_SHOW_MESSAGE, 0, msgbuf));
@@ -345,7 +409,9 @@ bool handle_display_event(display_state_t *ds, const SDL_Event &event) {
     }
 #endif
     if (key == SDLK_F8) {
+        render_sync(ds);
         ds->vsg->setDumpNextFrame(true);
+        ds->last_frame_valid = false; // make sure the next frame is generated, so it gets dumped.
         return true;
     }
     return false;
@@ -381,11 +447,7 @@ void set_new_video(display_state_t *ds, uint8_t value) {
         ds->video_scanner->reset_shr();
         /* // TODO: ds->a2_display->reset_shr(); */
     }
-    if (ds->new_video & 0x20) {
-        ds->vsg->set_dhgr_mono_mode(true);
-    } else {
-        ds->vsg->set_dhgr_mono_mode(false);
-    }
+    ds->vsg_settings_pending = true; // DHGR mono (bit 5)
 }
 
 void display_write_C029(void *context, uint32_t address, uint8_t value) {
@@ -401,13 +463,8 @@ void display_write_C029(void *context, uint32_t address, uint8_t value) {
 
 void display_write_C021(void *context, uint32_t address, uint8_t value) {
     display_state_t *ds = (display_state_t *)context;
-    if (value & 0x80) { 
-        // enable mono
-        ds->vsg->set_mono_mode(true);
-    } else {
-        ds->vsg->set_mono_mode(false);
-    }
-    
+    ds->monocolor = value; // bit 7 enables mono
+    ds->vsg_settings_pending = true;
 }
 
 /**
@@ -590,7 +647,7 @@ void set_langsel(display_state_t *ds, uint8_t value) {
     ds->f_langsel = value & 0b1111'1000;
     
     // set language for display. Only values 0-7 are valid.
-    ds->vsg->set_char_set((ds->f_langsel & 0xE0) >> 5); // set LS scanner.
+    ds->vsg_settings_pending = true; // char set for the LS scanner
     
     // TODO: set video mode timing ntsc vs pal.
     // TODO: implement LANGUAGE switch (if 0, use lang 0. Otherwise use whatever lang selected.)
@@ -868,6 +925,14 @@ void init_mb_device_display_common(computer_t *computer, SlotType_t slot, bool c
     // linear/pixelart are set in vs->render_frame.
     SDL_SetTextureBlendMode(ds->frame_vsg->get_texture(), SDL_BLENDMODE_NONE);
 
+    if (gs2_app_values.render_thread) {
+        ds->render_thread = new FrameRenderThread(ds->frame_vsg);
+        if (!ds->render_thread->start()) {
+            delete ds->render_thread;
+            ds->render_thread = nullptr;
+        }
+    }
+
     // set in CPU so we can reference later
     computer->set_module_state(MODULE_DISPLAY, ds);
     
@@ -901,6 +966,43 @@ void init_mb_device_display_common(computer_t *computer, SlotType_t slot, bool c
         return false;
     });
 
+    computer->register_snapshot_handler(snapshot_tag("DISP"), 1,
+        [ds](SnapshotWriter &w) {
+            w.put(ds->display_mode);
+            w.put(ds->display_split_mode);
+            w.put(ds->display_graphics_mode);
+            w.put(ds->display_page_num);
+            w.put(ds->f_altcharset);
+            w.put(ds->f_80col);
+            w.put(ds->flash_state);
+            w.put(ds->flash_counter);
+            w.put(ds->f_double_graphics);
+            w.put(ds->f_INTEN);
+            w.put(ds->f_VGCINT);
+            w.put(ds->f_INTFLAG);
+            w.put(ds->onesec_counter);
+            w.put(ds->quartersec_counter);
+            w.put(ds->f_langsel);
+            w.put(ds->new_video);
+            w.put(ds->text_color);
+            w.put(ds->border_color);
+            ds->video_scanner->save_state(w);
+        },
+        [ds](SnapshotReader &r, std::string &err) {
+            bool ok = r.get(ds->display_mode) && r.get(ds->display_split_mode)
+                && r.get(ds->display_graphics_mode) && r.get(ds->display_page_num)
+                && r.get(ds->f_altcharset) && r.get(ds->f_80col)
+                && r.get(ds->flash_state) && r.get(ds->flash_counter) && r.get(ds->f_double_graphics)
+                && r.get(ds->f_INTEN) && r.get(ds->f_VGCINT) && r.get(ds->f_INTFLAG)
+                && r.get(ds->onesec_counter) && r.get(ds->quartersec_counter)
+                && r.get(ds->f_langsel) && r.get(ds->new_video)
+                && r.get(ds->text_color) && r.get(ds->border_color);
+            if (!ok || !ds->video_scanner->load_state(r)) return false;
+            ds->vsg_settings_pending = true;
+            ds->last_frame_valid = false;
+            return true;
+        });
+
     computer->register_shutdown_handler([ds]() {
         delete ds;
         return true;
@@ -1001,6 +1103,7 @@ void init_mb_device_display_common(computer_t *computer, SlotType_t slot, bool c
         mmu->set_C0XX_write_handler(0xC022, { display_write_C022, ds });
         mmu->set_C0XX_read_handler(0xC034, { display_read_C034, ds });
         mmu->set_C0XX_write_handler(0xC034, { display_write_C034, ds });
+        render_sync(ds);
         ds->vsg->set_display_shift(false); // no shift in Apple IIgs mode.
         ds->mon_mono.set_shift_enabled(false);
         ds->mon_ntsc.set_shift_enabled(false);
@@ -35,6 +35,7 @@ class VideoScanGenerator ;
 class VideoScanGeneratorIntf;
 class VideoScanGenerator_Comp;
 class VideoScanGenerator_RGB;
+class FrameRenderThread;
 class CharRom;
 
 // Graphics vs Text, C050 / C051
@@ -170,6 +171,7 @@ public:
     VideoScanGeneratorIntf *vsg = nullptr; // current VideoGenerator
     VideoScanGenerator_Comp *vsgc = nullptr;
     VideoScanGenerator_RGB *vsgr = nullptr;
+    FrameRenderThread *render_thread = nullptr; // --render-thread: generate on a worker, one frame behind
 
     // monitor controls
     int32_t vsize = 0;
@@ -178,6 +180,10 @@ public:
     int32_t vpos = 0;
     bool frame_moved = true;
 
+    // unchanged-frame skip: signature of the frame currently in frame_vsg's texture.
+    uint64_t last_frame_signature = 0;
+    bool last_frame_valid = false;
+
     Monochrome560 mon_mono;
     NTSC560 mon_ntsc;
     //GSRGB560 mon_rgb;
@@ -187,6 +193,11 @@ public:
     uint8_t new_video = 0x01;
     uint8_t text_color = 0x0F0;
     uint8_t border_color = 0x00;
+    uint8_t monocolor = 0x00; // C021
+
+    // C029 / C021 / C02B writes land mid-frame while the render worker may be
+    // using the generators; they're applied at the next frame boundary.
+    bool vsg_settings_pending = false;
 
 } display_state_t;
 
@@ -22,6 +22,7 @@
 #include <vector>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 //#include <chrono>
 #include <stdio.h>
@@ -157,9 +158,9 @@ void setupConfig() {
 }
 
 /** 
- * the Lookup table - 4 phases, 2 ^ (num_taps * 2) bits.
+ * the Lookup table - 4 phases, 3 chunks of the window, 2 ^ NTSC_CHUNK_BITS bit patterns.
  */
-alignas(64) RGBA_t g_hgr_LUT[4][(1 << ((NUM_TAPS * 2) + 1))];
+alignas(64) float g_ntsc_chunk_LUT[4][NTSC_CHUNKS][1 << NTSC_CHUNK_BITS][4];
 
 
 // Process a single scanline of Apple II video data
@@ -251,16 +252,47 @@ void init_hgr_LUT()
     decoderMatrix.print();
     config.decoderMatrix = decoderMatrix;
 
+    // where r, g, b and a land in an RGBA_t on this platform.
+    int lane[4];
+    for (int ch = 0; ch < 4; ch++) {
+        RGBA_t t;
+        t.rgba = 0;
+        if (ch == 0) t.r = 0xFF;
+        else if (ch == 1) t.g = 0xFF;
+        else if (ch == 2) t.b = 0xFF;
+        else t.a = 0xFF;
+        uint8_t bytes[4];
+        memcpy(bytes, &t, sizeof(bytes));
+        for (int i = 0; i < 4; i++) if (bytes[i]) lane[ch] = i;
+    }
+
     for (int phaseCount = 0; phaseCount < 4; phaseCount++)
     {
-        for (uint32_t bitCount = 0; bitCount < (1 << ((NUM_TAPS * 2) + 1)); bitCount++)
-        {
-            //  set the bit pattern on either size of the center (16 + phaseCount)
+        //  the bit pattern sits on either side of the center (16 + phaseCount)
+        int center = (16 + phaseCount);
 
-            int center = (16 + phaseCount);
-
-            RGBA_t rval = processAppleIIScanline_lut3(bitCount,/*  outputImage, */ center /* , width, yiqBuffer, filteredYiq */);
-            g_hgr_LUT[phaseCount][bitCount] = rval;  //  Pull out the center pixel and save it.
+        for (int chunk = 0; chunk < NTSC_CHUNKS; chunk++)
+        {
+            for (uint32_t bitCount = 0; bitCount < (1 << NTSC_CHUNK_BITS); bitCount++)
+            {
+                float oy = 0.0f;
+                float oi = 0.0f;
+                float oq = 0.0f;
+                for (int k = 0; k < NTSC_CHUNK_BITS; k++) {
+                    if (!(bitCount & (1 << k))) continue; // a 0 bit contributes nothing.
+                    int offset = chunk * NTSC_CHUNK_BITS + k - NUM_TAPS;
+                    int x = center + offset;
+                    int coeffIdx = std::abs(offset);
+                    oy += config.pixelYUV[1][x % 4][0] * config.filterCoefficients[coeffIdx][0];
+                    oi += config.pixelYUV[1][x % 4][1] * config.filterCoefficients[coeffIdx][1];
+                    oq += config.pixelYUV[1][x % 4][2] * config.filterCoefficients[coeffIdx][2];
+                }
+                float *e = g_ntsc_chunk_LUT[phaseCount][chunk][bitCount];
+                e[lane[0]] = 255.0f * (config.decoderMatrix[0] * oy + config.decoderMatrix[1] * oi + config.decoderMatrix[2] * oq);
+                e[lane[1]] = 255.0f * (config.decoderMatrix[3] * oy + config.decoderMatrix[4] * oi + config.decoderMatrix[5] * oq);
+                e[lane[2]] = 255.0f * (config.decoderMatrix[6] * oy + config.decoderMatrix[7] * oi + config.decoderMatrix[8] * oq);
+                e[lane[3]] = (chunk == 0) ? 255.0f : 0.0f; // alpha comes in once.
+            }
         }
     }
 }
@@ -301,7 +333,7 @@ void processAppleIIFrame_LUT (
             int phase = x % 4;
 
             //  Use the phase and the bits as the index
-            outputImage[0] = g_hgr_LUT[phase][bits];
+            outputImage[0] = ntsc_pixel(phase, bits);
             outputImage++;
             frameData++;
         }
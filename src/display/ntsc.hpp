@@ -18,6 +18,13 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 #include "Matrix3x3.hpp"
 //#include "display.hpp"
 #include "display/types.hpp"
@@ -59,6 +66,74 @@ const float NTSC_4FSC = 4 * NTSC_FSC;
 
 extern ntsc_config config ;
 
+/**
+ * Composite color lookup.
+ *
+ * The filtered output at a pixel is linear in the 2*NUM_TAPS+1 bits around it
+ * (bit 0 = leftmost), and so is the YIQ to RGB decode. So instead of one entry
+ * per whole bit pattern (4 x 32K RGBA), the window is cut into three 5-bit
+ * chunks, and each chunk's contribution is precomputed already decoded and
+ * scaled to 0-255, laid out in RGBA_t byte order. A pixel is then three loads,
+ * two vector adds and a saturating pack. 4 phases x 3 chunks x 32 = 6KB, which
+ * stays in L1.
+ */
+#define NTSC_CHUNK_BITS 5
+#define NTSC_CHUNKS 3
+static_assert(NTSC_CHUNK_BITS * NTSC_CHUNKS == (NUM_TAPS * 2) + 1, "NTSC chunks must cover the filter window");
+
+extern float g_ntsc_chunk_LUT[4][NTSC_CHUNKS][1 << NTSC_CHUNK_BITS][4];
+
+inline RGBA_t ntsc_pixel(uint32_t phase, uint32_t bits) {
+    constexpr uint32_t mask = (1 << NTSC_CHUNK_BITS) - 1;
+    const float *c0 = g_ntsc_chunk_LUT[phase][0][bits & mask];
+    const float *c1 = g_ntsc_chunk_LUT[phase][1][(bits >> NTSC_CHUNK_BITS) & mask];
+    const float *c2 = g_ntsc_chunk_LUT[phase][2][(bits >> (NTSC_CHUNK_BITS * 2)) & mask];
+    RGBA_t out;
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128 v = _mm_add_ps(_mm_add_ps(_mm_load_ps(c0), _mm_load_ps(c1)), _mm_load_ps(c2));
+    __m128i i = _mm_cvttps_epi32(v);
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    out.rgba = (uint32_t)_mm_cvtsi128_si32(i);
+#elif defined(__ARM_NEON)
+    float32x4_t v = vaddq_f32(vaddq_f32(vld1q_f32(c0), vld1q_f32(c1)), vld1q_f32(c2));
+    int16x4_t h = vqmovn_s32(vcvtq_s32_f32(v));
+    uint8x8_t b = vqmovun_s16(vcombine_s16(h, h));
+    out.rgba = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+#else
+    uint8_t b[4];
+    for (int lane = 0; lane < 4; lane++) {
+        int v = (int)(c0[lane] + c1[lane] + c2[lane]);
+        b[lane] = v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+    memcpy(&out, b, sizeof(out));
+#endif
+    return out;
+}
+
+/**
+ * Pack a scanline of one-byte-per-bit video into 64-bit words for ntsc_window().
+ * NUM_TAPS zero bits go in front, and the tail is zero, so every window is in range.
+ * words must hold NTSC_PACKED_WORDS(width).
+ */
+#define NTSC_PACKED_WORDS(width) ((((width) + (NUM_TAPS * 2) + 1) + 63) / 64 + 1)
+
+inline void ntsc_pack_line(const uint8_t *line, uint32_t width, uint64_t *words) {
+    memset(words, 0, NTSC_PACKED_WORDS(width) * sizeof(uint64_t));
+    for (uint32_t x = 0; x < width; x++) {
+        uint32_t pos = x + NUM_TAPS;
+        words[pos >> 6] |= (uint64_t)(line[x] != 0) << (pos & 63);
+    }
+}
+
+/** The 2*NUM_TAPS+1 bits centered on pixel x, out of a line packed by ntsc_pack_line. */
+inline uint32_t ntsc_window(const uint64_t *words, uint32_t x) {
+    uint32_t k = x >> 6;
+    uint32_t sh = x & 63;
+    uint64_t w = (words[k] >> sh) | ((words[k + 1] << 1) << (63 - sh));
+    return (uint32_t)w & ((1 << ((NUM_TAPS * 2) + 1)) - 1);
+}
+
 /* extern RGBA mono_color_table[DM_NUM_MONO_MODES]; */
 
 void setupConfig();
@@ -17,6 +17,8 @@
 
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <unistd.h>
 #include <time.h>
 #include <getopt.h>
@@ -48,6 +50,7 @@
 #include "debugger/DebugProtocolServer.hpp"
 #include "debugger/BreakpointTable.hpp"
 #include "computer.hpp"
+#include "machine.hpp"
 #include "mmus/mmu_ii.hpp"
 #include "mmus/mmu_iie.hpp"
 #include "mmus/mmu_iigs.hpp"
@@ -259,24 +262,12 @@ DebugFormatter *debug_clock(computer_t *computer) {
 }
 #endif
 
-void register_clock_debug(computer_t *computer) {
-
-    computer->register_debug_display_handler(
-        "clock",
-        DH_CLOCK, // unique ID for this, need to have in a header.
-        [computer]() -> DebugFormatter * {
-            return computer->clock->debug();
-        }
-    );
-
-}
-
-
-DebugFormatter *debug_mmu_iigs(MMU_IIgs *mmu_iigs) {
-    DebugFormatter *f = new DebugFormatter();
-    mmu_iigs->debug_dump(f);
-    return f;
-}
+/*
+In free-run mode the frame ends on host time, not on c14M. Run this many cpu
+cycles between checks of the host clock; ~10k cycles is a few microseconds of
+host time at free-run speeds, well below frame granularity.
+*/
+static constexpr uint64_t FREE_RUN_SLICE_CYCLES = 10000;
 
 /*
 Initialize emulation state before the first frame.
@@ -309,6 +300,8 @@ bool run_one_frame(computer_t *computer) {
         return true;
     }
 
+    computer->update_disk_accelerator();
+
     if (computer->speed_shift) {
         computer->speed_shift = false;
 
@@ -333,6 +326,11 @@ bool run_one_frame(computer_t *computer) {
         display_update_video_scanner(ds);
     }
 
+    // Nothing reads trace_entry unless tracing, stepping or checking breakpoints,
+    // so run the TraceDisabled core otherwise.
+    cpu->use_traced_core(cpu->trace || computer->execution_mode != EXEC_NORMAL
+        || computer->debug_window->needs_breakpoint_checks());
+
     if (computer->execution_mode == EXEC_STEP_INTO) {
 
         /* This will run about 60fps, primarily waiting on user input in the debugger window. */
@@ -439,6 +437,13 @@ bool run_one_frame(computer_t *computer) {
 
             }
         } else { // skip all debug checks if debug window is not open - this may seem repetitious but it saves all kinds of cycles where every cycle counts 
+            // run ahead inside the core until the next timer event or end of frame.
+            exec_budget_t budget;
+            budget.c14m_timer = computer->event_timer;
+            budget.vid_timer = computer->vid_event_timer;
+            budget.cpu_timer = computer->cpu_event_timer;
+            budget.deadline = &computer->cpu_budget_deadline;
+            budget.c14m_end = clock->get_frame_end_c14M();
             while (clock->get_c14m() < clock->get_frame_end_c14M()) {
                 if (computer->event_timer->isEventPassed(clock->get_c14m())) {
                     computer->event_timer->processEvents(clock->get_c14m());
@@ -449,7 +454,7 @@ bool run_one_frame(computer_t *computer) {
                 if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
                     computer->cpu_event_timer->processEvents(clock->get_cycles());
                 }
-                (cpu->cpun->execute_next)(cpu);
+                cpu->cpun->execute_budget(cpu, budget);
             }
         }
 
@@ -542,17 +547,26 @@ bool run_one_frame(computer_t *computer) {
 
             }
         } else { // skip all debug checks if debug window is not open - this may seem repetitious but it saves all kinds of cycles where every cycle counts (GO FAST MODE)
+            // only look at the host clock once per slice of cpu cycles, not once per instruction.
+            exec_budget_t budget;
+            budget.c14m_timer = computer->event_timer;
+            budget.vid_timer = computer->vid_event_timer;
+            budget.cpu_timer = computer->cpu_event_timer;
+            budget.deadline = &computer->cpu_budget_deadline;
             while (SDL_GetTicksNS() < next_frame_time) { // run emulated frame, but of course we don't sleep in this loop so we'll Go Fast.
-                if (computer->event_timer->isEventPassed(clock->get_c14m())) {
-                    computer->event_timer->processEvents(clock->get_c14m());
-                }
-                if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
-                    computer->vid_event_timer->processEvents(clock->get_vid_cycles());
-                }
-                if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
-                    computer->cpu_event_timer->processEvents(clock->get_cycles());
-                }
-                (cpu->cpun->execute_next)(cpu);
+                budget.cycles_end = clock->get_cycles() + FREE_RUN_SLICE_CYCLES;
+                do {
+                    if (computer->event_timer->isEventPassed(clock->get_c14m())) {
+                        computer->event_timer->processEvents(clock->get_c14m());
+                    }
+                    if (computer->vid_event_timer->isEventPassed(clock->get_vid_cycles())) {
+                        computer->vid_event_timer->processEvents(clock->get_vid_cycles());
+                    }
+                    if (computer->cpu_event_timer->isEventPassed(clock->get_cycles())) {
+                        computer->cpu_event_timer->processEvents(clock->get_cycles());
+                    }
+                    cpu->cpun->execute_budget(cpu, budget);
+                } while (clock->get_cycles() < budget.cycles_end);
             }
         }
 
@@ -633,13 +647,28 @@ struct GS2AppState {
     std::unique_ptr<DebugProtocolServer> debug_protocol;
 
     // MMU pointers tracked for cleanup
-    MMU_II *mmu_ii = nullptr;
-    MMU_IIe *mmu_iie = nullptr;
-    MMU_IIgs *mmu_iigs = nullptr;
+    machine_mmus_t mmus;
 };
 
 void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_config, int builtin_system_id);
 
+/** Speed names for --disk-accelerator=SPEED. */
+static bool parse_accelerator_speed(const char *name, int &mode) {
+    static const struct { const char *name; clock_mode_t mode; } speeds[] = {
+        { "free", CLOCK_FREE_RUN },
+        { "2.8",  CLOCK_2_8MHZ },
+        { "7.1",  CLOCK_7_159MHZ },
+        { "14.3", CLOCK_14_3MHZ },
+    };
+    for (const auto &s : speeds) {
+        if (strcmp(name, s.name) == 0) {
+            mode = s.mode;
+            return true;
+        }
+    }
+    return false;
+}
+
 static bool apply_system_config_file(GS2AppState *state, const std::string& path, std::string& error_out) {
     state->loaded_config = std::make_unique<SystemConfig>();
     if (!state->loaded_config->load(path, error_out)) {
@@ -751,25 +780,8 @@ void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_co
 
     state->platform_id = system_config->platform_id;
 
-    platform_info* platform = get_platform(state->platform_id);
-    print_platform_info(platform);
-
-    // TODO: This is a little disjointed. the clock abstraction should probably program all the things that need the clock.
-    // the initial setting here is 1MHz, except for platform which has the right starting clock?
-    //select_system_clock(system_config->clock_set);
-    //computer->set_clock(&system_clock_mode_info[computer->speed_new]);
-    //set_clock_mode(computer->cpu, platform->default_clock_mode);
-
-    computer->cpu->set_processor(platform->cpu_type);
-    // important to do this before setting up the rest of the computer.
-    NClockII *nclock = NClockFactory::create_clock(platform->id, system_config->clock_set);
-    computer->set_clock(nclock);
     getMenuInterface()->setComputer(computer);
 
-    //computer->set_cpu(new cpu_state(platform->cpu_type));
-
-    computer->set_platform(platform);
-    computer->set_video_scanner(system_config->scanner_type);
     if (state->loaded_config) {
         computer->set_system_id(-1);
         computer->set_system_config(&state->loaded_config->config());
@@ -779,104 +791,11 @@ void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_co
         computer->set_system_config(nullptr);
         computer->set_machine_id(system_config->id ? system_config->id : "");
     }
-    
-    // TODO: load platform roms - this info should get stored in the 'computer'
-    rom_data *rd = load_platform_roms(platform);
-    if (!rd) {
-        system_failure("Failed to load platform roms, exiting.");
-        return;
-    }
-
-    // we will ALWAYS have a 256 page map. because it's a 6502 and all is addressible in a II.
-    // II can have 4k, 8k, 12k; or 16k, 32k, 48k.
-    // II Plus can have 16k, 32K, or 48k RAM. 16K more BUT IN THE LANGUAGE CARD MODULE.
-    // always 12k rom, but not necessarily always the same ROM.
-    state->mmu_ii = nullptr;
-    state->mmu_iie = nullptr;
-    state->mmu_iigs = nullptr;
-
-    switch (platform->mmu_type) {
-        case MMU_MMU_II:
-            state->mmu_ii = new MMU_II(256, 48*1024, (uint8_t *) rd->main_rom_data);
-            computer->cpu->set_mmu(state->mmu_ii);
-            computer->set_mmu(state->mmu_ii);
-            computer->debug_window->set_mmu(state->mmu_ii);
-            break;
-        case MMU_MMU_IIE:
-            state->mmu_iie = new MMU_IIe(256, 128*1024, (uint8_t *) rd->main_rom_data);
-            computer->cpu->set_mmu(state->mmu_iie);
-            computer->set_mmu(state->mmu_iie);
-            computer->debug_window->set_mmu(state->mmu_iie);
-            break;
-        case MMU_MMU_IIGS:
-            state->mmu_iie = new MMU_IIe(256, 128*1024, /* (uint8_t *) */rd->main_rom_data + 0x1'C000);
-            state->mmu_iigs = new MMU_IIgs(256, 8*1024*1024, 128*1024, /* (uint8_t *) */rd->main_rom_data, state->mmu_iie);
-            state->mmu_iigs->init_map();
-            computer->cpu->set_mmu(state->mmu_iigs); // cpu gets FPI
-            computer->set_mmu(state->mmu_iie); // everything else gets the Mega II
-            computer->debug_window->set_mmu(state->mmu_iigs);
-            state->mmu_iigs->set_clock((NClockII *)nclock);
-
-            break;
-        default:
-            printf("Unknown MMU type: %d\n", platform->mmu_type);
-            break;
-    }
-    // need to tell the MMU about our ROM somehow.
-    // need a function in MMU to "reset page to default".
-    computer->cpu->cpun = createCPU(platform->cpu_type, (NClock *)nclock);
-
-    computer->cpu->core = computer->cpu->cpun.get(); // set the core. Probably need a better set cpu for cpu_state.
-    //computer->cpu->core->set_clock(nclock);
 
-    // Initialize the slot manager.
-    //SlotManager_t *slot_manager = new SlotManager_t();
-
-
-    //init_display_font(rd);
-
-
-    // Iterate through Platform Devices and create/register/initialize the devices.
-    for (int i = 0; platform->mb_devices[i] != DEVICE_ID_END; i++) {
-        Device_t *device = get_device(platform->mb_devices[i]);
-        if (device->power_on == nullptr) {
-            printf("Device has no poweron, not found: %d", platform->mb_devices[i]);
-            continue;
-        }
-        device->power_on(computer, SLOT_NONE);
-    }
-
-    std::string slot_error;
-    if (!validate_slot_devices(*system_config, slot_error)) {
-        printf("Invalid slot configuration: %s\n", slot_error.c_str());
-        system_failure(slot_error.c_str());
+    if (!machine_power_on(computer, system_config, state->disks_to_mount, state->mmus)) {
         return;
     }
 
-    // Iterate through SystemConfig Slot Devices and create/register/initialize the devices.
-    for (int i = 0; i < NUM_SLOTS; i++) {
-        device_id id = system_config->slot_devices[i];
-        if (id == DEVICE_ID_NONE) continue;
-
-        Device_t *device = get_device(id);
-        if (device->power_on == nullptr) {
-            printf("Slot Device has no poweron handler: %d", id);
-            continue;
-        } 
-        device->power_on(computer, (SlotType_t)i);
-
-        computer->slot_manager->register_slot(device, (SlotType_t)i);
-    }
-
-    register_clock_debug(computer);
-
-    computer->cpu->reset();
-
-    // mount disks - AFTER device init.
-    for (const auto& disk_mount : state->disks_to_mount) {
-        computer->mounts->mount_media(disk_mount);
-    }
-
     osd = new OSD(computer, vs->renderer, vs->window, computer->slot_manager, 1120, 768, state->aa);
 
     // TODO: this should be handled differently. have osd save/restore?
@@ -889,28 +808,10 @@ void transition_to_emulation(GS2AppState *state, const SystemConfig_t *system_co
     
     computer->video_system->update_display(); // check for events 60 times per second.
 
-    if (platform->mmu_type == MMU_MMU_IIGS) {
-        //mmu_iigs->set_cpu(computer->cpu); // not needed any more, clock handles it.
-        
-        //computer->debug_window->set_open();
-        //computer->cpu->execution_mode = EXEC_STEP_INTO;
-        
-        computer->register_debug_display_handler(
-            "mmugs",
-            DH_MMUGS, // unique ID for this, need to have in a header.
-            [state]() -> DebugFormatter * {
-                return debug_mmu_iigs(state->mmu_iigs);
-            }
-        );
-
-
-        computer->cpu->trace_buffer->set_cpu_type(PROCESSOR_65816);
-        computer->video_system->set_display_engine(DM_ENGINE_RGB);
-
-        computer->register_reset_handler([state](bool cold_start) {
-            state->mmu_iigs->reset();
-            return true;
-        });
+    if (!gs2_app_values.trace_stream_path.empty()) {
+        if (computer->cpu->trace_buffer->open_stream(gs2_app_values.trace_stream_path)) {
+            computer->cpu->trace = true;
+        }
     }
 
     run_cpus_init(computer);
@@ -932,32 +833,18 @@ void transition_to_shutdown(GS2AppState *state) {
     std::string tracepath;
     Paths::calc_docs(tracepath, "gssquared-trace.bin");
     computer->cpu->trace_buffer->save_to_file(tracepath);
+    computer->cpu->trace_buffer->close_stream();
 
     // deallocate stuff.
     delete osd;
     osd = nullptr;
 
-    platform_info *platform = computer->platform;
     getMenuInterface()->setComputer(nullptr);
     computer->set_system_config(nullptr);
     delete computer;
     state->computer = nullptr;
 
-    switch (platform->mmu_type) {
-        case MMU_MMU_II:
-            delete state->mmu_ii;
-            break;
-        case MMU_MMU_IIE:
-            delete state->mmu_iie;
-            break;
-        case MMU_MMU_IIGS:
-            delete state->mmu_iigs;
-            delete state->mmu_iie;
-            break;
-    }
-    state->mmu_ii = nullptr;
-    state->mmu_iie = nullptr;
-    state->mmu_iigs = nullptr;
+    machine_free_mmus(state->mmus);
 
     delete state->select_system;
     state->select_system = nullptr;
@@ -1042,13 +929,18 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
     // elsewhere; without this, scripted launches (no TTY) would ignore --debug / -p / etc.
     if (gs2_app_values.console_mode || argc > 1) {
         // parse command line options
-        enum { OPT_NO_QUIT_CONFIRM = 1000 };
+        enum { OPT_NO_QUIT_CONFIRM = 1000, OPT_TRACE_STREAM, OPT_RENDER_THREAD, OPT_SPEAKER_BLEP, OPT_DISK_FLUSH };
         static struct option long_options[] = {
             {"debug", required_argument, nullptr, 'D'},
             {"no-quit-confirm", no_argument, nullptr, OPT_NO_QUIT_CONFIRM},
+            {"trace-stream", required_argument, nullptr, OPT_TRACE_STREAM},
+            {"render-thread", no_argument, nullptr, OPT_RENDER_THREAD},
+            {"speaker-blep", no_argument, nullptr, OPT_SPEAKER_BLEP},
+            {"disk-accelerator", optional_argument, nullptr, 'x'},
+            {"disk-flush", optional_argument, nullptr, OPT_DISK_FLUSH},
             {nullptr, 0, nullptr, 0}
         };
-        while ((opt = getopt_long(argc, argv, "sxgp:d:D:", long_options, nullptr)) != -1) {
+        while ((opt = getopt_long(argc, argv, "sx::gp:d:D:", long_options, nullptr)) != -1) {
             switch (opt) {
                 case 'p':
                     platform_id = std::stoi(optarg);
@@ -1071,9 +963,13 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
                         }
                     }
                     break;
-                /* case 'x':
+                case 'x':
                     gs2_app_values.disk_accelerator = true;
-                    break; */
+                    if (optarg && !parse_accelerator_speed(optarg, gs2_app_values.disk_accelerator_speed)) {
+                        std::cerr << "Unknown disk accelerator speed '" << optarg << "' (use free, 2.8, 7.1 or 14.3)\n";
+                        return SDL_APP_FAILURE;
+                    }
+                    break;
                 case 's':
                     gs2_app_values.sleep_mode = true;
                     break;
@@ -1087,8 +983,24 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
                 case OPT_NO_QUIT_CONFIRM:
                     gs2_app_values.no_quit_confirm = true;
                     break;
+                case OPT_TRACE_STREAM:
+                    gs2_app_values.trace_stream_path = optarg;
+                    break;
+                case OPT_RENDER_THREAD:
+                    gs2_app_values.render_thread = true;
+                    break;
+                case OPT_SPEAKER_BLEP:
+                    gs2_app_values.speaker_blep = true;
+                    break;
+                case OPT_DISK_FLUSH:
+                    gs2_app_values.disk_flush_seconds = optarg ? atoi(optarg) : 5;
+                    if (gs2_app_values.disk_flush_seconds <= 0) {
+                        std::cerr << "--disk-flush interval must be a positive number of seconds\n";
+                        return SDL_APP_FAILURE;
+                    }
+                    break;
                 default:
-                    std::cerr << "Usage: " << argv[0] << " [file.gs2|*Settings.txt] [-p platform] [-dsXdY=filename] [-s] [-g] [--debug PATH] [--no-quit-confirm]\n";
+                    std::cerr << "Usage: " << argv[0] << " [file.gs2|*Settings.txt] [-p platform] [-dsXdY=filename] [-s] [-g] [-x[SPEED]] [--debug PATH] [--no-quit-confirm] [--trace-stream PATH] [--render-thread] [--speaker-blep] [--disk-flush[=SECONDS]]\n";
                     std::cerr << "  file.gs2|*Settings.txt: load system configuration from a .gs2 TOML file\n";
                     std::cerr << "        or Neil Profiles Settings.txt file, skip the system-selector UI,\n";
                     std::cerr << "        and auto-launch that system.\n";
@@ -1108,10 +1020,23 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
                     std::cerr << "  -s: sleep mode (don't busy-wait, sleep)\n";
                     std::cerr << "  -g: enable CRT post-process shader when guest emulation\n";
                     std::cerr << "        starts (same as pressing F7 with shader off).\n";
+                    std::cerr << "  -x[SPEED], --disk-accelerator[=SPEED]: while any floppy motor is on,\n";
+                    std::cerr << "        run at SPEED (free, 2.8, 7.1 or 14.3; default free) with audio\n";
+                    std::cerr << "        muted, then go back to the selected speed when the motor stops.\n";
                     std::cerr << "  -D PATH, --debug PATH: listen for external debug protocol on\n";
                     std::cerr << "        Unix-domain socket PATH (see Docs/DebugProtocol.md).\n";
                     std::cerr << "  --no-quit-confirm: skip QuitModal / dirty-disk prompts on\n";
                     std::cerr << "        SDL_EVENT_QUIT (useful for tests that SIGTERM/kill the process).\n";
+                    std::cerr << "  --trace-stream PATH: while tracing is on, also write every\n";
+                    std::cerr << "        instruction to a compressed, seekable trace file (read with gstrace).\n";
+                    std::cerr << "  --render-thread: draw video frames on a separate thread while the\n";
+                    std::cerr << "        next frame emulates. Adds one frame of display latency.\n";
+                    std::cerr << "  --speaker-blep: generate speaker audio from band-limited steps\n";
+                    std::cerr << "        (no aliasing on fast toggle music).\n";
+                    std::cerr << "  --disk-flush[=SECONDS]: write floppy changes to the image file in\n";
+                    std::cerr << "        the background when the motor stops, or every SECONDS (default 5)\n";
+                    std::cerr << "        while it keeps running. Changes are then kept even if the disk\n";
+                    std::cerr << "        is later ejected without saving.\n";
                     return SDL_APP_FAILURE;
             }
         }
@@ -1372,6 +1297,7 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
                 std::string tracepath;
                 Paths::calc_docs(tracepath, "gssquared-trace.bin");
                 computer->cpu->trace_buffer->save_to_file(tracepath);
+                computer->cpu->trace_buffer->close_stream();
                 return SDL_APP_SUCCESS;
             }
             transition_to_shutdown(state);
@@ -1407,9 +1333,7 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     }
 
     // Clean up MMUs if they exist (e.g., quit during emulation)
-    delete state->mmu_ii;
-    delete state->mmu_iie;
-    delete state->mmu_iigs;
+    machine_free_mmus(state->mmus);
 
     delete state->edit_system;
     delete state->select_system;
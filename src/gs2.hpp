@@ -33,7 +33,11 @@ typedef struct gs2_app_t {
     std::string base_path;
     std::string pref_path;
     bool console_mode = false;
-   /*  bool disk_accelerator = false; */
+    /** -x / --disk-accelerator[=SPEED]: run at disk_accelerator_speed, muted, while any floppy motor is on. */
+    bool disk_accelerator = false;
+    int disk_accelerator_speed = 0;  // a clock_mode_t; default CLOCK_FREE_RUN
+    /** --disk-flush[=SECONDS]: write floppy changes back in the background; 0 = only on unmount. */
+    int disk_flush_seconds = 0;
     bool sleep_mode = false;
     // When true, enable the CRT post-process shader when guest emulation starts
     // (same effect as pressing F7 with the shader off).
@@ -43,6 +47,12 @@ typedef struct gs2_app_t {
     bool no_quit_confirm = false;
     /** After HLT_USER / shutdown, exit the process instead of returning to the selector. */
     bool force_app_exit = false;
+    /** If set (--trace-stream PATH), stream every traced instruction to this file. */
+    std::string trace_stream_path;
+    /** --render-thread: run the scan -> RGBA generator on its own thread, one frame behind emulation. */
+    bool render_thread = false;
+    /** --speaker-blep: synthesize the speaker with band-limited steps instead of per-sample box integration. */
+    bool speaker_blep = false;
     uint32_t menu_event_type = 0;
     bool modal_tracking = false;  // true while macOS menu/resize modal loop owns the run loop
 } gs2_app_t;
@@ -0,0 +1,264 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "machine.hpp"
+#include "NClock.hpp"
+#include "cpu.hpp"
+#include "devices.hpp"
+#include "platforms.hpp"
+#include "slots.hpp"
+#include "videosystem.hpp"
+#include "debugger/debugwindow.hpp"
+#include "mmus/mmu_ii.hpp"
+#include "mmus/mmu_iie.hpp"
+#include "mmus/mmu_iigs.hpp"
+#include "cpus/cpu_implementations.hpp"
+#include "util/dialog.hpp"
+#include "util/SystemConfig.hpp"
+#include "util/DebugHandlerIDs.hpp"
+#include "util/EventTimer.hpp"
+
+void register_clock_debug(computer_t *computer) {
+
+    computer->register_debug_display_handler(
+        "clock",
+        DH_CLOCK, // unique ID for this, need to have in a header.
+        [computer]() -> DebugFormatter * {
+            return computer->clock->debug();
+        }
+    );
+
+}
+
+static DebugFormatter *debug_mmu_iigs(MMU_IIgs *mmu_iigs) {
+    DebugFormatter *f = new DebugFormatter();
+    mmu_iigs->debug_dump(f);
+    return f;
+}
+
+static void register_event_timer_snapshot(computer_t *computer, const char (&tag)[5], EventTimer *timer) {
+    computer->register_snapshot_handler(snapshot_tag(tag), 1,
+        [timer](SnapshotWriter &w) { timer->save_state(w); },
+        [timer](SnapshotReader &r, std::string &err) { return timer->load_state(r, err); });
+}
+
+/**
+ * Snapshot chunks for the core: event timers, CPU, clock, RAM and MMU
+ * switches. Registered before any device, so these are restored first, and
+ * the timers before everything else - they are the only core chunk that can
+ * refuse a snapshot, and they do it without changing anything.
+ */
+static void register_core_snapshots(computer_t *computer, machine_mmus_t &mmus) {
+    register_event_timer_snapshot(computer, "TMR0", computer->event_timer);
+    register_event_timer_snapshot(computer, "TMR1", computer->vid_event_timer);
+    register_event_timer_snapshot(computer, "TMR2", computer->cpu_event_timer);
+
+    cpu_state *cpu = computer->cpu;
+    InterruptController *irq_control = computer->irq_control;
+    computer->register_snapshot_handler(snapshot_tag("CPU "), 1,
+        [cpu, irq_control](SnapshotWriter &w) {
+            uint8_t e = cpu->E;
+            w.put(cpu->full_pc);
+            w.put(cpu->db);
+            w.put(cpu->sp);
+            w.put(cpu->a);
+            w.put(cpu->x);
+            w.put(cpu->y);
+            w.put(cpu->d);
+            w.put(cpu->p);
+            w.put(e);
+            w.put(cpu->halt);
+            w.put(cpu->irq_pipe);
+            w.put(cpu->rdy);
+            w.put(cpu->clock_stopped);
+            w.put(irq_control->get_irq_mask());
+        },
+        [cpu, irq_control](SnapshotReader &r, std::string &err) {
+            uint8_t e;
+            uint64_t irq_mask;
+            bool ok = r.get(cpu->full_pc) && r.get(cpu->db) && r.get(cpu->sp)
+                && r.get(cpu->a) && r.get(cpu->x) && r.get(cpu->y) && r.get(cpu->d)
+                && r.get(cpu->p) && r.get(e) && r.get(cpu->halt) && r.get(cpu->irq_pipe)
+                && r.get(cpu->rdy) && r.get(cpu->clock_stopped) && r.get(irq_mask);
+            if (!ok) return false;
+            cpu->E = e;
+            cpu->mode_switch = true; // E/M/X may differ from the running core's.
+            irq_control->set_irq_mask(irq_mask);
+            return true;
+        });
+
+    NClockII *clock = computer->clock;
+    computer->register_snapshot_handler(snapshot_tag("CLK "), 1,
+        [computer, clock](SnapshotWriter &w) {
+            clock->save_state(w);
+            w.put(computer->frame_start_cycle);
+        },
+        [computer, clock](SnapshotReader &r, std::string &err) {
+            if (!clock->load_state(r) || !r.get(computer->frame_start_cycle)) return false;
+            computer->last_start_frame_c14m = clock->get_frame_start_c14M();
+            return true;
+        });
+
+    // on the IIgs computer->mmu is the Mega II, which holds banks E0/E1.
+    MMU_II *mmu = computer->mmu;
+    computer->register_snapshot_handler(snapshot_tag("MEM "), 1,
+        [mmu](SnapshotWriter &w) { mmu->save_state(w); },
+        [mmu](SnapshotReader &r, std::string &err) { return mmu->load_state(r); });
+
+    if (mmus.mmu_iigs) {
+        MMU_IIgs *mmu_iigs = mmus.mmu_iigs;
+        computer->register_snapshot_handler(snapshot_tag("FPI "), 1,
+            [mmu_iigs](SnapshotWriter &w) { mmu_iigs->save_state(w); },
+            [mmu_iigs](SnapshotReader &r, std::string &err) { return mmu_iigs->load_state(r); });
+    }
+}
+
+bool machine_power_on(computer_t *computer, const SystemConfig_t *system_config,
+                      const std::vector<disk_mount_t> &disks, machine_mmus_t &mmus) {
+
+    platform_info* platform = get_platform(system_config->platform_id);
+    print_platform_info(platform);
+
+    // TODO: This is a little disjointed. the clock abstraction should probably program all the things that need the clock.
+    // the initial setting here is 1MHz, except for platform which has the right starting clock?
+    computer->cpu->set_processor(platform->cpu_type);
+    // important to do this before setting up the rest of the computer.
+    NClockII *nclock = NClockFactory::create_clock(platform->id, system_config->clock_set);
+    computer->set_clock(nclock);
+
+    computer->set_platform(platform);
+    computer->set_video_scanner(system_config->scanner_type);
+
+    // TODO: load platform roms - this info should get stored in the 'computer'
+    rom_data *rd = load_platform_roms(platform);
+    if (!rd) {
+        system_failure("Failed to load platform roms, exiting.");
+        return false;
+    }
+
+    // we will ALWAYS have a 256 page map. because it's a 6502 and all is addressible in a II.
+    // II can have 4k, 8k, 12k; or 16k, 32k, 48k.
+    // II Plus can have 16k, 32K, or 48k RAM. 16K more BUT IN THE LANGUAGE CARD MODULE.
+    // always 12k rom, but not necessarily always the same ROM.
+    mmus = machine_mmus_t{};
+
+    switch (platform->mmu_type) {
+        case MMU_MMU_II:
+            mmus.mmu_ii = new MMU_II(256, 48*1024, (uint8_t *) rd->main_rom_data);
+            computer->cpu->set_mmu(mmus.mmu_ii);
+            computer->set_mmu(mmus.mmu_ii);
+            computer->debug_window->set_mmu(mmus.mmu_ii);
+            break;
+        case MMU_MMU_IIE:
+            mmus.mmu_iie = new MMU_IIe(256, 128*1024, (uint8_t *) rd->main_rom_data);
+            computer->cpu->set_mmu(mmus.mmu_iie);
+            computer->set_mmu(mmus.mmu_iie);
+            computer->debug_window->set_mmu(mmus.mmu_iie);
+            break;
+        case MMU_MMU_IIGS:
+            mmus.mmu_iie = new MMU_IIe(256, 128*1024, /* (uint8_t *) */rd->main_rom_data + 0x1'C000);
+            mmus.mmu_iigs = new MMU_IIgs(256, 8*1024*1024, 128*1024, /* (uint8_t *) */rd->main_rom_data, mmus.mmu_iie);
+            mmus.mmu_iigs->init_map();
+            computer->cpu->set_mmu(mmus.mmu_iigs); // cpu gets FPI
+            computer->set_mmu(mmus.mmu_iie); // everything else gets the Mega II
+            computer->debug_window->set_mmu(mmus.mmu_iigs);
+            mmus.mmu_iigs->set_clock((NClockII *)nclock);
+
+            break;
+        default:
+            printf("Unknown MMU type: %d\n", platform->mmu_type);
+            break;
+    }
+    // need to tell the MMU about our ROM somehow.
+    // need a function in MMU to "reset page to default".
+    computer->cpu->set_cores(createCPU(platform->cpu_type, (NClock *)nclock, true),
+                             createCPU(platform->cpu_type, (NClock *)nclock, false));
+
+    register_core_snapshots(computer, mmus);
+
+    // Iterate through Platform Devices and create/register/initialize the devices.
+    for (int i = 0; platform->mb_devices[i] != DEVICE_ID_END; i++) {
+        Device_t *device = get_device(platform->mb_devices[i]);
+        if (device->power_on == nullptr) {
+            printf("Device has no poweron, not found: %d", platform->mb_devices[i]);
+            continue;
+        }
+        device->power_on(computer, SLOT_NONE);
+    }
+
+    std::string slot_error;
+    if (!validate_slot_devices(*system_config, slot_error)) {
+        printf("Invalid slot configuration: %s\n", slot_error.c_str());
+        system_failure(slot_error.c_str());
+        return false;
+    }
+
+    // Iterate through SystemConfig Slot Devices and create/register/initialize the devices.
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        device_id id = system_config->slot_devices[i];
+        if (id == DEVICE_ID_NONE) continue;
+
+        Device_t *device = get_device(id);
+        if (device->power_on == nullptr) {
+            printf("Slot Device has no poweron handler: %d", id);
+            continue;
+        }
+        device->power_on(computer, (SlotType_t)i);
+
+        computer->slot_manager->register_slot(device, (SlotType_t)i);
+    }
+
+    register_clock_debug(computer);
+
+    computer->cpu->reset();
+
+    // mount disks - AFTER device init.
+    for (const auto& disk_mount : disks) {
+        computer->mounts->mount_media(disk_mount);
+    }
+
+    if (platform->mmu_type == MMU_MMU_IIGS) {
+        MMU_IIgs *mmu_iigs = mmus.mmu_iigs;
+
+        computer->register_debug_display_handler(
+            "mmugs",
+            DH_MMUGS, // unique ID for this, need to have in a header.
+            [mmu_iigs]() -> DebugFormatter * {
+                return debug_mmu_iigs(mmu_iigs);
+            }
+        );
+
+        computer->cpu->trace_buffer->set_cpu_type(PROCESSOR_65816);
+        computer->video_system->set_display_engine(DM_ENGINE_RGB);
+
+        computer->register_reset_handler([mmu_iigs](bool cold_start) {
+            mmu_iigs->reset();
+            return true;
+        });
+    }
+    return true;
+}
+
+void machine_free_mmus(machine_mmus_t &mmus) {
+    delete mmus.mmu_ii;
+    delete mmus.mmu_iigs;
+    delete mmus.mmu_iie;
+    mmus = machine_mmus_t{};
+}
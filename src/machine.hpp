@@ -0,0 +1,49 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "computer.hpp"
+#include "systemconfig.hpp"
+#include "util/mount.hpp"
+
+class MMU_II;
+class MMU_IIe;
+class MMU_IIgs;
+
+/** MMUs created by machine_power_on. The caller owns them and frees them with machine_free_mmus after the computer is gone. */
+struct machine_mmus_t {
+    MMU_II *mmu_ii = nullptr;
+    MMU_IIe *mmu_iie = nullptr;
+    MMU_IIgs *mmu_iigs = nullptr;
+};
+
+/**
+ * Build the machine described by system_config into computer: clock, ROMs,
+ * MMU, CPU cores, motherboard and slot devices, reset, then mount disks.
+ * This is everything that doesn't need the OSD or the menus, so the GUI
+ * and gs2headless build identical machines.
+ * Returns false (after system_failure) if the ROMs or slot config are bad.
+ */
+bool machine_power_on(computer_t *computer, const SystemConfig_t *system_config,
+                      const std::vector<disk_mount_t> &disks, machine_mmus_t &mmus);
+
+void machine_free_mmus(machine_mmus_t &mmus);
+
+void register_clock_debug(computer_t *computer);
@@ -0,0 +1,100 @@
+/*
+ *   Copyright (c) 2025-2026 Jawaid Bazyar
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "iie_map_templates.hpp"
+
+static const char *TAG_MAIN = "MAIN";
+static const char *TAG_ALT = "AUX";
+
+/** Fill the four read/write variants of an aux-switchable run of pages. */
+template <size_t N>
+static void build_aux_run(page_map_t (&variants)[4][N], page_t first, uint8_t *ram) {
+    for (int v = 0; v < 4; v++) {
+        bool aux_r = (v & 2) != 0;
+        bool aux_w = (v & 1) != 0;
+        for (size_t i = 0; i < N; i++) {
+            uint32_t offset = (first + i) * GS2_PAGE_SIZE;
+            page_map_t &m = variants[v][i];
+            m.read_p = ram + (aux_r ? 0x1'0000 : 0) + offset;
+            m.write_p = ram + (aux_w ? 0x1'0000 : 0) + offset;
+            m.read_d = aux_r ? TAG_ALT : TAG_MAIN;
+            m.write_d = aux_w ? TAG_ALT : TAG_MAIN;
+        }
+    }
+}
+
+void iie_map_templates_build(iie_map_templates_t *t, uint8_t *ram, uint8_t *rom) {
+
+    for (int aux = 0; aux < 2; aux++) {
+        for (int i = 0; i < 0x02; i++) {
+            page_map_t &m = t->zp[aux][i];
+            m.read_p = m.write_p = ram + (aux ? 0x1'0000 : 0) + i * GS2_PAGE_SIZE;
+            m.read_d = m.write_d = aux ? TAG_ALT : TAG_MAIN;
+        }
+    }
+    build_aux_run(t->low, 0x02, ram);
+    build_aux_run(t->text1, 0x04, ram);
+    build_aux_run(t->mid, 0x08, ram);
+    build_aux_run(t->hires1, 0x20, ram);
+    build_aux_run(t->high, 0x40, ram);
+
+    /**
+     * Bank switched RAM. Same layout as bsr_map_memory used to compute on every access:
+     * ROM: D0-DF     ROM + 0x1000
+     * ROM: E0-FF     ROM + 0x2000
+     * RAM: D0-DF     Bank 1:  RAM + 0xC000, Bank 2:  RAM + 0xD000
+     * RAM: E0-FF     RAM + 0xE000
+     * ALTZP adds 0x10000 to the RAM addresses. No write enable means a null write pointer.
+     */
+    for (int v = 0; v < 16; v++) {
+        bool bank1 = (v & 8) != 0;
+        bool read_enable = (v & 4) != 0;
+        bool write_enable = (v & 2) != 0;
+        bool altzp = (v & 1) != 0;
+
+        uint32_t bankd0offset = bank1 ? 0xC000 : 0xD000;
+        uint32_t banke0offset = 0xE000;
+        if (altzp) {
+            bankd0offset += 0x1'0000;
+            banke0offset += 0x1'0000;
+        }
+        uint8_t *bankd0 = ram + bankd0offset;
+        uint8_t *banke0 = ram + banke0offset;
+        const char *bank_d = bank1 ? "LC_BANK1" : "LC_BANK2";
+
+        for (int i = 0; i < 0x30; i++) {
+            page_map_t &m = t->bsr[v][i];
+            uint8_t *lc_ram = (i < 0x10) ? bankd0 + i * GS2_PAGE_SIZE : banke0 + (i - 0x10) * GS2_PAGE_SIZE;
+            const char *lc_d = (i < 0x10) ? bank_d : "LC RAM";
+
+            if (read_enable) {
+                m.read_p = lc_ram;
+                m.read_d = lc_d;
+            } else {
+                m.read_p = rom + 0x1000 + i * GS2_PAGE_SIZE;
+                m.read_d = "SYS_ROM";
+            }
+            if (write_enable) {
+                m.write_p = lc_ram;
+                m.write_d = lc_d;
+            } else {
+                m.write_p = nullptr;
+                m.write_d = "NONE";
+            }
+        }
+    }
+}
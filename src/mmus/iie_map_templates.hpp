@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mmu.hpp"
+
+/**
+ * Precomputed page maps for the IIe memory soft switches.
+ *
+ * The auxiliary memory switches (ALTZP, RAMRD, RAMWRT, and 80STORE with PAGE2 /
+ * HIRES) and the bank-switched RAM ("language card") flip-flops only ever put a
+ * region into one of a few states. So all of them are built once from the RAM
+ * and ROM base pointers, and a switch change just installs the right slice with
+ * MMU::apply_page_maps() instead of recomputing every page in the region.
+ *
+ * Used by the IIe memory device and by the IIgs for its Mega II.
+ */
+
+struct iie_map_templates_t {
+    // [aux] - ALTZP moves zero page and stack as a unit, read and write.
+    page_map_t zp[2][0x02];         // 00-01
+    // [iie_aux_index(aux read, aux write)]
+    page_map_t low[4][0x02];        // 02-03
+    page_map_t text1[4][0x04];      // 04-07
+    page_map_t mid[4][0x18];        // 08-1F
+    page_map_t hires1[4][0x20];     // 20-3F
+    page_map_t high[4][0x80];       // 40-BF
+    // [iie_bsr_index(...)]
+    page_map_t bsr[16][0x30];       // D0-FF
+};
+
+inline int iie_aux_index(bool aux_read, bool aux_write) {
+    return (aux_read ? 2 : 0) | (aux_write ? 1 : 0);
+}
+
+/** write_enable is the positive sense, i.e. !_FF_WRITE_ENABLE. */
+inline int iie_bsr_index(bool bank1, bool read_enable, bool write_enable, bool altzp) {
+    return (bank1 ? 8 : 0) | (read_enable ? 4 : 0) | (write_enable ? 2 : 0) | (altzp ? 1 : 0);
+}
+
+/** ram is main RAM with aux RAM at +0x10000; rom is the IIe ROM image starting at $C000. */
+void iie_map_templates_build(iie_map_templates_t *t, uint8_t *ram, uint8_t *rom);
@@ -41,6 +41,12 @@ struct write_handler_pair_t {
     write_handler_t hs[2];
 };
 
+// Called before the bus observes state that a deferred (lazy) producer has not caught up to yet.
+struct sync_handler_t {
+    void (*sync)(void *context);
+    void *context;
+};
+
 struct page_table_entry_t {
     page_ref read_p; // pointer to uint8_t pointers
     page_ref write_p;
@@ -51,17 +57,68 @@ struct page_table_entry_t {
     const char *write_d;
 };
 
+/** The memory part of a page mapping, without handlers. Runs of these are precomputed and installed with MMU::apply_page_maps(). */
+struct page_map_t {
+    page_ref read_p;
+    page_ref write_p;
+    const char *read_d;
+    const char *write_d;
+};
+
+// page_traps bits: send this page's accesses through the virtual read() / write()
+// even if it maps plain memory, because the MMU has side effects to apply.
+enum : uint8_t {
+    PT_TRAP_READ = 0x01,
+    PT_TRAP_WRITE = 0x02,
+};
+
 class MMU {
     protected:
         //cpu_state *cpu;
         int num_pages = 0;
-        // this is an array of info about each page.
+        // The page table is split in two. The hot half is what bus_read / bus_write
+        // touch: for each page, the host pointer the access may use directly, or
+        // nullptr if it must go through read() / write() (I/O, handlers, shadowing,
+        // ROM writes, trapped pages). That's 4KB for 256 pages instead of the ~20KB
+        // of page_table, which is the cold half: handlers and debug names, read only
+        // by the slow path and the debugger. update_page_fast() keeps them in step.
+        page_ref *read_fast;
+        page_ref *write_fast;
         page_table_entry_t *page_table;
+        uint8_t *page_traps;
         uint8_t floating_bus_val = 0xEE;
+        sync_handler_t video_sync = {nullptr, nullptr}; // lazy video scanner catch-up
         uint32_t page_size = 0;
         uint32_t page_size_bits = 0;
         uint32_t page_size_mask = 0;
 
+        // bumped whenever a page's read mapping changes. Values are unique across
+        // all MMU instances, so a stale cached generation can never match a new MMU.
+        uint64_t map_generation = 0;
+        static inline uint64_t generation_seed = 0;
+        inline void bump_map_generation() { map_generation = ++generation_seed; }
+
+        inline void update_page_fast(page_t page) {
+            const page_table_entry_t &e = page_table[page];
+            uint8_t trap = page_traps[page];
+            read_fast[page] = (trap & PT_TRAP_READ) ? nullptr : e.read_p;
+            bool write_slow = (trap & PT_TRAP_WRITE) || (e.write_h.write != nullptr) || (e.shadow_h.write != nullptr);
+            write_fast[page] = write_slow ? nullptr : e.write_p;
+        }
+
+        void set_page_trap(page_t page, uint8_t trap) {
+            page_traps[page] = trap;
+            bump_map_generation();
+            update_page_fast(page);
+        }
+
+        /** Install a whole entry (slot ROM composing, snapshot restore). */
+        void put_page(page_t page, const page_table_entry_t &pte) {
+            page_table[page] = pte;
+            bump_map_generation();
+            update_page_fast(page);
+        }
+
         /* static constexpr uint32_t PAGE_SIZE_BITS = __builtin_ctz(PAGE_SIZE);
         static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1; */
             
@@ -81,7 +138,11 @@ class MMU {
             this->page_size_bits = __builtin_ctz(page_size);
             this->page_size_mask = page_size - 1;
             
+            read_fast = new page_ref[num_pages];
+            write_fast = new page_ref[num_pages];
             page_table = new page_table_entry_t[num_pages];
+            page_traps = new uint8_t[num_pages];
+            bump_map_generation();
             for (int i = 0 ; i < num_pages ; i++) {
                 //page_table[i].readable = 0;
                 //page_table[i].writeable = 0;
@@ -92,11 +153,16 @@ class MMU {
                 page_table[i].read_h = {nullptr, nullptr};
                 page_table[i].write_h = {nullptr, nullptr};
                 page_table[i].shadow_h = {nullptr, nullptr};
+                page_traps[i] = 0;
+                update_page_fast(i);
             }
         }
 
         virtual ~MMU() {
+            delete[] read_fast;
+            delete[] write_fast;
             delete[] page_table;
+            delete[] page_traps;
         }
 
         /** Contiguous RAM allocation, if any. Linear offsets for MAIN_RAW / MEGAII_RAW. */
@@ -168,14 +234,68 @@ class MMU {
             // if none of those things were set, silently do nothing.
         }
 
+        /**
+         * CPU bus access. Not virtual: pages that are plain memory are read or
+         * written right here out of the hot arrays, and only the rest go through
+         * the virtual read() / write().
+         */
+        inline uint8_t bus_read(uint32_t address) {
+            uint32_t page = address >> page_size_bits;
+            if (page < (uint32_t)num_pages) {
+                page_ref p = read_fast[page];
+                if (p) return p[address & page_size_mask];
+            }
+            return read(address);
+        }
+
+        inline void bus_write(uint32_t address, uint8_t value) {
+            uint32_t page = address >> page_size_bits;
+            if (page < (uint32_t)num_pages) {
+                page_ref p = write_fast[page];
+                if (p) {
+                    p[address & page_size_mask] = value;
+                    return;
+                }
+            }
+            write(address, value);
+        }
+
         // By default, this is the same as read.
         inline virtual uint8_t vp_read(uint32_t address) {
             return read(address);
         }
 
+        /**
+         * Instruction fetch support.
+         * Returns the host pointer for the page containing address if a read() of
+         * any byte in that page is nothing more than read_p[offset]. Returns nullptr
+         * if fetches from the page must go through read() (I/O, side effects).
+         * The answer stays valid until get_map_generation() changes.
+         */
+        virtual uint8_t *get_fetch_page(uint32_t address) {
+            uint32_t page = address >> page_size_bits;
+            if (page >= (uint32_t)num_pages) return nullptr;
+            return read_fast[page];
+        }
+
+        /**
+         * True if fetches from the page get_fetch_page() handed out must call
+         * fetch_notify() (e.g. to set the bus cycle type) before each byte.
+         */
+        virtual bool fetch_needs_notify(uint32_t address) { return false; }
+        virtual void fetch_notify(uint32_t address) {}
+
+        inline uint64_t get_map_generation() { return map_generation; }
+        uint32_t get_page_size_bits() { return page_size_bits; }
+
         void set_floating_bus(uint8_t val) { floating_bus_val = val; }
     
-        uint8_t floating_bus_read() { return floating_bus_val; }
+        uint8_t floating_bus_read() {
+            if (video_sync.sync) video_sync.sync(video_sync.context); // floating bus is the last byte the video scanner read.
+            return floating_bus_val;
+        }
+
+        virtual void set_video_sync(sync_handler_t handler) { video_sync = handler; }
     
 
         uint8_t *get_page_base_address(page_t page) {
@@ -187,6 +307,7 @@ class MMU {
                 return;
             }
             page_table_entry_t *pte = &page_table[page];
+            bump_map_generation();
 
             pte->read_p = data;
             pte->write_p = data;
@@ -194,6 +315,7 @@ class MMU {
             pte->write_h = {nullptr, nullptr};
             pte->read_d = read_d;
             pte->write_d = read_d;
+            update_page_fast(page);
         }
 
         // map page to read only
@@ -202,11 +324,13 @@ class MMU {
                 return;
             }
             page_table_entry_t *pte = &page_table[page];
+            bump_map_generation();
 
             pte->read_p = data;
             pte->write_p = nullptr;
             pte->read_d = read_d;
             pte->write_d = nullptr;
+            update_page_fast(page);
         }
 
         void map_page_read(page_t page, uint8_t *data, const char *read_d) {
@@ -214,8 +338,10 @@ class MMU {
                 return;
             }
             page_table_entry_t *pte = &page_table[page];
+            bump_map_generation();
             pte->read_p = data;
             pte->read_d = read_d;
+            update_page_fast(page);
         }
 
         void map_page_write(page_t page, uint8_t *data, const char *write_d) {
@@ -226,20 +352,47 @@ class MMU {
             
             pte->write_p = data;
             pte->write_d = write_d;
+            update_page_fast(page);
+        }
+
+        /**
+         * Install a precomputed run of page maps starting at first. Handlers and
+         * shadows are left alone. Pages that already match are skipped, and the map
+         * generation only moves if a read pointer did, so re-selecting the current
+         * state (LC double reads, PAGE2 with 80STORE off) is just a compare.
+         */
+        void apply_page_maps(page_t first, page_t count, const page_map_t *maps) {
+            bool read_moved = false;
+            for (page_t i = 0; i < count; i++) {
+                page_table_entry_t *pte = &page_table[first + i];
+                const page_map_t &m = maps[i];
+                if (pte->read_p == m.read_p && pte->write_p == m.write_p
+                    && pte->read_d == m.read_d && pte->write_d == m.write_d) continue;
+                if (pte->read_p != m.read_p) read_moved = true;
+                pte->read_p = m.read_p;
+                pte->write_p = m.write_p;
+                pte->read_d = m.read_d;
+                pte->write_d = m.write_d;
+                update_page_fast(first + i);
+            }
+            if (read_moved) bump_map_generation();
         }
 
         void set_page_shadow(page_t page, write_handler_t handler) {
             page_table[page].shadow_h = handler;
+            update_page_fast(page);
         }
 
         void set_page_read_h(page_t page, read_handler_t handler, const char *read_d) {
             page_table[page].read_h = handler;
             page_table[page].read_d = read_d;
+            update_page_fast(page);
         }
 
         void set_page_write_h(page_t page, write_handler_t handler, const char *write_d) {
             page_table[page].write_h = handler;
             page_table[page].write_d = write_d;
+            update_page_fast(page);
         }
 
         void dump_page_table(page_t start_page, page_t end_page) {
@@ -305,7 +458,7 @@ class MMU {
         }
 
         void set_page_table_entry(page_t page, page_table_entry_t *pte) {
-            page_table[page] = *pte;
+            put_page(page, *pte);
         }
 
 };
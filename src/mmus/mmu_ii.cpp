@@ -52,6 +52,10 @@ MMU_II::MMU_II(int page_table_size, int ram_amount, uint8_t *rom_pointer) : MMU(
         slot_rom_ptable[i].write_h = {nullptr, nullptr};
         slot_rom_ptable[i].shadow_h = {nullptr, nullptr};
     }
+    // C0-CF accesses have side effects (I/O, C8xx slot ROM select), so they always go through read() / write().
+    for (page_t page = 0xC0; page <= 0xCF; page++) {
+        set_page_trap(page, PT_TRAP_READ | PT_TRAP_WRITE);
+    }
 }
 
 MMU_II::~MMU_II() {
@@ -156,7 +160,7 @@ void MMU_II::call_C8xx_handler(SlotType_t slot) {
 void MMU_II::compose_c1cf() {
     // only thing we do is set based on this. IIe expands on this.
     for (int i = 0; i < 15; i++) {
-        page_table[0xC1 + i] = slot_rom_ptable[i];
+        put_page(0xC1 + i, slot_rom_ptable[i]);
     }
 }
 
@@ -224,6 +228,9 @@ void MMU_II::write(uint32_t address, uint8_t value) {
         printf("MMU_II::write: address %06X is out of bounds\n", address);
     }
 
+    // let a lazy video scanner scan up to now before video memory changes under it.
+    if (video_sync_page[page]) video_sync.sync(video_sync.context);
+
     if (bank == 0xC) {
         if (page == 0xC0) {
             uint16_t subaddr = eaddress & 0xFF;
@@ -254,6 +261,22 @@ void MMU_II::write(uint32_t address, uint8_t value) {
     /* MMU::write(address, value); */
 }
 
+/**
+ * set_video_sync
+ * The lazy video scanner only catches up on demand. Writes to text/lores
+ * pages 04-0B and hires pages 20-5F (main or aux, by CPU page) must let it
+ * scan up to the current cycle first. A null handler turns this off.
+ */
+void MMU_II::set_video_sync(sync_handler_t handler) {
+    MMU::set_video_sync(handler);
+    bool on = (handler.sync != nullptr);
+    for (int p = 0; p < 256; p++) {
+        bool video = (p >= 0x04 && p <= 0x0B) || (p >= 0x20 && p <= 0x5F);
+        video_sync_page[p] = on && video;
+        if (video) set_page_trap(p, on ? PT_TRAP_WRITE : 0);
+    }
+}
+
 void MMU_II::set_C0XX_read_handler(uint16_t address, read_handler_t handler) {
     assert(address >= C0X0_BASE && address < C0X0_BASE + C0X0_SIZE);
 /*     if (address < C0X0_BASE || address >= C0X0_BASE + C0X0_SIZE) {
@@ -310,6 +333,19 @@ void MMU_II::reset() {
     init_map();
 }
 
+void MMU_II::save_state(SnapshotWriter &w) {
+    w.put(C8xx_slot);
+    w.put_memory(main_ram, ram_size_);
+}
+
+bool MMU_II::load_state(SnapshotReader &r) {
+    int8_t slot;
+    if (!r.get(slot) || !r.get_memory(main_ram, ram_size_)) return false;
+    if (slot >= 1 && slot <= 7) call_C8xx_handler((SlotType_t)slot);
+    else set_default_C8xx_map();
+    return true;
+}
+
 void MMU_II::dump_C0XX_handlers() {
     printf("C0XX handlers:\n");
     for (int i = 0; i < C0X0_SIZE; i++) {
@@ -3,6 +3,7 @@
 #include "gs2.hpp"
 #include "mmu.hpp"
 #include "mmu_ii.hpp"
+#include "util/Snapshot.hpp"
 
 
 struct C8XX_handler_t {
@@ -24,6 +25,7 @@ class MMU_II : public MMU {
         int8_t C8xx_slot;
         C8XX_handler_t C8xx_handlers[8] = {nullptr};
         page_table_entry_t slot_rom_ptable[15]; // handle C1-CF
+        bool video_sync_page[256] = {false}; // writes to these pages call video_sync first
 
         virtual void power_on_randomize(uint8_t *ram, int ram_size);
         
@@ -35,6 +37,11 @@ class MMU_II : public MMU {
         virtual ~MMU_II();
         uint8_t read(uint32_t address) override;
         void write(uint32_t address, uint8_t value) override;
+        // C0-CF reads have side effects (I/O, C8xx slot ROM select) - fetch those through read().
+        uint8_t *get_fetch_page(uint32_t address) override {
+            if ((address > 0xFFFF) || ((address & 0xF000) == 0xC000)) return nullptr;
+            return MMU::get_fetch_page(address);
+        }
         
         virtual void set_C8xx_handler(SlotType_t slot, void (*handler)(void *context, SlotType_t slot), void *context);
         virtual void set_C0XX_read_handler(uint16_t address, read_handler_t handler);
@@ -50,8 +57,13 @@ class MMU_II : public MMU {
         virtual void set_default_C8xx_map();
         virtual void set_slot_rom(SlotType_t slot, uint8_t *rom, const char *name);
         virtual int get_C8xx_slot() { return C8xx_slot; };
+        // register the lazy video scanner hook, and the pages (text/lores, hires) it scans.
+        void set_video_sync(sync_handler_t handler) override;
         virtual void reset() override;
         virtual void dump_C0XX_handlers();
+        /** RAM and the C8xx owner, for snapshots. */
+        virtual void save_state(SnapshotWriter &w);
+        virtual bool load_state(SnapshotReader &r);
         /* Handlers for "Slot ROM" area C1 - CF */
         virtual void compose_c1cf();
         virtual void map_c1cf_page_both(uint8_t page, uint8_t *data, const char *read_d);
@@ -44,22 +44,22 @@ void MMU_IIe::compose_c1cf() {
     if (!f_intcxrom) { // INTCXROM off - C1-CF is for cards, with possible exception for C3 if SLOTC3ROM is on.
         // the C8 routines put this here. this is correct.
         for (int i = 8; i < 16; i++) {
-            page_table[0xC0 + i] = slot_rom_ptable[i-1];
+            put_page(0xC0 + i, slot_rom_ptable[i-1]);
         }
-        page_table[0xC1] = reg_slot & 0x02 ? slot_rom_ptable[0] : int_rom_ptable[0];
-        page_table[0xC2] = reg_slot & 0x04 ? slot_rom_ptable[1] : int_rom_ptable[1];
-        page_table[0xC3] = (f_slotc3rom) ? slot_rom_ptable[2] : int_rom_ptable[2]; // different flag here.
-        page_table[0xC4] = reg_slot & 0x10 ? slot_rom_ptable[3] : int_rom_ptable[3];
-        page_table[0xC5] = reg_slot & 0x20 ? slot_rom_ptable[4] : int_rom_ptable[4];
-        page_table[0xC6] = reg_slot & 0x40 ? slot_rom_ptable[5] : int_rom_ptable[5];
-        page_table[0xC7] = reg_slot & 0x80 ? slot_rom_ptable[6] : int_rom_ptable[6];
+        put_page(0xC1, reg_slot & 0x02 ? slot_rom_ptable[0] : int_rom_ptable[0]);
+        put_page(0xC2, reg_slot & 0x04 ? slot_rom_ptable[1] : int_rom_ptable[1]);
+        put_page(0xC3, (f_slotc3rom) ? slot_rom_ptable[2] : int_rom_ptable[2]); // different flag here.
+        put_page(0xC4, reg_slot & 0x10 ? slot_rom_ptable[3] : int_rom_ptable[3]);
+        put_page(0xC5, reg_slot & 0x20 ? slot_rom_ptable[4] : int_rom_ptable[4]);
+        put_page(0xC6, reg_slot & 0x40 ? slot_rom_ptable[5] : int_rom_ptable[5]);
+        put_page(0xC7, reg_slot & 0x80 ? slot_rom_ptable[6] : int_rom_ptable[6]);
         
         /* if (!f_slotc3rom) { // this has effect in A2Ts only if intcxrom is off.
             map_page_read_only(0xC3, main_rom_D0 + 0x0300, "SYS_ROM");
         } */
     } else { // INTCXROM is on - C1-CF is all ROM.
         for (int i = 1; i < 16; i++) {
-            page_table[0xC0 + i] = int_rom_ptable[i-1];
+            put_page(0xC0 + i, int_rom_ptable[i-1]);
             //map_page_read_only(0xC0 + i, main_rom_D0 + i * GS2_PAGE_SIZE, "SYS_ROM");
         }
     }
@@ -78,6 +78,21 @@ void MMU_IIe::reset() {
     // reset page2 handled by iiememory device
 }
 
+void MMU_IIe::save_state(SnapshotWriter &w) {
+    w.put(f_intcxrom);
+    w.put(f_slotc3rom);
+    w.put(reg_slot);
+    MMU_II::save_state(w);
+}
+
+// the switches go first: they decide what restoring the C8xx owner maps in.
+bool MMU_IIe::load_state(SnapshotReader &r) {
+    if (!r.get(f_intcxrom) || !r.get(f_slotc3rom) || !r.get(reg_slot)) return false;
+    if (!MMU_II::load_state(r)) return false;
+    compose_c1cf();
+    return true;
+}
+
 void iie_mmu_handle_C00X_write(void *context, uint32_t address, uint8_t value) {
     MMU_IIe *mmu = (MMU_IIe *)context;
 
@@ -27,6 +27,8 @@ class MMU_IIe : public MMU_II {
 
         void init_map() override;
         void reset() override;
+        void save_state(SnapshotWriter &w) override;
+        bool load_state(SnapshotReader &r) override;
 };
 
 void iie_mmu_handle_C00X_write(void *context, uint16_t address, uint8_t value);
@@ -203,9 +203,6 @@ inline void megaii_c0xx_write(void *context, uint32_t address, uint8_t value) {
 
 
 void MMU_IIgs::megaii_compose_map() {
-    const char *TAG_MAIN = "MAIN";
-    const char *TAG_ALT = "AUX";
-    
     //update_display_flags(iiememory_d);
     
     bool n_zp; 
@@ -238,73 +235,27 @@ void MMU_IIgs::megaii_compose_map() {
         n_hires1_w = g_ramwrt;
     }
 
-    uint8_t *memory_base = megaii->get_memory_base();
-
     if (n_zp != m_zp) { // this is both read and write.
         // change $00, $01, $D0 - $FF
-        uint32_t altoffset = n_zp ? 0x1'0000 : 0x0'0000;
+        megaii->apply_page_maps(0x00, 0x02, maps->zp[n_zp]);
 
-        megaii->map_page_read(0x00, memory_base + altoffset + 0x0000, n_zp ? TAG_ALT : TAG_MAIN);
-        megaii->map_page_write(0x00, memory_base + altoffset + 0x0000, n_zp ? TAG_ALT : TAG_MAIN);
-        megaii->map_page_read(0x01, memory_base + altoffset + 0x0100, n_zp ? TAG_ALT : TAG_MAIN);
-        megaii->map_page_write(0x01, memory_base + altoffset + 0x0100, n_zp ? TAG_ALT : TAG_MAIN);
-        
         // handle mapping the "language card" portion.
         //bsr_map_memory(iiememory_d); // handle the 'language card' portion.
     }
-    if (n_text1_r != m_text1_r) {
-        // change $04 - $07
-        uint32_t altoffset = n_text1_r ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x04; i <= 0x07; i++) {
-            megaii->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_text1_r ? TAG_ALT : TAG_MAIN);
-        }
-    }
-    if (n_text1_w != m_text1_w) {
+    if (n_text1_r != m_text1_r || n_text1_w != m_text1_w) {
         // change $04 - $07
-        uint32_t altoffset = n_text1_w ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x04; i <= 0x07; i++) {
-            megaii->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_text1_w ? TAG_ALT : TAG_MAIN);
-        }
+        megaii->apply_page_maps(0x04, 0x04, maps->text1[iie_aux_index(n_text1_r, n_text1_w)]);
     }
-    if (n_hires1_r != m_hires1_r) {
+    if (n_hires1_r != m_hires1_r || n_hires1_w != m_hires1_w) {
         // change $20 - $3F
-        uint32_t altoffset = n_hires1_r ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x20; i <= 0x3F; i++) {
-            megaii->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_hires1_r ? TAG_ALT : TAG_MAIN);
-        }
+        megaii->apply_page_maps(0x20, 0x20, maps->hires1[iie_aux_index(n_hires1_r, n_hires1_w)]);
     }
-    if (n_hires1_w != m_hires1_w) {
-        // change $20 - $3F
-        uint32_t altoffset = n_hires1_w ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x20; i <= 0x3F; i++) {
-            megaii->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_hires1_w ? TAG_ALT : TAG_MAIN);
-        }
-    }
-    if (n_all_r != m_all_r) {  
+    if (n_all_r != m_all_r || n_all_w != m_all_w) {
         // change $02 - $03, $08 - $1F, $40 - $BF
-        uint32_t altoffset = n_all_r ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x02; i <= 0x03; i++) {
-            megaii->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_r ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x08; i <= 0x1F; i++) {
-            megaii->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_r ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x40; i <= 0xBF; i++) {
-            megaii->map_page_read(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_r ? TAG_ALT : TAG_MAIN);
-        }
-    }
-    if (n_all_w != m_all_w) {
-        // change $02 - $03, $08 - $1F, $40 - $BF
-        uint32_t altoffset = n_all_w ? 0x1'0000 : 0x0'0000;
-        for (int i = 0x02; i <= 0x03; i++) {
-            megaii->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_w ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x08; i <= 0x1F; i++) {
-            megaii->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_w ? TAG_ALT : TAG_MAIN);
-        }
-        for (int i = 0x40; i <= 0xBF; i++) {
-            megaii->map_page_write(i, memory_base + altoffset + (i * GS2_PAGE_SIZE), n_all_w ? TAG_ALT : TAG_MAIN);
-        }
+        int v = iie_aux_index(n_all_r, n_all_w);
+        megaii->apply_page_maps(0x02, 0x02, maps->low[v]);
+        megaii->apply_page_maps(0x08, 0x18, maps->mid[v]);
+        megaii->apply_page_maps(0x40, 0x80, maps->high[v]);
     }
 
     // update the "current memory map state" flags.
@@ -319,54 +270,8 @@ void MMU_IIgs::megaii_compose_map() {
 
 void MMU_IIgs::bsr_map_memory() {
 
-    uint32_t bankd0offset = (ll.FF_BANK_1 == 1) ? 0xC000 : 0xD000;
-    uint32_t banke0offset = 0xE000;
-    if (g_altzp) {
-        bankd0offset += 0x1'0000; // alternate bank!
-        banke0offset += 0x1'0000; // alternate bank!
-    }
-
-    //uint8_t *bank = (lc->FF_BANK_1 == 1) ? lc->ram : lc->ram + 0x1000;
-    uint8_t *bankd0 = megaii->get_memory_base() + bankd0offset;
-    uint8_t *banke0 = megaii->get_memory_base() + banke0offset;
-    uint8_t *rom = megaii->get_rom_base();
-
-    const char *bank_d = (ll.FF_BANK_1 == 1) ? "LC_BANK1" : "LC_BANK2";
-
-    /* Map D0 - DF */
-    for (int i = 0; i < 16; i++) {
-        if (ll.FF_READ_ENABLE) {
-            megaii->map_page_read(i + 0xD0, bankd0 + (i*GS2_PAGE_SIZE), bank_d);
-        } else { // reads == READ_ROM
-        // TODO: this is wrong - needs to somehow know to return to ROM D0/etc wherever that may be.
-        // right now hard-code to what we know about the iie rom.
-            megaii->map_page_read(i + 0xD0, rom + 0x1000 + (i*GS2_PAGE_SIZE), "SYS_ROM");
-        }
-
-        if (!ll._FF_WRITE_ENABLE) {
-            megaii->map_page_write(i+0xD0, bankd0 + (i*GS2_PAGE_SIZE), bank_d);
-
-        } else { // writes == WRITE_NONE - set it to the ROM and can_write = 0
-            megaii->map_page_write(i+0xD0, nullptr, "NONE"); // much simpler actually.. no write enable means null write pointer.
-        }
-    }
-
-    /* Map E0 - FF */
-    for (int i = 0; i < 32; i++) {
-        if (ll.FF_READ_ENABLE) {
-            megaii->map_page_read(i+0xE0, banke0 + (i * GS2_PAGE_SIZE), "LC RAM");
-
-        } else { // reads == READ_ROM
-            // TODO: this is wrong - needs to somehow know to return to ROM D0/etc wherever that may be.
-            megaii->map_page_read(i+0xE0, rom + 0x2000 + (i * GS2_PAGE_SIZE), "SYS_ROM");
-        }
-
-        if (!ll._FF_WRITE_ENABLE) {
-            megaii->map_page_write(i+0xE0, banke0 + (i * GS2_PAGE_SIZE), "LC RAM");
-        } else { // writes == WRITE_NONE - set it to the ROM and can_write = 0
-            megaii->map_page_write(i+0xE0, nullptr, "NONE"); // much simpler actually.. no write enable means null write pointer.
-        }
-    }
+    int v = iie_bsr_index(ll.FF_BANK_1 == 1, ll.FF_READ_ENABLE, !ll._FF_WRITE_ENABLE, g_altzp);
+    megaii->apply_page_maps(0xD0, 0x30, maps->bsr[v]);
 
     /* if (DEBUG(DEBUG_LANGCARD)) {
         lc->mmu->dump_page_table(0xD0, 0xD0);
@@ -735,6 +640,42 @@ void MMU_IIgs::reset() {
     }
 }
 
+void MMU_IIgs::save_state(SnapshotWriter &w) {
+    w.put(reg_slot);
+    w.put(reg_shadow);
+    w.put(reg_speed);
+    w.put(reg_state);
+    w.put(reg_new_video);
+    w.put(g_80store);
+    w.put(g_hires);
+    w.put(g_text);
+    w.put(g_mixed);
+    w.put(ll.FF_BANK_1);
+    w.put(ll.FF_READ_ENABLE);
+    w.put(ll.FF_PRE_WRITE);
+    w.put(ll._FF_WRITE_ENABLE);
+    w.put_memory(main_ram, get_memory_size());
+}
+
+// registers are put back as-is (no set_*_register side effects); the clock and
+// Mega II restore their own halves. Then rebuild the maps from the registers.
+bool MMU_IIgs::load_state(SnapshotReader &r) {
+    uint8_t slot, speed, state, new_video;
+    bool ok = r.get(slot) && r.get(reg_shadow) && r.get(speed) && r.get(state) && r.get(new_video)
+        && r.get(g_80store) && r.get(g_hires) && r.get(g_text) && r.get(g_mixed)
+        && r.get(ll.FF_BANK_1) && r.get(ll.FF_READ_ENABLE) && r.get(ll.FF_PRE_WRITE) && r.get(ll._FF_WRITE_ENABLE)
+        && r.get_memory(main_ram, get_memory_size());
+    if (!ok) return false;
+    reg_slot = slot;
+    reg_speed = speed;
+    reg_state = state;
+    reg_new_video = new_video;
+    set_ram_shadow_banks();
+    megaii_compose_map();
+    bsr_map_memory();
+    return true;
+}
+
 void MMU_IIgs::debug_dump(DebugFormatter *df) {
     df->addLine("LC: BANK_1: %d, READ_ENABLE: %d, PRE_WRITE: %d, /WRITE_ENABLE: %d", ll.FF_BANK_1, ll.FF_READ_ENABLE, ll.FF_PRE_WRITE, ll._FF_WRITE_ENABLE);
     df->addLine("Shadow: %02X: ![IOLC: %d T2: %d AUXH: %d SHR: %d H2: %d H1: %d T1: %d]",
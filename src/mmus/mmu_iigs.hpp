@@ -2,6 +2,7 @@
 
 #include "mmu.hpp"
 #include "mmu_iie.hpp"
+#include "iie_map_templates.hpp"
 #include "iigs_shadow_flags.hpp"
 #include "debug.hpp"
 #include "NClock.hpp"
@@ -60,6 +61,7 @@ class MMU_IIgs : public MMU {
         bool m_all_w = false; //
 
         bool map_initialized = false;
+        iie_map_templates_t *maps = nullptr; // precomputed Mega II aux / BSR page maps
 
         bool is_rom03 = false;
 
@@ -76,9 +78,15 @@ class MMU_IIgs : public MMU {
             rom_banks = rom_size / BANK_SIZE;
             main_rom = rom;
             map_initialized = false;
+            maps = new iie_map_templates_t;
+            iie_map_templates_build(maps, megaii->get_memory_base(), megaii->get_rom_base());
+            // ROM banks set the fast-ROM cycle type in read() / write().
+            for (page_t bank = 0xFC; bank <= 0xFF; bank++) {
+                set_page_trap(bank, PT_TRAP_READ | PT_TRAP_WRITE);
+            }
             reset();
         };
-        virtual ~MMU_IIgs() { delete[] main_ram; /* main_rom is owned by caller */ }
+        virtual ~MMU_IIgs() { delete[] main_ram; delete maps; /* main_rom is owned by caller */ }
 
         virtual uint8_t read(uint32_t address) override {
             if (address >= 0xFC0000) set_next_cycle_type(CYCLE_TYPE_FAST_ROM); // rom access is fast.
@@ -92,6 +100,16 @@ class MMU_IIgs : public MMU {
             MMU::write(address, value);
         }
 
+        // ROM banks are trapped (for the cycle type), so hand out their pointer
+        // directly and have the fetch set FAST_ROM through fetch_notify().
+        // Banks 00/01 are handler pages (I/O, LC, aux) and stay on read().
+        virtual uint8_t *get_fetch_page(uint32_t address) override {
+            if (address >= 0xFC0000) return page_table[address >> page_size_bits].read_p;
+            return MMU::get_fetch_page(address);
+        }
+        virtual bool fetch_needs_notify(uint32_t address) override { return address >= 0xFC0000; }
+        virtual void fetch_notify(uint32_t address) override { set_next_cycle_type(CYCLE_TYPE_FAST_ROM); }
+
         inline bool shadow_is_enabled(uint32_t address) {
             uint32_t address_16 = address & 0xFFFF;
             uint32_t address_17 = address & 0x1FFFF;
@@ -201,6 +219,9 @@ class MMU_IIgs : public MMU {
         virtual void init_map();
         virtual void reset() override;
         void debug_dump(DebugFormatter *df);
+        /** FPI registers, LC state and fast RAM. Mega II state is saved by the Mega II. */
+        void save_state(SnapshotWriter &w);
+        bool load_state(SnapshotReader &r);
 
         inline void set_clock(NClockII *clock) { this->clock = clock; }
         inline void set_clock_mode(clock_mode_t mode) { clock->set_clock_mode(mode); }
@@ -7,7 +7,7 @@
 #include "DisplaySelect.hpp"
 #include "util/MenuInterface.h"
 
-HoverControls_t::HoverControls_t(UIContext *ctx, const Style_t& initial_style, NClock *clock) : 
+HoverControls_t::HoverControls_t(UIContext *ctx, const Style_t& initial_style, computer_t *computer) : 
     FadeContainer_t(ctx, initial_style) {
     mi = getMenuInterface();
 
@@ -46,7 +46,7 @@ HoverControls_t::HoverControls_t(UIContext *ctx, const Style_t& initial_style, N
         });
         add(b2);
 
-        hov_speed_con = new SpeedSelect_t(ctx, SB, clock);
+        hov_speed_con = new SpeedSelect_t(ctx, SB, computer);
         hov_speed_con->set_visible(false);
 
         hov_display_con = new DisplaySelect(ctx, SB);
@@ -33,7 +33,7 @@ protected:
     MenuInterface *mi = nullptr;
 
 public:
-    HoverControls_t(UIContext *ctx, const Style_t& initial_style = Style_t(), NClock *clock = nullptr);
+    HoverControls_t(UIContext *ctx, const Style_t& initial_style = Style_t(), computer_t *computer = nullptr);
     ~HoverControls_t();
     virtual void update() override;
 };
\ No newline at end of file
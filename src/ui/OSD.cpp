@@ -371,23 +371,23 @@ OSD::OSD(computer_t *computer, SDL_Renderer *rendererp, SDL_Window *windowp, Slo
     speed_btn_14 = speed_btns[3];
     speed_btn_8 = speed_btns[4];
     speed_btn_10->on_click([this](const SDL_Event&) -> bool {
-        this->clock->set_clock_mode(CLOCK_1_024MHZ);
+        this->computer->request_clock_mode(CLOCK_1_024MHZ);
         return true;
     });
     speed_btn_28->on_click([this](const SDL_Event&) -> bool {
-        this->clock->set_clock_mode(CLOCK_2_8MHZ);
+        this->computer->request_clock_mode(CLOCK_2_8MHZ);
         return true;
     });
     speed_btn_71->on_click([this](const SDL_Event&) -> bool {
-        this->clock->set_clock_mode(CLOCK_7_159MHZ);
+        this->computer->request_clock_mode(CLOCK_7_159MHZ);
         return true;
     });
     speed_btn_14->on_click([this](const SDL_Event&) -> bool {
-        this->clock->set_clock_mode(CLOCK_14_3MHZ);
+        this->computer->request_clock_mode(CLOCK_14_3MHZ);
         return true;
     });
     speed_btn_8->on_click([this](const SDL_Event&) -> bool {
-        this->clock->set_clock_mode(CLOCK_FREE_RUN);
+        this->computer->request_clock_mode(CLOCK_FREE_RUN);
         return true;
     });
 
@@ -445,7 +445,7 @@ OSD::OSD(computer_t *computer, SDL_Renderer *rendererp, SDL_Window *windowp, Slo
     SB.border_color = 0x000000FF;
     SB.padding = 0;
 
-    hover_controls_con = new HoverControls_t(&ui_ctx, SB, clock);
+    hover_controls_con = new HoverControls_t(&ui_ctx, SB, computer);
     ncontainers.push_back(hover_controls_con);
 
     system_config = computer->get_system();
@@ -3,7 +3,7 @@
 #include "MainAtlas.hpp"
 #include "NClock.hpp"
 
-SpeedSelect_t::SpeedSelect_t(UIContext *ctx, const Style_t& initial_style, NClock *clock) : Container_t(ctx, initial_style), clock(clock) {
+SpeedSelect_t::SpeedSelect_t(UIContext *ctx, const Style_t& initial_style, computer_t *computer) : Container_t(ctx, initial_style), computer(computer) {
     Style_t CB = {
         .background_color = 0x00000000,
         .border_color = 0x000000FF,
@@ -26,7 +26,7 @@ SpeedSelect_t::SpeedSelect_t(UIContext *ctx, const Style_t& initial_style, NCloc
         Tile_t *tile = tiles[i];
         tile->on_click([this,tile](const SDL_Event& event) -> bool {
             this->selected_value(tile->value());
-            this->clock->set_clock_mode((clock_mode_t)tile->value());
+            this->computer->request_clock_mode((clock_mode_t)tile->value());
             this->set_visible(false);
             return true;
         });
@@ -43,7 +43,7 @@ void SpeedSelect_t::set_visible(bool visible) {
         assert(true);
     } */
     if (visible) {
-        this->selected_value(this->clock->get_clock_mode());
+        this->selected_value(this->computer->requested_clock_mode());
     }
 }
 
@@ -1,13 +1,13 @@
 #pragma once
 
 #include "Container.hpp"
-#include "NClock.hpp"
+#include "computer.hpp"
 
 class SpeedSelect_t : public Container_t {
 protected:
-    NClock *clock = nullptr;
+    computer_t *computer = nullptr;
 public:
-    SpeedSelect_t(UIContext *ctx, const Style_t& initial_style = Style_t(), NClock *clock = nullptr);
+    SpeedSelect_t(UIContext *ctx, const Style_t& initial_style = Style_t(), computer_t *computer = nullptr);
     ~SpeedSelect_t();
     virtual void set_visible(bool visible) override;
     virtual void render() override;
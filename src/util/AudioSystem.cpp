@@ -44,8 +44,8 @@ AudioSystem::AudioSystem(computer_t *computer) {
 
         // Re-apply per-stream gain (defensive; should survive on its own).
         for (auto &streamr : allocated_streams) {
-            if (streamr.apply_volume) {
-                SDL_SetAudioStreamGain(streamr.stream, gain);
+            if (streamr.apply_volume || muted) {
+                SDL_SetAudioStreamGain(streamr.stream, stream_gain(streamr));
             }
         }
 
@@ -99,7 +99,9 @@ SDL_AudioStream *AudioSystem::create_stream(int sample_rate, int channels, SDL_A
         SDL_Log("Couldn't create audio stream: %s", SDL_GetError());
         return nullptr;
     }
-    if (!SDL_BindAudioStream(device_id, stream)) {  /* once bound, it'll start playing when there is data available! */
+    if (detached) {
+        SDL_SetAudioStreamFormat(stream, nullptr, &spec);
+    } else if (!SDL_BindAudioStream(device_id, stream)) {  /* once bound, it'll start playing when there is data available! */
         SDL_Log("Failed to bind speaker stream to device: %s", SDL_GetError());
         return nullptr;
     }
@@ -111,6 +113,9 @@ SDL_AudioStream *AudioSystem::create_stream(int sample_rate, int channels, SDL_A
         apply_volume
     };
     allocated_streams.push_back(streamr);
+    if (muted) {
+        SDL_SetAudioStreamGain(stream, 0.0f);
+    }
     return stream;
 }
 
@@ -121,12 +126,15 @@ void AudioSystem::update_stream(SDL_AudioStream *stream, int sample_rate, int ch
             streamr.channels = channels;
             streamr.sample_format = sample_format;
             streamr.apply_volume = apply_volume;
+            if (muted) {
+                SDL_SetAudioStreamGain(stream, 0.0f);
+            }
             SDL_AudioSpec spec = {
                 sample_format,
                 channels,
                 sample_rate
             };
-            SDL_SetAudioStreamFormat(stream, &spec, nullptr);
+            SDL_SetAudioStreamFormat(stream, &spec, detached ? &spec : nullptr);
             return;
         }
     }
@@ -154,13 +162,44 @@ void AudioSystem::resume() {
     SDL_ResumeAudioDevice(device_id);
 }
 
+void AudioSystem::detach_streams() {
+    detached = true;
+    for (auto &streamr : allocated_streams) {
+        SDL_UnbindAudioStream(streamr.stream);
+        SDL_AudioSpec spec = {
+            streamr.sample_format,
+            streamr.channels,
+            streamr.sample_rate
+        };
+        SDL_SetAudioStreamFormat(streamr.stream, nullptr, &spec);
+    }
+}
+
+void AudioSystem::drain_streams(const std::function<void(const uint8_t *data, int len)> &sink) {
+    uint8_t buffer[4096];
+    for (auto &streamr : allocated_streams) {
+        int got;
+        while ((got = SDL_GetAudioStreamData(streamr.stream, buffer, sizeof(buffer))) > 0) {
+            sink(buffer, got);
+        }
+    }
+}
+
 void AudioSystem::set_volume(uint16_t volume) {
     if (volume > 15) volume = 15;
     volume_setting = volume;
     gain = (float)volume / 16.0f;
     for (auto &streamr : allocated_streams) {
-        if (streamr.apply_volume) {
+        if (streamr.apply_volume && !muted) {
             SDL_SetAudioStreamGain(streamr.stream, gain);
         }
     }
 }
+
+void AudioSystem::set_mute(bool mute) {
+    if (mute == muted) return;
+    muted = mute;
+    for (auto &streamr : allocated_streams) {
+        SDL_SetAudioStreamGain(streamr.stream, stream_gain(streamr));
+    }
+}
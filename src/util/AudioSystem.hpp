@@ -28,8 +28,15 @@ private:
     uint16_t volume_setting = 6;
     float gain = 1.0f;
     bool decorrelation_enabled = true;
+    bool detached = false;
+    bool muted = false;
     void printSpec(SDL_AudioSpec spec);
 
+    inline float stream_gain(const audio_stream_t &streamr) const {
+        if (muted) return 0.0f;
+        return streamr.apply_volume ? gain : 1.0f;
+    }
+
     // Callbacks invoked when the audio device format changes (e.g. user
     // switches default output device).  Each audio generator registers one
     // to reset its own timing state after the stream has been cleared.
@@ -48,6 +55,16 @@ public:
 
     void pause();
     void resume();
+
+    /**
+     * Unbind every stream (and any created later) from the playback device and
+     * make each output its own format. Nothing plays any more; the caller pulls
+     * the generated samples with drain_streams(). Used by gs2headless so audio
+     * output doesn't depend on how fast a real device consumes it.
+     */
+    void detach_streams();
+    /** Pull everything queued on every stream, in creation order. */
+    void drain_streams(const std::function<void(const uint8_t *data, int len)> &sink);
     void flush_stream(SDL_AudioStream *stream) { SDL_FlushAudioStream(stream); }
 
     SDL_AudioDeviceID get_audio_device_id();
@@ -62,6 +79,9 @@ public:
     void set_volume(uint16_t volume); // Apply volume to all streams marked "apply_volume=true"
     inline float get_gain() { return gain; }
     inline uint16_t get_volume() { return volume_setting; }
+    /** Silence every stream (including ones created later) without touching the volume setting. */
+    void set_mute(bool mute);
+    inline bool get_mute() const { return muted; }
     void getCurrentAudioFormat(DebugFormatter *df);
 
     // Register a callback to be invoked when the audio device format changes.
@@ -88,9 +108,7 @@ public:
     inline void set_decorrelation(bool v) { decorrelation_enabled = v; }
     inline void toggle_decorrelation()    { decorrelation_enabled = !decorrelation_enabled; }
 
-    /*     void set_mute(bool mute); // TODO: leave here for ideas.
-    bool get_mute();
-    void set_balance(float balance);
+    /*     void set_balance(float balance);
     float get_balance();
     void set_pan(float pan); */
 };
\ No newline at end of file
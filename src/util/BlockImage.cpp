@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "BlockImage.hpp"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define GS2_BLOCKIMAGE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define GS2_BLOCKIMAGE_MMAP 0
+#endif
+
+BlockImage::~BlockImage() {
+    close();
+}
+
+bool BlockImage::open(const media_descriptor *media) {
+    close();
+
+    if (media->block_size == 0 || media->block_size > MAX_BLOCK_SIZE) {
+        std::cerr << "BlockImage: unsupported block size " << media->block_size << " in " << media->filename << std::endl;
+        return false;
+    }
+    data_offset = media->data_offset;
+    block_count = media->block_count;
+    block_size = media->block_size;
+    writable = !media->write_protected;
+    stats = Stats();
+
+    if (media->data_size >= MMAP_THRESHOLD && open_mapped(media)) {
+        return true;
+    }
+
+    fp = fopen(media->filename.c_str(), writable ? "r+b" : "rb");
+    if (fp == nullptr) {
+        std::cerr << "Could not open ProDOS block device file: " << media->filename << std::endl;
+        return false;
+    }
+    ra_buf.resize((size_t)READ_AHEAD_BLOCKS * block_size);
+    ra_count = 0;
+    return true;
+}
+
+// Falls back to stdio (returns false) on any failure rather than refusing the mount.
+bool BlockImage::open_mapped(const media_descriptor *media) {
+#if GS2_BLOCKIMAGE_MMAP
+    int fd = ::open(media->filename.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < data_offset + (uint64_t)block_count * block_size) {
+        ::close(fd);
+        return false;
+    }
+    map_len = (size_t)st.st_size;
+    int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    void *p = mmap(nullptr, map_len, prot, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping holds its own reference to the file
+    if (p == MAP_FAILED) {
+        std::cerr << "BlockImage: mmap of " << media->filename << " failed: " << strerror(errno) << ", using stdio" << std::endl;
+        map_len = 0;
+        return false;
+    }
+    map = (uint8_t *)p;
+    long ps = sysconf(_SC_PAGESIZE);
+    page_size = ps > 0 ? (size_t)ps : 4096;
+    dirty_pages.assign((map_len + page_size - 1) / page_size, 0);
+    return true;
+#else
+    (void)media;
+    return false;
+#endif
+}
+
+void BlockImage::close() {
+#if GS2_BLOCKIMAGE_MMAP
+    if (map) {
+        flush_mapped();
+        // Unlike the periodic flush, wait for the data to hit the disk.
+        msync(map, map_len, MS_SYNC);
+        munmap(map, map_len);
+        map = nullptr;
+        map_len = 0;
+        dirty_pages.clear();
+    }
+#endif
+    if (fp) {
+        flush_pending();
+        if (!pending.empty()) {
+            std::cerr << "BlockImage: " << pending.size() << " block(s) could not be written back" << std::endl;
+            pending.clear();
+        }
+        fclose(fp);
+        fp = nullptr;
+    }
+    ra_buf.clear();
+    ra_count = 0;
+    dirty = false;
+    write_error = false;
+}
+
+bool BlockImage::read_block(uint32_t block, uint8_t *buf) {
+    if (block >= block_count) return false;
+    stats.reads++;
+
+    if (map) {
+        // no hit count: whether the page was resident is up to the kernel.
+        memcpy(buf, map + data_offset + (uint64_t)block * block_size, block_size);
+        return true;
+    }
+    if (fp == nullptr) return false;
+
+    auto it = pending.find(block);
+    if (it != pending.end()) {
+        memcpy(buf, it->second.data(), block_size);
+        stats.read_hits++;
+        return true;
+    }
+    if (block >= ra_first && block < ra_first + ra_count) {
+        memcpy(buf, ra_buf.data() + (size_t)(block - ra_first) * block_size, block_size);
+        stats.read_hits++;
+        return true;
+    }
+
+    // Miss: pull in the aligned window holding this block. ProDOS reads
+    // index blocks and then the data blocks that follow, so the rest of the
+    // window is usually wanted next.
+    uint32_t first = block - (block % READ_AHEAD_BLOCKS);
+    uint32_t count = READ_AHEAD_BLOCKS;
+    if (first + count > block_count) count = block_count - first;
+    ra_count = 0;
+    if (fseek(fp, (long)(data_offset + (uint64_t)first * block_size), SEEK_SET) != 0) return false;
+    size_t got = fread(ra_buf.data(), block_size, count, fp);
+    if (got <= block - first) return false;
+    ra_first = first;
+    ra_count = (uint32_t)got;
+    // Blocks still waiting to be written are newer than what's on disk.
+    for (auto p = pending.lower_bound(first); p != pending.end() && p->first < first + ra_count; ++p) {
+        memcpy(ra_buf.data() + (size_t)(p->first - first) * block_size, p->second.data(), block_size);
+    }
+    memcpy(buf, ra_buf.data() + (size_t)(block - first) * block_size, block_size);
+    return true;
+}
+
+bool BlockImage::write_block(uint32_t block, const uint8_t *buf) {
+    if (block >= block_count || !writable) return false;
+    stats.writes++;
+    // An earlier flush failed. The data is still held for the next flush, but
+    // fail this write so the guest sees an I/O error.
+    bool ok = !write_error;
+    write_error = false;
+
+    if (map) {
+        uint64_t off = data_offset + (uint64_t)block * block_size;
+        memcpy(map + off, buf, block_size);
+        for (size_t pg = off / page_size; pg <= (off + block_size - 1) / page_size; pg++) {
+            dirty_pages[pg] = 1;
+        }
+        dirty = true;
+        return ok;
+    }
+    if (fp == nullptr) return false;
+
+    pending[block].assign(buf, buf + block_size);
+    if (block >= ra_first && block < ra_first + ra_count) {
+        memcpy(ra_buf.data() + (size_t)(block - ra_first) * block_size, buf, block_size);
+    }
+    dirty = true;
+    // Don't let a long write burst hold unbounded memory.
+    if (pending.size() >= MAX_PENDING_BLOCKS) flush_pending();
+    return ok;
+}
+
+void BlockImage::flush() {
+    if (!dirty) return;
+    if (map) flush_mapped();
+    else if (fp) flush_pending();
+}
+
+void BlockImage::flush_mapped() {
+#if GS2_BLOCKIMAGE_MMAP
+    size_t npages = dirty_pages.size();
+    bool any = false;
+    for (size_t pg = 0; pg < npages; ) {
+        if (!dirty_pages[pg]) {
+            pg++;
+            continue;
+        }
+        size_t run = pg;
+        while (run < npages && dirty_pages[run]) {
+            dirty_pages[run] = 0;
+            run++;
+        }
+        size_t start = pg * page_size;
+        size_t len = std::min(run * page_size, map_len) - start;
+        // MS_ASYNC schedules the writeback and returns; the kernel does the I/O.
+        if (msync(map + start, len, MS_ASYNC) != 0) {
+            std::cerr << "BlockImage: msync failed: " << strerror(errno) << std::endl;
+            std::fill(dirty_pages.begin() + pg, dirty_pages.begin() + run, 1);
+            write_error = true;
+            pg = run;
+            continue;
+        }
+        stats.bytes_written += len;
+        any = true;
+        pg = run;
+    }
+    if (any) stats.flushes++;
+    dirty = std::find(dirty_pages.begin(), dirty_pages.end(), 1) != dirty_pages.end();
+#else
+    dirty = false;
+#endif
+}
+
+void BlockImage::flush_pending() {
+    if (pending.empty()) {
+        dirty = false;
+        return;
+    }
+    std::vector<uint8_t> run;
+    auto it = pending.begin();
+    while (it != pending.end()) {
+        // Gather consecutive blocks into one write.
+        uint32_t first = it->first;
+        uint32_t next = first;
+        run.clear();
+        while (it != pending.end() && it->first == next) {
+            run.insert(run.end(), it->second.begin(), it->second.end());
+            ++it;
+            next++;
+        }
+        if (fseek(fp, (long)(data_offset + (uint64_t)first * block_size), SEEK_SET) != 0
+            || fwrite(run.data(), 1, run.size(), fp) != run.size()) {
+            std::cerr << "BlockImage: write error at block " << first << std::endl;
+            write_error = true;
+            continue;  // leave the run pending for the next flush
+        }
+        pending.erase(pending.find(first), it);
+        stats.bytes_written += run.size();
+    }
+    if (fflush(fp) != 0) {
+        std::cerr << "BlockImage: flush error: " << strerror(errno) << std::endl;
+        write_error = true;
+    }
+    stats.flushes++;
+    dirty = !pending.empty();
+}
+
+void BlockImage::debug(DebugFormatter *f) const {
+    if (!is_open()) {
+        f->addLine("  (not mounted)");
+        return;
+    }
+    f->addLine("  backend: %s  blocks: %u x %u  %s",
+        map ? "mmap" : "stdio", block_count, block_size, dirty ? "dirty" : "clean");
+    if (map) {
+        f->addLine("  reads: %llu", (unsigned long long)stats.reads);
+    } else {
+        double hit_rate = stats.reads ? (100.0 * stats.read_hits / stats.reads) : 0.0;
+        f->addLine("  reads: %llu  hits: %llu (%.1f%%)",
+            (unsigned long long)stats.reads, (unsigned long long)stats.read_hits, hit_rate);
+    }
+    f->addLine("  writes: %llu  flushes: %llu  bytes written: %llu",
+        (unsigned long long)stats.writes, (unsigned long long)stats.flushes, (unsigned long long)stats.bytes_written);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "util/media.hpp"
+#include "util/DebugFormatter.hpp"
+
+/**
+ * Block-addressed backing store shared by the ProDOS block cards (pdblock2,
+ * pdblock3).
+ *
+ * Images of MMAP_THRESHOLD bytes or more (hard disks) are mmap'd on POSIX
+ * hosts. A read is a memcpy out of the mapping, a write a memcpy into it
+ * plus a mark in the dirty-page map, and flush() passes each run of dirty
+ * pages to msync(MS_ASYNC). Anything else (floppy-sized images, Windows,
+ * Emscripten) goes through stdio: reads pull in READ_AHEAD_BLOCKS at a time,
+ * and writes are held until flush() writes each run of consecutive dirty
+ * blocks with a single fwrite.
+ *
+ * The cards call flush() from their frame handler once the guest has
+ * stopped issuing block calls for a moment, and close() on unmount and
+ * shutdown. Blocks or pages that fail to write stay dirty for the next
+ * flush, and the next write_block() returns false so the guest sees the
+ * I/O error.
+ */
+class BlockImage {
+public:
+    static constexpr uint64_t MMAP_THRESHOLD = 2 * 1024 * 1024;
+    static constexpr uint32_t READ_AHEAD_BLOCKS = 32;
+    static constexpr size_t   MAX_PENDING_BLOCKS = 256;
+    static constexpr uint16_t MAX_BLOCK_SIZE = 512;
+
+    struct Stats {
+        uint64_t reads = 0;
+        uint64_t read_hits = 0;      // stdio only: served from a buffer, no file I/O
+        uint64_t writes = 0;
+        uint64_t bytes_written = 0;  // bytes handed to msync / fwrite by flush()
+        uint64_t flushes = 0;
+    };
+
+    BlockImage() = default;
+    ~BlockImage();
+
+    BlockImage(const BlockImage &) = delete;
+    BlockImage &operator=(const BlockImage &) = delete;
+
+    /** Open media for block I/O. Returns false (and logs) on error. */
+    bool open(const media_descriptor *media);
+    /** Write back anything dirty, wait for it, and release the file. */
+    void close();
+
+    bool is_open() const { return map != nullptr || fp != nullptr; }
+    bool is_mapped() const { return map != nullptr; }
+    bool is_dirty() const { return dirty; }
+
+    /** buf holds block_size bytes. Return false on a bad block number or I/O error. */
+    bool read_block(uint32_t block, uint8_t *buf);
+    bool write_block(uint32_t block, const uint8_t *buf);
+
+    /**
+     * Write back dirty pages/blocks. For a mapping this only starts the
+     * write-back (MS_ASYNC); the stdio backend does its fwrite/fflush right
+     * here, on the calling (emulation) thread.
+     */
+    void flush();
+
+    const Stats &get_stats() const { return stats; }
+    void debug(DebugFormatter *f) const;
+
+private:
+    uint64_t data_offset = 0;
+    uint32_t block_count = 0;
+    uint16_t block_size = 0;
+    bool     writable = false;
+    bool     dirty = false;
+    bool     write_error = false;  // a flush failed; reported by the next write_block()
+
+    // mmap backend
+    uint8_t *map = nullptr;
+    size_t   map_len = 0;
+    size_t   page_size = 4096;
+    std::vector<uint8_t> dirty_pages;
+
+    // stdio backend
+    FILE    *fp = nullptr;
+    std::vector<uint8_t> ra_buf;          // read-ahead window
+    uint32_t ra_first = 0;
+    uint32_t ra_count = 0;
+    std::map<uint32_t, std::vector<uint8_t>> pending;  // dirty blocks, in block order
+
+    Stats stats;
+
+    bool open_mapped(const media_descriptor *media);
+    void flush_mapped();
+    void flush_pending();
+};
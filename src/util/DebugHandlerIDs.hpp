@@ -18,4 +18,6 @@
 #define DH_DISKII 0x0000000000000010
 #define DH_KEYBOARD 0x0000000000000011
 #define DH_SECOND_SIGHT 0x0000000000000012
-#define DH_APPLEMOUSEIII 0x0000000000000013
\ No newline at end of file
+#define DH_APPLEMOUSEIII 0x0000000000000013
+#define DH_PDBLOCK2 0x0000000000000014
+#define DH_PDBLOCK3 0x0000000000000015
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <limits>
 #include <iostream>
+#include <cstdio>
 #include "debug.hpp"
 //#include "cpu.hpp"
 
@@ -14,84 +15,183 @@ EventTimer::~EventTimer() = default;
 
 inline void EventTimer::updateNextEventCycle() {
     // Update next_event_cycle to the earliest event's trigger time
-    next_event_cycle = events.empty() ? std::numeric_limits<uint64_t>::max() : events.front().triggerCycles;
+    next_event_cycle = heap.empty() ? std::numeric_limits<uint64_t>::max() : heap.front().triggerCycles;
 }
 
-// Add a new event to the queue
+void EventTimer::sift_up(size_t i) {
+    HeapEntry entry = heap[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!earlier(entry, heap[parent])) break;
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, entry);
+}
+
+void EventTimer::sift_down(size_t i) {
+    size_t n = heap.size();
+    HeapEntry entry = heap[i];
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && earlier(heap[child + 1], heap[child])) child++;
+        if (!earlier(heap[child], entry)) break;
+        place(i, heap[child]);
+        i = child;
+    }
+    place(i, entry);
+}
+
+// take heap entry i out of the heap; fill the hole with the last entry and restore heap order.
+// the slot stays allocated (and indexed) with pos = NOT_QUEUED.
+void EventTimer::remove_at(size_t i) {
+    slots[heap[i].slot].pos = NOT_QUEUED;
+    size_t last = heap.size() - 1;
+    if (i != last) {
+        place(i, heap[last]);
+        heap.pop_back();
+        if (i > 0 && earlier(heap[i], heap[(i - 1) / 2])) sift_up(i);
+        else sift_down(i);
+    } else {
+        heap.pop_back();
+    }
+}
+
+void EventTimer::release_slot(uint32_t slot) {
+    index.erase(slots[slot].event.instanceID);
+    free_slots.push_back(slot);
+}
+
+// Add a new event to the queue, or move an existing event with the same instanceID.
 void EventTimer::scheduleEvent(uint64_t triggerCycles, void (*callback)(uint64_t, void*), uint64_t instanceID, void* userData) {
     if (DEBUG(DEBUG_EVENT_TIMER)) std::cout << "scheduleEvent: " << triggerCycles << " InstanceID: " << instanceID << std::endl;
     if (clock && triggerCycles < clock->get_cycles()) {
         std::cout << "scheduleEvent: Event in the past, skipping" << std::endl;
         return;
     }
-    // Check if an event with the same instanceID already exists
-    auto existingEvent = std::find_if(events.begin(), events.end(), 
-        [instanceID](const Event& event) { return event.instanceID == instanceID; });
-    
-    if (existingEvent != events.end()) {
-        // Replace the existing event with the new one
-        existingEvent->triggerCycles = triggerCycles;
-        existingEvent->triggerCallback = callback;
-        existingEvent->userData = userData;
-        
-        // Rebuild the heap after modifying an element
-        std::make_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles;
-        });
+    const uint64_t prev_next = next_event_cycle;
+    uint32_t slot;
+    auto existing = index.find(instanceID);
+    if (existing != index.end()) {
+        slot = existing->second;
+    } else {
+        if (free_slots.empty()) {
+            slot = (uint32_t)slots.size();
+            slots.push_back({});
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        slots[slot].pos = NOT_QUEUED;
+        index.emplace(instanceID, slot);
+    }
+    // a reschedule can change the callback or userData; load_state rebinds to the latest.
+    bindings[instanceID] = {callback, userData};
+    slots[slot].event = {triggerCycles, callback, instanceID, userData};
+
+    HeapEntry entry{triggerCycles, next_seq++, slot};
+    size_t pos = slots[slot].pos;
+    if (pos == NOT_QUEUED) {
+        heap.push_back(entry);
+        sift_up(heap.size() - 1);
     } else {
-        // Add a new event to the queue
-        Event newEvent{triggerCycles, callback, instanceID, userData};
-        events.push_back(newEvent);
-        std::push_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles; // Reverse for priority queue (earliest first)
-        });
+        // Replace the existing event in place, then move it up or down as needed.
+        bool moved_earlier = earlier(entry, heap[pos]);
+        place(pos, entry);
+        if (moved_earlier) sift_up(pos);
+        else sift_down(pos);
     }
     updateNextEventCycle();
+    if (deadline_watch && next_event_cycle < prev_next) *deadline_watch = 0;
 }
 
 // Process all events that should trigger by the given cycle count
 void EventTimer::processEvents(uint64_t currentCycles) {
-    /* std::cout << "processEvents: " << currentCycles << "Front: " << events.front().triggerCycles << std::endl;
-    // Print how many events are on the queue
-    if (!events.empty()) {
-        std::cout << "Events on queue: " << events.size() << std::endl;
-    } */
-    while (!events.empty() && events.front().triggerCycles <= currentCycles) {
-        Event event = events.front();
-        std::pop_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles;
-        });
-        events.pop_back();
+    while (!heap.empty() && heap.front().triggerCycles <= currentCycles) {
+        uint32_t slot = heap.front().slot;
+        remove_at(0);
+        Event event = slots[slot].event;
         if (DEBUG(DEBUG_EVENT_TIMER)) std::cout << "Processing event: " << event.triggerCycles << " InstanceID: " << event.instanceID << std::endl;
-        // Call the callback function
+        // Call the callback function. The slot is kept while it runs, so a
+        // callback that reschedules its own instance doesn't churn the index.
         if (event.triggerCallback) {
             event.triggerCallback(event.instanceID, event.userData);
         }
+        if (slots[slot].pos == NOT_QUEUED) {
+            // not rescheduled. release it, unless the callback already cancelled it.
+            auto existing = index.find(event.instanceID);
+            if (existing != index.end() && existing->second == slot) release_slot(slot);
+        }
     }
     updateNextEventCycle();
 }
 
 // Cancel all events for a specific instance
 void EventTimer::cancelEvents(uint64_t instanceID) {
-    auto newEnd = std::remove_if(events.begin(), events.end(),
-        [instanceID](const Event& event) { return event.instanceID == instanceID; });
-    
-    if (newEnd != events.end()) {
-        events.erase(newEnd, events.end());
-        // Rebuild the heap after removing elements
-        std::make_heap(events.begin(), events.end(), [](const Event& a, const Event& b) {
-            return a.triggerCycles > b.triggerCycles;
-        });
+    auto existing = index.find(instanceID);
+    if (existing != index.end()) {
+        uint32_t slot = existing->second;
+        if (slots[slot].pos != NOT_QUEUED) remove_at(slots[slot].pos);
+        release_slot(slot);
     }
     updateNextEventCycle();
 }
 
 // Check if there are any pending events
 bool EventTimer::hasPendingEvents() const {
-    return !events.empty();
+    return !heap.empty();
 }
 
 // Get the cycle count of the next event
 uint64_t EventTimer::getNextEventCycle() const {
     return next_event_cycle;
 }
+
+void EventTimer::registerCallback(uint64_t instanceID, void (*callback)(uint64_t, void*), void* userData) {
+    bindings[instanceID] = {callback, userData};
+}
+
+void EventTimer::save_state(SnapshotWriter &w) const {
+    std::vector<HeapEntry> pending(heap);
+    std::sort(pending.begin(), pending.end(), [this](const HeapEntry &a, const HeapEntry &b) { return earlier(a, b); });
+    w.put<uint32_t>((uint32_t)pending.size());
+    for (const HeapEntry &e : pending) {
+        w.put<uint64_t>(e.triggerCycles);
+        w.put<uint64_t>(slots[e.slot].event.instanceID);
+    }
+}
+
+bool EventTimer::load_state(SnapshotReader &r, std::string &err) {
+    uint32_t count = 0;
+    if (!r.get(count)) return false;
+    std::vector<std::pair<uint64_t, uint64_t>> pending;   // triggerCycles, instanceID
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t trigger, instanceID;
+        if (!r.get(trigger) || !r.get(instanceID)) return false;
+        if (bindings.find(instanceID) == bindings.end()) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "no event source for timer instance %08llX", (unsigned long long)instanceID);
+            err = buf;
+            return false;
+        }
+        pending.push_back({trigger, instanceID});
+    }
+
+    heap.clear();
+    slots.clear();
+    free_slots.clear();
+    index.clear();
+    next_seq = 0;
+
+    // the clock may not be restored yet, so skip scheduleEvent's "in the past" check.
+    NClockII *saved_clock = clock;
+    clock = nullptr;
+    for (auto &p : pending) {
+        const Binding &b = bindings[p.second];
+        scheduleEvent(p.first, b.callback, p.second, b.userData);
+    }
+    clock = saved_clock;
+    updateNextEventCycle();
+    return true;
+}
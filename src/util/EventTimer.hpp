@@ -1,10 +1,21 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "Snapshot.hpp"
 
 class NClockII;  // forward declare instead of include
 
+/*
+Cycle-driven event queue. Events live in a binary min-heap ordered by
+trigger cycle (ties fire in the order they were scheduled), with a hash
+index from instanceID to heap slot. Rescheduling or cancelling an
+instance is O(log n) rather than a scan of the whole queue.
+*/
 class EventTimer {
 public:
     struct Event {
@@ -25,8 +36,63 @@ public:
     uint64_t getNextEventCycle() const;
     inline bool isEventPassed(uint64_t currentCycles) { return currentCycles >= next_event_cycle; }
     void set_clock(NClockII *clock) { this->clock = clock; }
+    /** Zero *watch whenever an event is scheduled ahead of next_event_cycle (see exec_budget_t). */
+    void set_deadline_watch(uint64_t *watch) { deadline_watch = watch; }
+
+    /**
+     * Declare what an instanceID stands for, without scheduling it. Devices
+     * call this at init for every instanceID they will schedule, so a
+     * snapshot can be loaded into a machine that hasn't run yet.
+     */
+    void registerCallback(uint64_t instanceID, void (*callback)(uint64_t, void*), void* userData = nullptr);
+
+    /** Save pending events, in firing order. Callbacks are saved as their instanceID. */
+    void save_state(SnapshotWriter &w) const;
+    /**
+     * Replace the queue with saved events, re-binding each instanceID to the
+     * callback and userData registered (or last scheduled) with it on this
+     * timer. Fails and leaves the queue untouched if an instanceID is unknown.
+     */
+    bool load_state(SnapshotReader &r, std::string &err);
     
 private:
-    std::vector<Event> events;
+    // heap entries carry the sort key so sifting never chases a pointer.
+    struct HeapEntry {
+        uint64_t triggerCycles;
+        uint64_t seq;       // tie-breaker: scheduling order
+        uint32_t slot;      // index into slots
+    };
+    // one slot per live instanceID. pos is where it currently sits in the heap.
+    struct Slot {
+        Event event;
+        size_t pos;
+    };
+    static constexpr size_t NOT_QUEUED = SIZE_MAX;
+
+    std::vector<HeapEntry> heap;                        // heap[0] is the earliest event
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    std::unordered_map<uint64_t, uint32_t> index;       // instanceID -> slot
+    uint64_t next_seq = 0;
+    uint64_t *deadline_watch = nullptr;
+
+    // instanceID -> callback, from registerCallback or the last scheduleEvent. Outlives the event, for load_state.
+    struct Binding {
+        void (*callback)(uint64_t, void*);
+        void* userData;
+    };
+    std::unordered_map<uint64_t, Binding> bindings;
+
+    inline bool earlier(const HeapEntry &a, const HeapEntry &b) const {
+        return (a.triggerCycles < b.triggerCycles) || (a.triggerCycles == b.triggerCycles && a.seq < b.seq);
+    }
+    inline void place(size_t i, const HeapEntry &entry) {
+        heap[i] = entry;
+        slots[entry.slot].pos = i;
+    }
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+    void remove_at(size_t i);
+    void release_slot(uint32_t slot);
     void updateNextEventCycle();
 };
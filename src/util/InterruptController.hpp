@@ -91,6 +91,14 @@ class InterruptController {
         return irq_asserted != 0;
     }
 
+    inline uint64_t get_irq_mask() const { return irq_asserted; }
+
+    // for snapshot restore: put every line back at once.
+    inline void set_irq_mask(uint64_t mask) {
+        irq_asserted = mask;
+        notify_irq_receiver();
+    }
+
     inline void clear_all_irqs() {
         uint64_t old = irq_asserted;
         irq_asserted = 0;
@@ -0,0 +1,79 @@
+#include "JournalWriter.hpp"
+
+int SDLCALL JournalWriter::thread_entry(void *data) {
+    static_cast<JournalWriter *>(data)->worker_loop();
+    return 0;
+}
+
+JournalWriter::JournalWriter(const char *name) {
+    lock = SDL_CreateMutex();
+    wake = SDL_CreateCondition();
+    idle = SDL_CreateCondition();
+    if (lock && wake && idle) {
+        thread = SDL_CreateThread(thread_entry, name, this);
+    }
+    if (!thread) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "JournalWriter: SDL_CreateThread failed: %s", SDL_GetError());
+    }
+}
+
+JournalWriter::~JournalWriter() {
+    if (thread) {
+        SDL_LockMutex(lock);
+        quit = true;
+        SDL_SignalCondition(wake);
+        SDL_UnlockMutex(lock);
+        SDL_WaitThread(thread, nullptr);
+        thread = nullptr;
+    }
+    if (idle) SDL_DestroyCondition(idle);
+    if (wake) SDL_DestroyCondition(wake);
+    if (lock) SDL_DestroyMutex(lock);
+}
+
+void JournalWriter::submit(WriteJournal &&journal) {
+    if (!thread) {
+        if (journal.commit() != 0) failed = true;
+        return;
+    }
+    SDL_LockMutex(lock);
+    pending.push_back(std::move(journal));
+    SDL_SignalCondition(wake);
+    SDL_UnlockMutex(lock);
+}
+
+void JournalWriter::wait_idle() {
+    if (!thread) return;
+    SDL_LockMutex(lock);
+    while (busy || !pending.empty()) {
+        SDL_WaitCondition(idle, lock);
+    }
+    SDL_UnlockMutex(lock);
+}
+
+bool JournalWriter::take_failure() {
+    return failed.exchange(false);
+}
+
+void JournalWriter::worker_loop() {
+    SDL_LockMutex(lock);
+    while (true) {
+        // Drain the queue before honouring quit so nothing submitted is lost.
+        if (pending.empty()) {
+            if (quit) break;
+            SDL_WaitCondition(wake, lock);
+            continue;
+        }
+        WriteJournal journal = std::move(pending.front());
+        pending.pop_front();
+        busy = true;
+        SDL_UnlockMutex(lock);
+
+        if (journal.commit() != 0) failed = true;
+
+        SDL_LockMutex(lock);
+        busy = false;
+        if (pending.empty()) SDL_BroadcastCondition(idle);
+    }
+    SDL_UnlockMutex(lock);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+
+#include <SDL3/SDL.h>
+
+#include "util/WriteJournal.hpp"
+
+/**
+ * Commits WriteJournals on a worker thread, in the order they were submitted,
+ * so the emulation thread never blocks on pwrite/fsync. Journals carry copies
+ * of their data, so the submitter can keep mutating its own state.
+ */
+class JournalWriter {
+    std::deque<WriteJournal> pending;
+    bool busy = false;
+    bool quit = false;
+    std::atomic<bool> failed{false};
+    SDL_Mutex *lock = nullptr;
+    SDL_Condition *wake = nullptr;
+    SDL_Condition *idle = nullptr;
+    SDL_Thread *thread = nullptr;
+
+    static int SDLCALL thread_entry(void *data);
+    void worker_loop();
+
+public:
+    explicit JournalWriter(const char *name);
+    /** Finishes anything still queued. */
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter &) = delete;
+    JournalWriter &operator=(const JournalWriter &) = delete;
+
+    /** Queue a journal. Commits inline if the worker thread couldn't be started. */
+    void submit(WriteJournal &&journal);
+
+    /** Block until every submitted journal has been committed. */
+    void wait_idle();
+
+    /** True if a commit has failed since the last call. */
+    bool take_failure();
+};
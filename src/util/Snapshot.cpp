@@ -0,0 +1,188 @@
+#include <cstdio>
+
+#include "Snapshot.hpp"
+
+static const char SNAPSHOT_MAGIC[8] = { 'G', 'S', '2', 'S', 'N', 'A', 'P', '\0' };
+
+enum : uint8_t {
+    PAGE_ZERO = 0,
+    PAGE_RAW = 1,
+};
+
+static Snapshot::Page new_page() {
+    uint8_t *buf = new uint8_t[Snapshot::PAGE_SIZE];
+    return Snapshot::Page(buf, std::default_delete<uint8_t[]>());
+}
+
+const Snapshot::Page &Snapshot::zero_page() {
+    static const Page zero = [] {
+        Page p = new_page();
+        memset(const_cast<uint8_t *>(p.get()), 0, PAGE_SIZE);
+        return p;
+    }();
+    return zero;
+}
+
+bool Snapshot::is_zero(const uint8_t *p) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < PAGE_SIZE; i += sizeof(uint64_t)) {
+        uint64_t v;
+        memcpy(&v, p + i, sizeof(v));
+        acc |= v;
+    }
+    return acc == 0;
+}
+
+const Snapshot::Chunk *Snapshot::find(uint32_t tag) const {
+    for (const Chunk &c : chunks) {
+        if (c.tag == tag) return &c;
+    }
+    return nullptr;
+}
+
+void SnapshotWriter::put_bytes(const void *src, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(src);
+    chunk.data.insert(chunk.data.end(), p, p + len);
+}
+
+void SnapshotWriter::put_memory(const uint8_t *mem, size_t len) {
+    put<uint64_t>(len);
+    for (size_t off = 0; off < len; off += Snapshot::PAGE_SIZE) {
+        size_t n = (len - off < Snapshot::PAGE_SIZE) ? len - off : Snapshot::PAGE_SIZE;
+        size_t index = chunk.pages.size();
+
+        // unchanged since the base snapshot: share its page.
+        if (base && index < base->pages.size() && memcmp(base->pages[index].get(), mem + off, n) == 0) {
+            chunk.pages.push_back(base->pages[index]);
+            continue;
+        }
+        Snapshot::Page page = new_page();
+        uint8_t *dst = const_cast<uint8_t *>(page.get());
+        memcpy(dst, mem + off, n);
+        if (n < Snapshot::PAGE_SIZE) memset(dst + n, 0, Snapshot::PAGE_SIZE - n);
+        chunk.pages.push_back(Snapshot::is_zero(dst) ? Snapshot::zero_page() : page);
+    }
+}
+
+bool SnapshotReader::get_bytes(void *dst, size_t len) {
+    if (!good || chunk.data.size() - data_pos < len) {
+        good = false;
+        return false;
+    }
+    memcpy(dst, chunk.data.data() + data_pos, len);
+    data_pos += len;
+    return true;
+}
+
+bool SnapshotReader::get_memory(uint8_t *mem, size_t len) {
+    uint64_t stored = 0;
+    if (!get(stored)) return false;
+    size_t npages = (len + Snapshot::PAGE_SIZE - 1) / Snapshot::PAGE_SIZE;
+    if (stored != len || chunk.pages.size() - page_pos < npages) {
+        good = false;
+        return false;
+    }
+    for (size_t off = 0; off < len; off += Snapshot::PAGE_SIZE) {
+        size_t n = (len - off < Snapshot::PAGE_SIZE) ? len - off : Snapshot::PAGE_SIZE;
+        memcpy(mem + off, chunk.pages[page_pos++].get(), n);
+    }
+    return true;
+}
+
+bool Snapshot::write_file(const std::string &path, std::string &err) const {
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f) {
+        err = "cannot open " + path + " for writing";
+        return false;
+    }
+    bool ok = true;
+    auto put = [&](const void *p, size_t n) { if (ok && fwrite(p, 1, n, f) != n) ok = false; };
+
+    uint32_t format = FORMAT_VERSION;
+    uint32_t count = (uint32_t)chunks.size();
+    put(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put(&format, sizeof(format));
+    put(&platform, sizeof(platform));
+    put(&count, sizeof(count));
+
+    for (const Chunk &c : chunks) {
+        uint64_t data_len = c.data.size();
+        uint32_t npages = (uint32_t)c.pages.size();
+        put(&c.tag, sizeof(c.tag));
+        put(&c.version, sizeof(c.version));
+        put(&data_len, sizeof(data_len));
+        put(c.data.data(), c.data.size());
+        put(&npages, sizeof(npages));
+        for (const Page &p : c.pages) {
+            uint8_t kind = (p == zero_page()) ? PAGE_ZERO : PAGE_RAW;
+            put(&kind, sizeof(kind));
+            if (kind == PAGE_RAW) put(p.get(), PAGE_SIZE);
+        }
+    }
+    if (fclose(f) != 0) ok = false;
+    if (!ok) err = "error writing " + path;
+    return ok;
+}
+
+bool Snapshot::read_file(const std::string &path, std::string &err) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) {
+        err = "cannot open " + path;
+        return false;
+    }
+    bool ok = true;
+    auto get = [&](void *p, size_t n) { if (ok && fread(p, 1, n, f) != n) ok = false; return ok; };
+
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    uint32_t format = 0, count = 0;
+    get(magic, sizeof(magic));
+    get(&format, sizeof(format));
+    if (!ok || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        fclose(f);
+        err = path + " is not a snapshot";
+        return false;
+    }
+    if (format != FORMAT_VERSION) {
+        fclose(f);
+        err = path + ": unsupported snapshot format " + std::to_string(format);
+        return false;
+    }
+    get(&platform, sizeof(platform));
+    get(&count, sizeof(count));
+
+    chunks.clear();
+    for (uint32_t i = 0; ok && i < count; i++) {
+        Chunk c;
+        uint64_t data_len = 0;
+        uint32_t npages = 0;
+        get(&c.tag, sizeof(c.tag));
+        get(&c.version, sizeof(c.version));
+        if (!get(&data_len, sizeof(data_len)) || data_len > (1u << 30)) {
+            ok = false;
+            break;
+        }
+        c.data.resize(data_len);
+        get(c.data.data(), data_len);
+        get(&npages, sizeof(npages));
+        for (uint32_t p = 0; ok && p < npages; p++) {
+            uint8_t kind = 0;
+            if (!get(&kind, sizeof(kind))) break;
+            if (kind == PAGE_ZERO) {
+                c.pages.push_back(zero_page());
+            } else if (kind == PAGE_RAW) {
+                Page page = new_page();
+                get(const_cast<uint8_t *>(page.get()), PAGE_SIZE);
+                c.pages.push_back(page);
+            } else {
+                ok = false;
+            }
+        }
+        chunks.push_back(std::move(c));
+    }
+    fclose(f);
+    if (!ok) {
+        chunks.clear();
+        err = path + ": truncated or corrupt snapshot";
+    }
+    return ok;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Whole-machine snapshot.
+ *
+ * A snapshot is an ordered list of chunks, one per registered state owner
+ * (CPU, clock, event timers, MMU, devices). Each chunk has a four-character
+ * tag, its own version number, a blob of plain values, and zero or more
+ * memory regions stored as PAGE_SIZE pages.
+ *
+ * Pages are immutable and reference counted. A snapshot taken against a base
+ * snapshot shares every page that hasn't changed since, and all-zero pages
+ * share one static page, so taking a series of snapshots of a running machine
+ * only copies what was written in between. Restoring is a memcpy per page.
+ *
+ * On disk, zero pages are elided. Values are stored in host byte order; a
+ * snapshot file is meant to be loaded by the same build on the same kind of
+ * host that wrote it.
+ */
+
+constexpr uint32_t snapshot_tag(const char (&s)[5]) {
+    return (uint32_t)(uint8_t)s[0] | ((uint32_t)(uint8_t)s[1] << 8) | ((uint32_t)(uint8_t)s[2] << 16) | ((uint32_t)(uint8_t)s[3] << 24);
+}
+
+class Snapshot {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    using Page = std::shared_ptr<const uint8_t>;
+
+    struct Chunk {
+        uint32_t tag = 0;
+        uint32_t version = 0;
+        std::vector<uint8_t> data;
+        std::vector<Page> pages;
+    };
+
+    uint32_t platform = 0;
+    std::vector<Chunk> chunks;
+
+    const Chunk *find(uint32_t tag) const;
+
+    bool write_file(const std::string &path, std::string &err) const;
+    bool read_file(const std::string &path, std::string &err);
+
+    static const Page &zero_page();
+    static bool is_zero(const uint8_t *p);
+};
+
+/** Fills one chunk. Owners write values in a fixed order and read them back in the same order. */
+class SnapshotWriter {
+public:
+    SnapshotWriter(Snapshot::Chunk &chunk, const Snapshot::Chunk *base) : chunk(chunk), base(base) {}
+
+    template <typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+        put_bytes(&value, sizeof(T));
+    }
+    void put_bytes(const void *src, size_t len);
+
+    /** Store len bytes of memory as pages, sharing unchanged pages with the base snapshot. */
+    void put_memory(const uint8_t *mem, size_t len);
+
+private:
+    Snapshot::Chunk &chunk;
+    const Snapshot::Chunk *base;
+};
+
+/** Reads one chunk back. Reads past the end fail and leave ok() false. */
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const Snapshot::Chunk &chunk) : chunk(chunk) {}
+
+    template <typename T>
+    bool get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be trivially copyable");
+        return get_bytes(&value, sizeof(T));
+    }
+    bool get_bytes(void *dst, size_t len);
+
+    /** Restore len bytes of memory. Fails if the stored region is a different size. */
+    bool get_memory(uint8_t *mem, size_t len);
+
+    inline uint32_t version() const { return chunk.version; }
+    inline bool ok() const { return good; }
+
+private:
+    const Snapshot::Chunk &chunk;
+    size_t data_pos = 0;
+    size_t page_pos = 0;
+    bool good = true;
+};
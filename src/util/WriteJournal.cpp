@@ -0,0 +1,220 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "WriteJournal.hpp"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define GS2_JOURNAL_POSIX 1
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define GS2_JOURNAL_POSIX 0
+#ifdef _WIN32
+#include <io.h>
+#endif
+#endif
+
+// Layout: magic, u32 version, u32 record count, then per record u64 offset,
+// u32 length, bytes; finally a u64 FNV-1a of everything before it. A journal
+// whose checksum doesn't match was torn mid-write and is simply dropped.
+static const char JOURNAL_MAGIC[8] = { 'G', 'S', '2', 'J', 'R', 'N', 'L', '\0' };
+static constexpr uint32_t JOURNAL_VERSION = 1;
+
+static uint64_t fnv1a(const uint8_t *p, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    while (n--) {
+        h ^= *p++;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+template <typename T>
+static void put(std::vector<uint8_t> &out, T val) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&val);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+static bool get(const std::vector<uint8_t> &in, size_t &pos, T &val) {
+    if (in.size() - pos < sizeof(T)) return false;
+    memcpy(&val, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+static bool sync_file(FILE *f) {
+    if (fflush(f) != 0) return false;
+#if GS2_JOURNAL_POSIX
+    return fsync(fileno(f)) == 0;
+#elif defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#else
+    return true;
+#endif
+}
+
+// Make the journal's directory entry durable, or a crash could lose the
+// journal while keeping half of the writes it describes.
+static void sync_parent_dir(const std::string &path) {
+#if GS2_JOURNAL_POSIX
+    size_t slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash ? slash : 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+void WriteJournal::add(uint64_t offset, const uint8_t *data, size_t len) {
+    if (!records.empty()) {
+        Record &last = records.back();
+        if (last.offset + last.data.size() == offset) {
+            last.data.insert(last.data.end(), data, data + len);
+            return;
+        }
+    }
+    records.push_back({offset, std::vector<uint8_t>(data, data + len)});
+}
+
+std::vector<uint8_t> WriteJournal::serialize() const {
+    std::vector<uint8_t> out(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+    put<uint32_t>(out, JOURNAL_VERSION);
+    put<uint32_t>(out, static_cast<uint32_t>(records.size()));
+    for (const Record &r : records) {
+        put<uint64_t>(out, r.offset);
+        put<uint32_t>(out, static_cast<uint32_t>(r.data.size()));
+        out.insert(out.end(), r.data.begin(), r.data.end());
+    }
+    put<uint64_t>(out, fnv1a(out.data(), out.size()));
+    return out;
+}
+
+bool WriteJournal::parse(const std::vector<uint8_t> &blob, std::vector<Record> &out) {
+    if (blob.size() < sizeof(JOURNAL_MAGIC) + 16 || memcmp(blob.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        return false;
+    }
+    size_t body = blob.size() - sizeof(uint64_t);
+    uint64_t stored;
+    memcpy(&stored, blob.data() + body, sizeof(stored));
+    if (stored != fnv1a(blob.data(), body)) return false;
+
+    size_t pos = sizeof(JOURNAL_MAGIC);
+    uint32_t version = 0, count = 0;
+    get(blob, pos, version);
+    get(blob, pos, count);
+    if (version != JOURNAL_VERSION) return false;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t offset;
+        uint32_t len;
+        if (!get(blob, pos, offset) || !get(blob, pos, len) || body - pos < len) return false;
+        out.push_back({offset, std::vector<uint8_t>(blob.begin() + pos, blob.begin() + pos + len)});
+        pos += len;
+    }
+    return pos == body;
+}
+
+int WriteJournal::apply(const std::string &path, const std::vector<Record> &records) {
+#if GS2_JOURNAL_POSIX
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0) {
+        std::cerr << "WriteJournal: cannot open '" << path << "': " << strerror(errno) << "\n";
+        return -1;
+    }
+    bool ok = true;
+    for (const Record &r : records) {
+        if (::pwrite(fd, r.data.data(), r.data.size(), (off_t)r.offset) != (ssize_t)r.data.size()) {
+            ok = false;
+            break;
+        }
+    }
+    if (ok && fsync(fd) != 0) ok = false;
+    ::close(fd);
+#else
+    FILE *f = fopen(path.c_str(), "r+b");
+    if (!f) {
+        std::cerr << "WriteJournal: cannot open '" << path << "'\n";
+        return -1;
+    }
+    bool ok = true;
+    for (const Record &r : records) {
+        if (fseek(f, (long)r.offset, SEEK_SET) != 0 || fwrite(r.data.data(), 1, r.data.size(), f) != r.data.size()) {
+            ok = false;
+            break;
+        }
+    }
+    if (ok && !sync_file(f)) ok = false;
+    fclose(f);
+#endif
+    if (!ok) {
+        std::cerr << "WriteJournal: write error on '" << path << "'\n";
+        return -1;
+    }
+    return 0;
+}
+
+int WriteJournal::commit() {
+    if (records.empty()) return 0;
+
+    std::string jpath = journal_path(path);
+    std::vector<uint8_t> blob = serialize();
+    FILE *f = fopen(jpath.c_str(), "wb");
+    if (!f) {
+        std::cerr << "WriteJournal: cannot create '" << jpath << "'\n";
+        return -1;
+    }
+    bool ok = fwrite(blob.data(), 1, blob.size(), f) == blob.size() && sync_file(f);
+    fclose(f);
+    if (!ok) {
+        std::cerr << "WriteJournal: write error on '" << jpath << "'\n";
+        remove(jpath.c_str());
+        return -1;
+    }
+    sync_parent_dir(jpath);
+
+    // From here on the journal is the source of truth: if applying fails it
+    // stays behind for recover() to finish.
+    if (apply(path, records) != 0) return -1;
+    remove(jpath.c_str());
+    records.clear();
+    return 0;
+}
+
+int WriteJournal::recover(const std::string &path) {
+    std::string jpath = journal_path(path);
+    FILE *f = fopen(jpath.c_str(), "rb");
+    if (!f) return 0;  // nothing interrupted
+
+    std::vector<uint8_t> blob;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        blob.insert(blob.end(), buf, buf + n);
+    }
+    fclose(f);
+
+    std::vector<Record> records;
+    if (!parse(blob, records)) {
+        // Torn while being written, so none of it reached the file yet.
+        std::cerr << "WriteJournal: discarding incomplete journal '" << jpath << "'\n";
+        remove(jpath.c_str());
+        return 0;
+    }
+    std::cerr << "WriteJournal: replaying " << records.size() << " write(s) into '" << path << "'\n";
+    if (apply(path, records) != 0) return -1;
+    remove(jpath.c_str());
+    return 0;
+}
+
+void WriteJournal::discard(const std::string &path) {
+    std::string jpath = journal_path(path);
+    if (remove(jpath.c_str()) == 0) {
+        std::cerr << "WriteJournal: discarded '" << jpath << "'\n";
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A batch of in-place writes to one file, applied all-or-nothing.
+ *
+ * commit() first writes every record to "<file>.journal" and fsyncs it, then
+ * pwrites the records into the file, fsyncs that, and removes the journal.
+ * If we die part way, recover() (called before the file is next opened)
+ * replays a complete journal or throws away a torn one, so the file ends up
+ * either entirely before or entirely after the batch.
+ */
+class WriteJournal {
+public:
+    explicit WriteJournal(const std::string &path) : path(path) {}
+
+    const std::string &get_path() const { return path; }
+    bool empty() const { return records.empty(); }
+
+    /** Queue len bytes for file offset. Runs onto the previous record if contiguous. */
+    void add(uint64_t offset, const uint8_t *data, size_t len);
+
+    /** Journal, apply and sync the queued writes. Returns 0 on success, -1 on error. */
+    int commit();
+
+    /** Finish or discard a commit() that was interrupted. Returns 0 if the file is consistent. */
+    static int recover(const std::string &path);
+
+    /** Delete any journal left for path, for when the whole file is about to be rewritten. */
+    static void discard(const std::string &path);
+
+    static std::string journal_path(const std::string &path) { return path + ".journal"; }
+
+private:
+    struct Record {
+        uint64_t offset;
+        std::vector<uint8_t> data;
+    };
+
+    std::string path;
+    std::vector<Record> records;
+
+    std::vector<uint8_t> serialize() const;
+    static bool parse(const std::vector<uint8_t> &blob, std::vector<Record> &out);
+    static int apply(const std::string &path, const std::vector<Record> &records);
+};
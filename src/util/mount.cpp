@@ -141,6 +141,14 @@ int Mounts::register_storage_device(storage_key_t key, StorageDevice *storage_de
     return 0;
 }
 
+bool Mounts::any_floppy_motor_on() {
+    for (const auto& [key, registration] : storage_devices) {
+        if (registration.drive_type == DRIVE_TYPE_PRODOS_BLOCK) continue;
+        if (registration.device->status(key).motor_on) return true;
+    }
+    return false;
+}
+
 const std::vector<drive_info_t>& Mounts::get_all_drives() {
     cached_drive_info.clear();  // doesn't deallocate capacity
     cached_drive_info.reserve(storage_devices.size());
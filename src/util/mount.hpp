@@ -82,6 +82,8 @@ public:
     bool unmount_media(storage_key_t key, unmount_action_t action);
     drive_status_t media_status(storage_key_t key);
     const std::vector<drive_info_t>& get_all_drives();
+    /** True while any 5.25 or 3.5 floppy drive's motor is on (ProDOS block devices don't count). */
+    bool any_floppy_motor_on();
     int register_storage_device(storage_key_t key, StorageDevice *storage_device, drive_type_t drive_type);
     void dump();
 };
@@ -77,6 +77,53 @@ uint32_t Woz::crc32(const uint8_t* buf, size_t size) {
     return crc ^ ~0u;
 }
 
+uint32_t Woz::crc32_raw(uint32_t crc, const uint8_t* buf, size_t size) {
+    while (size--)
+        crc = crc32_tab[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static uint32_t gf2_matrix_times(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    while (vec) {
+        if (vec & 1) sum ^= *mat;
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; n++)
+        square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+uint32_t Woz::crc32_shift(uint32_t crc, size_t len) {
+    if (len == 0) return crc;
+
+    // odd = operator for one zero bit, then square up to one zero byte and
+    // apply the powers of two present in len.
+    uint32_t even[32], odd[32];
+    odd[0] = 0xedb88320u;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; n++) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    gf2_matrix_square(even, odd);   // 2 zero bits
+    gf2_matrix_square(odd, even);   // 4 zero bits
+    do {
+        gf2_matrix_square(even, odd);
+        if (len & 1) crc = gf2_matrix_times(even, crc);
+        len >>= 1;
+        if (len == 0) break;
+        gf2_matrix_square(odd, even);
+        if (len & 1) crc = gf2_matrix_times(odd, crc);
+        len >>= 1;
+    } while (len != 0);
+    return crc;
+}
+
 // ─── Constructor ─────────────────────────────────────────────────────────────
 
 Woz::Woz() {
@@ -380,6 +427,8 @@ int Woz::parse_trks_v2(const std::vector<uint8_t>& file_buf,
         trk.bit_count = bit_count;
         trk.bits.assign(file_buf.data() + byte_offset,
                         file_buf.data() + byte_offset + byte_count);
+        trk.file_block       = starting_block;
+        trk.file_block_count = block_count;
     }
     return 0;
 }
@@ -444,9 +493,9 @@ int Woz::load(const std::string& filename) {
                          (static_cast<uint32_t>(buf[9])  << 8) |
                          (static_cast<uint32_t>(buf[10]) << 16) |
                          (static_cast<uint32_t>(buf[11]) << 24);
+    uint32_t computed = crc32(buf.data() + WOZ_HEADER_SIZE,
+                              buf.size() - WOZ_HEADER_SIZE);
     if (stored_crc != 0) {
-        uint32_t computed = crc32(buf.data() + WOZ_HEADER_SIZE,
-                                  buf.size() - WOZ_HEADER_SIZE);
         if (computed != stored_crc) {
             std::cerr << "WOZ: CRC32 mismatch (stored 0x" << std::hex << stored_crc
                       << ", computed 0x" << computed << std::dec << ")\n";
@@ -458,6 +507,7 @@ int Woz::load(const std::string& filename) {
     m_image.tracks.clear();
     m_image.meta.clear();
     std::fill(std::begin(m_image.tmap), std::end(m_image.tmap), 0xFF);
+    file_image.clear();
 
     // Walk chunks starting at byte 12.
     size_t pos = WOZ_HEADER_SIZE;
@@ -509,6 +559,13 @@ int Woz::load(const std::string& filename) {
 
         pos = data_off + chunk_size;
     }
+
+    // Keep the on-disk bytes for incremental writeback; WOZ1 tracks have no
+    // block addresses, so those wait for the first full save().
+    if (m_image.file_version == 2) {
+        file_image = std::move(buf);
+        file_crc   = computed;
+    }
     return 0;
 }
 
@@ -597,6 +654,8 @@ std::vector<uint8_t> Woz::build_trks_chunk() {
         trk_array[entry_off + 5] = (trk.bit_count >> 8) & 0xFF;
         trk_array[entry_off + 6] = (trk.bit_count >> 16) & 0xFF;
         trk_array[entry_off + 7] = (trk.bit_count >> 24) & 0xFF;
+        m_image.tracks[i].file_block       = current_block;
+        m_image.tracks[i].file_block_count = block_count;
 
         // Append bit data, zero-padded to block boundary.
         size_t block_bytes = static_cast<size_t>(block_count) * WOZ_BLOCK_SIZE;
@@ -672,8 +731,70 @@ int Woz::save(const std::string& filename) {
     fclose(fp);
     if (!ok) {
         std::cerr << "WOZ: write error on '" << filename << "'\n";
+        file_image.clear();
         return -1;
     }
+    clear_dirty_tracks();
+    file_image = std::move(out);
+    file_crc   = crc;
+    return 0;
+}
+
+// ─── Incremental writeback ────────────────────────────────────────────────────
+
+void Woz::clear_dirty_tracks() {
+    for (woz_track_t& trk : m_image.tracks) trk.dirty = false;
+}
+
+void Woz::writeback_failed() {
+    for (woz_track_t& trk : m_image.tracks) trk.dirty = true;
+    file_image.clear();
+}
+
+int Woz::stage_dirty_tracks(WriteJournal& journal) {
+    if (file_image.empty()) return -1;
+
+    // Check everything fits before touching file_image, so a -1 leaves the
+    // mirror and dirty flags as they were for the full save() that follows.
+    for (const woz_track_t& trk : m_image.tracks) {
+        if (!trk.dirty) continue;
+        size_t region = static_cast<size_t>(trk.file_block_count) * WOZ_BLOCK_SIZE;
+        size_t start  = static_cast<size_t>(trk.file_block) * WOZ_BLOCK_SIZE;
+        if (region == 0 || start + region > file_image.size() ||
+            (trk.bit_count + 7) / 8 > region || trk.bits.size() > region) {
+            return -1;
+        }
+    }
+
+    uint32_t crc = file_crc;
+    std::vector<uint8_t> region, delta;
+    for (size_t i = 0; i < m_image.tracks.size(); i++) {
+        woz_track_t& trk = m_image.tracks[i];
+        if (!trk.dirty) continue;
+
+        size_t start = static_cast<size_t>(trk.file_block) * WOZ_BLOCK_SIZE;
+        region.assign(static_cast<size_t>(trk.file_block_count) * WOZ_BLOCK_SIZE, 0x00);
+        std::memcpy(region.data(), trk.bits.data(), trk.bits.size());
+
+        // CRC is linear: XOR in the CRC of (old ^ new), carried past the
+        // bytes after this region, instead of re-reading the whole file.
+        uint8_t* disk = file_image.data() + start;
+        delta.resize(region.size());
+        for (size_t b = 0; b < region.size(); b++) delta[b] = disk[b] ^ region[b];
+        crc ^= crc32_shift(crc32_raw(0, delta.data(), delta.size()),
+                           file_image.size() - start - region.size());
+        std::memcpy(disk, region.data(), region.size());
+        journal.add(start, region.data(), region.size());
+        trk.dirty = false;
+    }
+
+    if (crc != file_crc) {
+        file_crc = crc;
+        uint8_t le[4] = { static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8),
+                          static_cast<uint8_t>(crc >> 16), static_cast<uint8_t>(crc >> 24) };
+        std::memcpy(file_image.data() + 8, le, sizeof(le));
+        journal.add(8, le, sizeof(le));
+    }
     return 0;
 }
 
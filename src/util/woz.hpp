@@ -24,6 +24,7 @@
 #include <algorithm>
 
 #include "util/media.hpp"
+#include "util/WriteJournal.hpp"
 //#include "devices/diskii/diskii_fmt.hpp"
 
 // Disk data structure (raw, unencoded)
@@ -93,6 +94,11 @@ struct woz_info_t {
 struct woz_track_t {
     std::vector<uint8_t> bits;     // bit-packed stream, MSB-first per byte
     uint32_t             bit_count = 0;
+    bool                 dirty = false;         // written since last writeback
+    // Where these bits sit in the WOZ2 file they were loaded from / last saved
+    // to, in 512-byte blocks. file_block_count == 0: not in a file yet.
+    uint16_t             file_block = 0;
+    uint16_t             file_block_count = 0;
 };
 
 // ─── Full in-memory WOZ image ─────────────────────────────────────────────────
@@ -129,6 +135,17 @@ public:
     // Write m_image to disk as WOZ 2.x with a freshly computed CRC32.
     // Returns 0 on success, -1 on error.
     int save(const std::string& filename);
+
+    // Queue just the blocks of each dirty track, plus the patched header
+    // CRC, into journal as in-place writes to the file last loaded or saved,
+    // and mark those tracks clean. Returns -1 without queueing anything when
+    // that file isn't WOZ2 or a track no longer fits its blocks; save() the
+    // whole image instead.
+    int stage_dirty_tracks(WriteJournal& journal);
+    void clear_dirty_tracks();
+    // A staged journal never reached the file: mark every track dirty and
+    // forget the file mirror, so the next writeback save()s the whole image.
+    void writeback_failed();
 #if 0
     // Build m_image from a block-based or nibblized disk image described by
     // media (as returned by identify_media).  Generates a proper Apple II
@@ -162,6 +179,11 @@ public:
 private:
     woz_image_t m_image;
     std::string current_image_filename;
+    // Copy of the WOZ2 file as it is on disk, and its CRC32, so that
+    // stage_dirty_tracks() can patch the CRC from the changed blocks alone.
+    // Empty after loading a WOZ1 file until the first save().
+    std::vector<uint8_t> file_image;
+    uint32_t             file_crc = 0;
 #if 0    
     // ── Bit-stream primitives ────────────────────────────────────────────────
     // Append one bit (0 or 1) to trk, MSB-first within each byte.
@@ -224,5 +246,11 @@ private:
 
     // ── CRC32 (Gary S. Brown 1986, per WOZ spec Appendix A) ─────────────────
     static uint32_t crc32(const uint8_t* buf, size_t size);
+    // Unconditioned register update (no initial/final inversion), and the
+    // effect on that register of appending len zero bytes (zlib's
+    // crc32_combine operator). Together they give the change in a file's
+    // CRC from the XOR of an edited region and the bytes that follow it.
+    static uint32_t crc32_raw(uint32_t crc, const uint8_t* buf, size_t size);
+    static uint32_t crc32_shift(uint32_t crc, size_t len);
     static const uint32_t crc32_tab[256];
 };
@@ -15,6 +15,11 @@ class Woz_Nibblizer {
         // `media` supplies filename, interleave, and target format.
         // Returns 0 on success, -1 on error.
         virtual int export_block_image(const Woz& woz, const media_descriptor* media) = 0;
+        // Decode only the tracks marked dirty and queue their sectors into
+        // `journal` at their offsets in the block image. Sectors that fail to
+        // decode are left as they are on disk.
+        // Returns 0 on success, -1 on error.
+        virtual int stage_dirty_tracks(const Woz& woz, const media_descriptor* media, WriteJournal& journal) = 0;
     protected:
         static void emit_bit(woz_track_t& trk, int bit);
         static void emit_sync_byte(woz_track_t& trk);
@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <cassert>
 #include "woz_nibblizer_35.hpp"
 #include "util/media.hpp"
@@ -360,7 +361,7 @@ int Woz_Nibblizer_35::import_block_image(Woz& woz, const media_descriptor* media
 
 // ─── Export to media (WOZ bit-stream → raw block image) ─────────────────────
 
-int Woz_Nibblizer_35::decode_track(const woz_track_t *trk, int track_num, int side, disk_image_t *out) {
+int Woz_Nibblizer_35::decode_track(const woz_track_t *trk, int track_num, int side, disk_image_t *out, bool *decoded_sectors) {
     if (trk->bit_count == 0) return 0;
 
     BitCursor c{trk, 0, 0};
@@ -430,9 +431,14 @@ int Woz_Nibblizer_35::decode_track(const woz_track_t *trk, int track_num, int si
         }
 
         // convert track, sector, side to logical sector number 0-1599.
+        if (track_num >= TRACKS_PER_DISK || sector >= sectorsPerZone[track_num / 16]) {
+            n0 = n1 = n2 = 0;
+            continue;
+        }
         int logical = calculateSectorOffset(track_num, sector, side_num);
         //printf("decode_track >> track: %d sector: %d side: %d => logical: %d\n", track_num, sector, side_num, logical);
         std::memcpy(out->sectors[logical], decoded+12, SECTOR_SIZE); // skip the first 12 bytes (block metadata)
+        if (decoded_sectors) decoded_sectors[logical] = true;
 
         if (!found[sector]) { found[sector] = true; ++found_count; }
         n0 = n1 = n2 = 0;
@@ -510,4 +516,29 @@ int Woz_Nibblizer_35::export_block_image(const Woz& woz, const media_descriptor*
     delete out;
 
     return status;
-}
\ No newline at end of file
+}
+
+int Woz_Nibblizer_35::stage_dirty_tracks(const Woz& woz, const media_descriptor* media, WriteJournal& journal) {
+    std::unique_ptr<disk_image_t> out(new disk_image_t);
+    // Indexed by logical block: a sector is stored wherever its own address
+    // field says, so collect them all before queueing.
+    bool decoded[SECTORS_PER_DISK] = {false};
+
+    for (int t = 0; t < TRACKS_PER_DISK; t++) {
+        for (int side = 0; side < 2; side++) {
+            const woz_track_t *trk_ptr = woz.get_track_ptr(t*2+side);
+            if (trk_ptr == nullptr || !trk_ptr->dirty) continue;
+            if (!decode_track(trk_ptr, t, side, out.get(), decoded)) {
+                std::cerr << "WOZ: stage_dirty_tracks: track " << t << " side " << side
+                        << " short sectors\n";
+            }
+        }
+    }
+
+    for (int block = 0; block < SECTORS_PER_DISK; block++) {
+        if (!decoded[block]) continue;
+        uint64_t offset = media->data_offset + static_cast<uint64_t>(block) * SECTOR_SIZE;
+        journal.add(offset, out->sectors[block], SECTOR_SIZE);
+    }
+    return 0;
+}
@@ -167,7 +167,8 @@ const uint8_t INVALID_INV = 0xff;
     bool EncodeSector62_524(uint8_t* output, const uint8_t* buffer);
     bool DecodeSector62_524(uint8_t* buffer, const uint8_t *input);
 
-    int decode_track(const woz_track_t *trk, int track_num, int side, disk_image_t *out);
+    // decoded (optional, SECTORS_PER_DISK entries) is set for each logical sector recovered.
+    int decode_track(const woz_track_t *trk, int track_num, int side, disk_image_t *out, bool *decoded = nullptr);
     int write_disk_image_po_do(const media_descriptor *media, const disk_image_t *disk_image);
     int load_disk_image(const media_descriptor *media, disk_image_t& disk_image);
     int write_disk_image(const media_descriptor *media, const disk_image_t *disk_image);
@@ -177,5 +178,6 @@ public:
     ~Woz_Nibblizer_525() {} ; */
     virtual int import_block_image(Woz& woz, const media_descriptor* media) override;
     virtual int export_block_image(const Woz& woz, const media_descriptor* media) override;
+    virtual int stage_dirty_tracks(const Woz& woz, const media_descriptor* media, WriteJournal& journal) override;
 };
 
@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include "woz_nibblizer_525.hpp"
 
 
@@ -311,7 +312,7 @@ post2:
 
 int Woz_Nibblizer_525::decode_track(const woz_track_t *trk, int track_num,
                     const interleave_t& phys_to_logical,
-                    disk_image_t *out) {
+                    disk_image_t *out, bool *decoded_sectors) {
     if (trk->bit_count == 0) return 0;
 
     BitCursor c{trk, 0, 0};
@@ -390,6 +391,7 @@ int Woz_Nibblizer_525::decode_track(const woz_track_t *trk, int track_num,
         decode_sector_62(nbuf, decoded);
         int logical = phys_to_logical[sector];
         std::memcpy(out->sectors[track_num][logical], decoded, SECTOR_SIZE);
+        if (decoded_sectors) decoded_sectors[logical] = true;
 
         if (!found[sector]) { found[sector] = true; ++found_count; }
         n0 = n1 = n2 = 0;
@@ -485,4 +487,38 @@ int Woz_Nibblizer_525::export_block_image(const Woz& woz, const media_descriptor
     }
 
     return status;
-}
\ No newline at end of file
+}
+
+int Woz_Nibblizer_525::stage_dirty_tracks(const Woz& woz, const media_descriptor* media, WriteJournal& journal) {
+    const interleave_t* phys_to_logical = nullptr;
+    if (media->interleave == INTERLEAVE_PO) {
+        phys_to_logical = &po_phys_to_logical;
+    } else if (media->interleave == INTERLEAVE_DO) {
+        phys_to_logical = &do_phys_to_logical;
+    } else {
+        std::cerr << "WOZ: stage_dirty_tracks: unsupported interleave "
+                  << media->interleave << "\n";
+        return -1;
+    }
+
+    std::unique_ptr<disk_image_t> out(new disk_image_t);
+
+    for (int t = 0; t < TRACKS_PER_DISK; t++) {
+        const woz_track_t *trk_ptr = woz.get_track_ptr(t*4);
+        if (trk_ptr == nullptr || !trk_ptr->dirty) continue;
+
+        bool decoded[SECTORS_PER_TRACK] = {false};
+        int got = decode_track(trk_ptr, t, *phys_to_logical, out.get(), decoded);
+        if (got != SECTORS_PER_TRACK) {
+            std::cerr << "WOZ: stage_dirty_tracks: track " << t
+                      << " decoded " << got << "/" << SECTORS_PER_TRACK
+                      << " sectors\n";
+        }
+        for (int s = 0; s < SECTORS_PER_TRACK; s++) {
+            if (!decoded[s]) continue;
+            uint64_t offset = media->data_offset + (static_cast<uint64_t>(t) * SECTORS_PER_TRACK + s) * SECTOR_SIZE;
+            journal.add(offset, out->sectors[t][s], SECTOR_SIZE);
+        }
+    }
+    return 0;
+}
@@ -133,9 +133,10 @@ protected:
                             int track_num, uint8_t volume);
     woz_track_t build_track_from_nib(const uint8_t* nib_data, uint32_t nib_size);
     void decode_sector_62(sector_62_t& nbuf, sector_t& decoded);
+    // decoded (optional, 16 entries) is set for each logical sector recovered.
     int decode_track(const woz_track_t *trk, int track_num,
                       const interleave_t& phys_to_logical,
-                      disk_image_t *out);
+                      disk_image_t *out, bool *decoded = nullptr);
     int load_nib_image(nibblized_disk_t& disk, const std::string& filename);
     int import_from_nib(Woz& woz, const media_descriptor* media);
 
@@ -147,5 +148,6 @@ public:
     ~Woz_Nibblizer_525() {} ; */
     virtual int import_block_image(Woz& woz, const media_descriptor* media) override;
     virtual int export_block_image(const Woz& woz, const media_descriptor* media) override;
+    virtual int stage_dirty_tracks(const Woz& woz, const media_descriptor* media, WriteJournal& journal) override;
 };
 